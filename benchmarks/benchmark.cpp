@@ -0,0 +1,486 @@
+// kate: replace-tabs off; indent-width 4; indent-mode normal
+// vim: ts=4:sw=4:noexpandtab
+/*
+
+Copyright (c) 2010--2012,
+François Pomerleau and Stephane Magnenat, ASL, ETHZ, Switzerland
+You can contact the authors at <f dot pomerleau at gmail dot com> and
+<stephane at magnenat dot net>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ETH-ASL BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "pointmatcher/PointMatcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef WIN32
+#include <sys/resource.h>
+#endif // WIN32
+
+using namespace std;
+using namespace PointMatcherSupport;
+
+typedef PointMatcher<float> PM;
+typedef PM::DataPoints DP;
+typedef PM::Parameters Parameters;
+
+/**
+  * Micro-benchmark of every module of the registrars and of full ICP runs.
+  *
+  * Every DataPointsFilter, Matcher, OutlierFilter, ErrorMinimizer and
+  * Transformation is run with its default parameters on procedurally
+  * generated clouds, which are identical from one run to the next, and on
+  * pairs of clouds of examples/data. The results are written as JSON, with
+  * the time per point and the peak resident set size of the process.
+  */
+
+struct Options
+{
+	vector<size_t> sizes = {10000, 100000, 1000000};
+	string dataPath;
+	unsigned repetitions = 3;
+	string filter;
+	string output;
+};
+
+struct Result
+{
+	string module;
+	string name;
+	string dataset;
+	size_t points;
+	unsigned repetitions;
+	double minNs;
+	double medianNs;
+	long peakRssKiB;
+	string error;
+};
+
+void usage(const char *name)
+{
+	cerr << "Usage: " << name << " [OPTIONS]\n\n";
+	cerr << "Options:\n";
+	cerr << "  --sizes N1,N2,...    sizes of the generated clouds (default: 10000,100000,1000000)\n";
+	cerr << "  --data PATH          directory holding the clouds of examples/data (default: none)\n";
+	cerr << "  --repetitions N      number of timed runs of every benchmark (default: 3)\n";
+	cerr << "  --filter TEXT        only run benchmarks whose module/name contains TEXT\n";
+	cerr << "  --output FILE        write the JSON results to FILE instead of the standard output\n";
+	cerr << endl;
+}
+
+//! Return the peak resident set size of the process in KiB, or -1 if unknown
+long getPeakRssKiB()
+{
+#ifndef WIN32
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return -1;
+#ifdef __APPLE__
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#else
+	return -1;
+#endif // WIN32
+}
+
+//! Deterministic generator, independent of the standard library implementation
+class Generator
+{
+public:
+	Generator(const uint32_t seed): engine(seed) {}
+
+	//! Uniform value in [low, high)
+	float uniform(const float low, const float high)
+	{
+		return low + (high - low) * float(engine() / 4294967296.0);
+	}
+
+	//! Normally-distributed value, using Box-Muller
+	float normal(const float sigma)
+	{
+		const double u1(1.0 - engine() / 4294967296.0);
+		const double u2(engine() / 4294967296.0);
+		return sigma * float(sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2));
+	}
+
+private:
+	mt19937 engine;
+};
+
+//! Generate a 3D cloud of a room with boxes, as seen from the origin, with Gaussian noise
+DP generateCloud(const size_t pointsCount, const uint32_t seed)
+{
+	// the same boxes for every cloud, the points depend on seed
+	Generator sceneGenerator(1);
+	vector<Eigen::Vector3f> boxMin, boxMax;
+	boxMin.push_back(Eigen::Vector3f(-20, -20, -0.1));
+	boxMax.push_back(Eigen::Vector3f(20, 20, 5));
+	for (int i = 0; i < 10; ++i)
+	{
+		const Eigen::Vector3f center(sceneGenerator.uniform(-15, 15), sceneGenerator.uniform(-15, 15), 0);
+		const Eigen::Vector3f halfSize(sceneGenerator.uniform(0.2, 2), sceneGenerator.uniform(0.2, 2), sceneGenerator.uniform(0.5, 2));
+		boxMin.push_back(center - Eigen::Vector3f(halfSize.x(), halfSize.y(), 0));
+		boxMax.push_back(center + halfSize);
+	}
+
+	Generator generator(seed);
+	PM::Matrix features(4, pointsCount);
+	for (size_t p = 0; p < pointsCount; ++p)
+	{
+		// pick a box then a face, and a point on that face
+		const int box(min(int(generator.uniform(0, boxMin.size())), int(boxMin.size()) - 1));
+		const int face(min(int(generator.uniform(0, 6)), 5));
+		const int axis(face / 2);
+		Eigen::Vector3f point;
+		for (int i = 0; i < 3; ++i)
+			point(i) = generator.uniform(boxMin[box](i), boxMax[box](i));
+		point(axis) = (face % 2 == 0) ? boxMin[box](axis) : boxMax[box](axis);
+		for (int i = 0; i < 3; ++i)
+			features(i, p) = point(i) + generator.normal(0.01);
+		features(3, p) = 1;
+	}
+
+	DP::Labels featureLabels;
+	featureLabels.push_back(DP::Label("x", 1));
+	featureLabels.push_back(DP::Label("y", 1));
+	featureLabels.push_back(DP::Label("z", 1));
+	featureLabels.push_back(DP::Label("pad", 1));
+	return DP(features, featureLabels);
+}
+
+//! Add the descriptors the modules may need: normals, densities, eigen values, observation directions, incidence angles, maximum search distances
+DP decorate(const DP& cloud)
+{
+	DP decorated(cloud);
+	PM::DataPointsFilters filters;
+	filters.push_back(PM::get().DataPointsFilterRegistrar.create("SurfaceNormalDataPointsFilter", {
+		{"knn", "10"}, {"keepDensities", "1"}, {"keepEigenValues", "1"}
+	}));
+	filters.push_back(PM::get().DataPointsFilterRegistrar.create("ObservationDirectionDataPointsFilter"));
+	filters.push_back(PM::get().DataPointsFilterRegistrar.create("IncidenceAngleDataPointsFilter"));
+	for (const auto& filter: filters)
+	{
+		// a missing descriptor only makes the modules needing it report an error
+		try
+		{
+			filter->inPlaceFilter(decorated);
+		}
+		catch (const exception& e)
+		{
+			cerr << "Warning, cannot add descriptors with " << filter->className << ": " << e.what() << endl;
+		}
+	}
+	decorated.addDescriptor("maxSearchDist", PM::Matrix::Constant(1, decorated.getNbPoints(), 1));
+	return decorated;
+}
+
+//! Parameters to use instead of the defaults for modules which cannot run with them
+Parameters getParameters(const string& name)
+{
+	if (name == "CutAtDescriptorThresholdDataPointsFilter")
+		return {{"descName", "densities"}, {"threshold", "100"}};
+	if (name == "GenericDescriptorOutlierFilter")
+		return {{"descName", "densities"}};
+	return Parameters();
+}
+
+class Benchmark
+{
+public:
+	Benchmark(const Options& options): options(options) {}
+
+	//! Time run options.repetitions times, calling setup before each run without timing it
+	void measure(const string& module, const string& name, const string& dataset, const size_t points, const function<void()>& setup, const function<void()>& run)
+	{
+		if (!options.filter.empty() && (module + "/" + name).find(options.filter) == string::npos)
+			return;
+
+		cerr << "* " << module << "/" << name << " on " << dataset << endl;
+		Result result = {module, name, dataset, points, 0, 0, 0, -1, ""};
+		vector<double> durations;
+		try
+		{
+			for (unsigned i = 0; i < options.repetitions; ++i)
+			{
+				setup();
+				const auto start(chrono::steady_clock::now());
+				run();
+				const auto stop(chrono::steady_clock::now());
+				durations.push_back(chrono::duration<double, nano>(stop - start).count());
+			}
+		}
+		catch (const exception& e)
+		{
+			result.error = e.what();
+		}
+
+		result.repetitions = durations.size();
+		if (!durations.empty())
+		{
+			sort(durations.begin(), durations.end());
+			result.minNs = durations.front();
+			result.medianNs = durations[durations.size() / 2];
+		}
+		result.peakRssKiB = getPeakRssKiB();
+		results.push_back(result);
+	}
+
+	//! Run every module and a full ICP on reading and reference
+	void run(const string& dataset, const DP& reading, const DP& reference)
+	{
+		const DP decoratedReading(decorate(reading));
+		const DP decoratedReference(decorate(reference));
+		const size_t readingPoints(decoratedReading.getNbPoints());
+		const size_t referencePoints(decoratedReference.getNbPoints());
+		DP cloud;
+
+		for (const auto& it: PM::get().DataPointsFilterRegistrar)
+		{
+			const shared_ptr<PM::DataPointsFilter> filter(PM::get().DataPointsFilterRegistrar.create(it.first, getParameters(it.first)));
+			measure("DataPointsFilter", it.first, dataset, readingPoints,
+				[&]() { cloud = decoratedReading; },
+				[&]() { filter->inPlaceFilter(cloud); }
+			);
+		}
+
+		for (const auto& it: PM::get().MatcherRegistrar)
+		{
+			const shared_ptr<PM::Matcher> matcher(PM::get().MatcherRegistrar.create(it.first, getParameters(it.first)));
+			measure("Matcher", it.first + "/init", dataset, referencePoints,
+				[&]() {},
+				[&]() { matcher->init(decoratedReference); }
+			);
+			measure("Matcher", it.first + "/findClosests", dataset, readingPoints,
+				[&]() { matcher->init(decoratedReference); },
+				[&]() { matcher->findClosests(decoratedReading); }
+			);
+		}
+
+		const shared_ptr<PM::Matcher> matcher(PM::get().MatcherRegistrar.create("KDTreeMatcher"));
+		matcher->init(decoratedReference);
+		const PM::Matches matches(matcher->findClosests(decoratedReading));
+
+		for (const auto& it: PM::get().OutlierFilterRegistrar)
+		{
+			const shared_ptr<PM::OutlierFilter> outlierFilter(PM::get().OutlierFilterRegistrar.create(it.first, getParameters(it.first)));
+			measure("OutlierFilter", it.first, dataset, readingPoints,
+				[&]() {},
+				[&]() { outlierFilter->compute(decoratedReading, decoratedReference, matches); }
+			);
+		}
+
+		const PM::OutlierWeights weights(PM::OutlierWeights::Ones(matches.ids.rows(), matches.ids.cols()));
+		for (const auto& it: PM::get().ErrorMinimizerRegistrar)
+		{
+			const shared_ptr<PM::ErrorMinimizer> errorMinimizer(PM::get().ErrorMinimizerRegistrar.create(it.first, getParameters(it.first)));
+			measure("ErrorMinimizer", it.first, dataset, readingPoints,
+				[&]() {},
+				[&]() { errorMinimizer->compute(decoratedReading, decoratedReference, weights, matches); }
+			);
+		}
+
+		const int dim(reading.features.rows() - 1);
+		PM::TransformationParameters T(PM::TransformationParameters::Identity(dim + 1, dim + 1));
+		if (dim == 3)
+			T.topLeftCorner(3, 3) = Eigen::AngleAxisf(0.05, Eigen::Vector3f(0.1, 0.2, 1).normalized()).toRotationMatrix();
+		else
+			T.topLeftCorner(2, 2) = Eigen::Rotation2Df(0.05).toRotationMatrix();
+		T.topRightCorner(dim, 1).setConstant(0.2);
+		for (const auto& it: PM::get().TransformationRegistrar)
+		{
+			const shared_ptr<PM::Transformation> transformation(PM::get().TransformationRegistrar.create(it.first, getParameters(it.first)));
+			const PM::TransformationParameters parameters(transformation->correctParameters(T));
+			measure("Transformation", it.first, dataset, readingPoints,
+				[&]() {},
+				[&]() { cloud = transformation->compute(decoratedReading, parameters); }
+			);
+		}
+
+		PM::ICP icp;
+		icp.setDefault();
+		measure("ICP", "default", dataset, reading.getNbPoints(),
+			[&]() {},
+			[&]() { icp(reading, reference); }
+		);
+	}
+
+	//! Write the results as JSON
+	void write(ostream& stream) const
+	{
+		stream << "{\n";
+		stream << "  \"library\": \"libpointmatcher\",\n";
+		stream << "  \"version\": \"" << POINTMATCHER_VERSION << "\",\n";
+		stream << "  \"scalar\": \"float\",\n";
+		stream << "  \"results\": [";
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const Result& result(results[i]);
+			const double nsPerPoint(result.points == 0 ? 0 : result.medianNs / result.points);
+			stream << (i == 0 ? "\n" : ",\n");
+			stream << "    {";
+			stream << "\"module\": " << quote(result.module) << ", ";
+			stream << "\"name\": " << quote(result.name) << ", ";
+			stream << "\"dataset\": " << quote(result.dataset) << ", ";
+			stream << "\"points\": " << result.points << ", ";
+			stream << "\"repetitions\": " << result.repetitions << ", ";
+			stream << fixed << setprecision(0);
+			stream << "\"minNs\": " << result.minNs << ", ";
+			stream << "\"medianNs\": " << result.medianNs << ", ";
+			stream << setprecision(3);
+			stream << "\"nsPerPoint\": " << nsPerPoint << ", ";
+			stream << defaultfloat << setprecision(6);
+			stream << "\"peakRssKiB\": " << result.peakRssKiB << ", ";
+			stream << "\"error\": " << (result.error.empty() ? "null" : quote(result.error));
+			stream << "}";
+		}
+		stream << "\n  ]\n";
+		stream << "}\n";
+	}
+
+private:
+	//! Return text as a JSON string
+	static string quote(const string& text)
+	{
+		ostringstream quoted;
+		quoted << '"';
+		for (const char c: text)
+		{
+			if (c == '"' || c == '\\')
+				quoted << '\\' << c;
+			else if (c == '\n')
+				quoted << "\\n";
+			else if (static_cast<unsigned char>(c) < 0x20)
+				quoted << "\\u" << hex << setw(4) << setfill('0') << int(c) << dec << setfill(' ');
+			else
+				quoted << c;
+		}
+		quoted << '"';
+		return quoted.str();
+	}
+
+	const Options& options;
+	vector<Result> results;
+};
+
+bool parseArgs(int argc, char *argv[], Options& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const string arg(argv[i]);
+		if (arg == "-h" || arg == "--help" || i + 1 >= argc)
+			return false;
+		const string value(argv[++i]);
+		if (arg == "--sizes")
+		{
+			options.sizes.clear();
+			istringstream sizes(value);
+			string size;
+			while (getline(sizes, size, ','))
+				options.sizes.push_back(stoul(size));
+		}
+		else if (arg == "--data")
+			options.dataPath = value;
+		else if (arg == "--repetitions")
+			options.repetitions = stoul(value);
+		else if (arg == "--filter")
+			options.filter = value;
+		else if (arg == "--output")
+			options.output = value;
+		else
+			return false;
+	}
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	Options options;
+	if (!parseArgs(argc, argv, options))
+	{
+		usage(argv[0]);
+		return 1;
+	}
+
+	Benchmark benchmark(options);
+
+	// Generated clouds, the reading being another sampling of the scene, moved
+	for (const size_t size: options.sizes)
+	{
+		const DP reference(generateCloud(size, 2));
+		DP reading(generateCloud(size, 3));
+		PM::TransformationParameters T(PM::TransformationParameters::Identity(4, 4));
+		T.topLeftCorner(3, 3) = Eigen::AngleAxisf(0.05, Eigen::Vector3f::UnitZ()).toRotationMatrix();
+		T.topRightCorner(3, 1) << 0.3, 0.2, 0.05;
+		reading.features = T * reading.features;
+
+		benchmark.run("generated" + to_string(size), reading, reference);
+	}
+
+	// Clouds of examples/data
+	if (!options.dataPath.empty())
+	{
+		const vector<pair<string, string>> pairs = {
+			{"cloud.00001.vtk", "cloud.00000.vtk"},
+			{"car_cloud401.csv", "car_cloud400.csv"},
+			{"2D_twoBoxes.csv", "2D_oneBox.csv"}
+		};
+		for (const auto& pair: pairs)
+		{
+			const DP reading(DP::load(options.dataPath + "/" + pair.first));
+			const DP reference(DP::load(options.dataPath + "/" + pair.second));
+			benchmark.run(pair.first, reading, reference);
+		}
+	}
+
+	if (options.output.empty())
+		benchmark.write(cout);
+	else
+	{
+		ofstream file(options.output.c_str());
+		if (!file.good())
+		{
+			cerr << "Error, cannot write to " << options.output << endl;
+			return 1;
+		}
+		benchmark.write(file);
+	}
+
+	return 0;
+}
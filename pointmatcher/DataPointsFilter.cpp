@@ -35,6 +35,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "PointMatcher.h"
 #include "PointMatcherPrivate.h"
+#include "Timer.h"
 
 #ifdef SYSTEM_YAML_CPP
     #include "yaml-cpp/yaml.h"
@@ -64,6 +65,27 @@ template<typename T>
 void PointMatcher<T>::DataPointsFilter::init()
 {}
 
+//! By default, filters need the whole cloud
+template<typename T>
+bool PointMatcher<T>::DataPointsFilter::isStreamable() const
+{
+	return false;
+}
+
+//! By default, filter the chunk as a cloud of its own
+template<typename T>
+void PointMatcher<T>::DataPointsFilter::inPlaceFilterChunk(DataPoints& chunk)
+{
+	inPlaceFilter(chunk);
+}
+
+//! By default, no points are held back
+template<typename T>
+bool PointMatcher<T>::DataPointsFilter::finishStream(DataPoints&)
+{
+	return false;
+}
+
 template struct PointMatcher<float>::DataPointsFilter;
 template struct PointMatcher<double>::DataPointsFilter;
 
@@ -119,7 +141,10 @@ void PointMatcher<T>::DataPointsFilters::apply(DataPoints& cloud)
 			throw ConvergenceError("no points to filter");
 		}
 
-		(*it)->inPlaceFilter(cloud);
+		{
+			PointMatcherSupport::Trace::ScopedTimer scope((*it)->className, "DataPointsFilter::inPlaceFilter");
+			(*it)->inPlaceFilter(cloud);
+		}
 		cloud.assertDescriptorConsistency();
 
 		const int nbPointsOut(cloud.features.cols());
@@ -130,5 +155,72 @@ void PointMatcher<T>::DataPointsFilters::apply(DataPoints& cloud)
 	LOG_INFO_STREAM("Applied " << this->size() << " filters - " << nbPointsAfterFilters << " points out (-" << (100 - double(nbPointsAfterFilters*100.)/nbPointsBeforeFilters) << "\%)");
 }
 
+//! Apply this chain to a cloud read chunk by chunk from source until it returns false, passing the filtered chunks to sink
+/*!
+	This bounds memory to a few chunks, so that clouds larger than memory can be
+	processed, but only filters looking at every point independently are valid.
+	Filters aggregating points over chunks, such as VoxelGridDataPointsFilter,
+	hold them back until the end of the stream, when they pass them through
+	the rest of the chain. If source, sink or a filter throws, the points held
+	back are dropped before the exception is passed on.
+*/
+template<typename T>
+void PointMatcher<T>::DataPointsFilters::applyStreaming(const std::function<bool(DataPoints&)>& source, const std::function<void(const DataPoints&)>& sink)
+{
+	for (DataPointsFiltersIt it = this->begin(); it != this->end(); ++it)
+	{
+		if (!(*it)->isStreamable())
+			throw std::runtime_error("applyStreaming(): " + (*it)->className + " needs the whole point cloud and cannot filter it chunk by chunk");
+	}
+
+	size_t nbPointsIn(0);
+	size_t nbPointsOut(0);
+	// pass chunk through the filters from first on, unless they hold all its points back
+	const auto filterFrom = [&](DataPoints& chunk, const size_t first)
+	{
+		for (size_t i = first; i < this->size() && chunk.features.cols() > 0; ++i)
+		{
+			(*this)[i]->inPlaceFilterChunk(chunk);
+			chunk.assertDescriptorConsistency();
+		}
+		if (chunk.features.cols() > 0)
+		{
+			nbPointsOut += chunk.features.cols();
+			sink(chunk);
+		}
+	};
+
+	try
+	{
+		DataPoints chunk;
+		while (source(chunk))
+		{
+			chunk.assertDescriptorConsistency();
+			nbPointsIn += chunk.features.cols();
+			filterFrom(chunk, 0);
+		}
+
+		// release the points held back, in the order of the chain
+		for (size_t i = 0; i < this->size(); ++i)
+		{
+			DataPoints heldBack;
+			if ((*this)[i]->finishStream(heldBack))
+				filterFrom(heldBack, i + 1);
+		}
+	}
+	catch (...)
+	{
+		// drop the points held back, so that the next stream starts afresh
+		for (size_t i = 0; i < this->size(); ++i)
+		{
+			DataPoints heldBack;
+			(*this)[i]->finishStream(heldBack);
+		}
+		throw;
+	}
+
+	LOG_INFO_STREAM("Streamed " << nbPointsIn << " points through " << this->size() << " filters - " << nbPointsOut << " points out");
+}
+
 template struct PointMatcher<float>::DataPointsFilters;
 template struct PointMatcher<double>::DataPointsFilters;
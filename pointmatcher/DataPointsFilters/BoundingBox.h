@@ -79,4 +79,5 @@ struct BoundingBoxDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	BoundingBoxDataPointsFilter(const Parameters& params = Parameters());
 	virtual DataPoints filter(const DataPoints& input);
 	virtual void inPlaceFilter(DataPoints& cloud);
+	virtual bool isStreamable() const { return true; } //!< every point is filtered on its own
 };
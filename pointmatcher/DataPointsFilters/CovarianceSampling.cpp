@@ -34,21 +34,23 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #include "CovarianceSampling.h"
 
+#include "Parallel.h"
+
 #include <vector>
-#include <list>
 #include <utility>
-#include <unordered_map>
+#include <algorithm>
 
 // Eigenvalues
 #include "Eigen/QR"
-#include "Eigen/Eigenvalues"
+#include "Eigen/SVD"
 
 // CovarianceSamplingDataPointsFilter
 template <typename T>
 CovarianceSamplingDataPointsFilter<T>::CovarianceSamplingDataPointsFilter(const Parameters& params) :
 	PointMatcher<T>::DataPointsFilter("CovarianceSamplingDataPointsFilter", 
 		CovarianceSamplingDataPointsFilter::availableParameters(), params),
-	nbSample{Parametrizable::get<std::size_t>("nbSample")}
+	nbSample{Parametrizable::get<std::size_t>("nbSample")},
+	nbThreads{Parametrizable::get<unsigned>("nbThreads")}
 {
 	try 
 	{
@@ -73,8 +75,7 @@ CovarianceSamplingDataPointsFilter<T>::filter(const DataPoints& input)
 template <typename T>
 void CovarianceSamplingDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
 {	
-	const std::size_t featDim(cloud.features.rows());
-	assert(featDim == 4); //3D pts only
+	assert(cloud.features.rows() == 4); //3D pts only
 	
 	//Check number of points
 	const std::size_t nbPoints = cloud.getNbPoints();		
@@ -87,27 +88,12 @@ void CovarianceSamplingDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
 
 	const auto& normals = cloud.getDescriptorViewByName("normals");
 	
-	std::vector<std::size_t> keepIndexes;
-	keepIndexes.resize(nbSample);
-	
 	///---- Part A, as we compare the cloud with himself, the overlap is 100%, so we keep all points 
-	//A.1 and A.2 - Compute candidates
-	std::vector<std::size_t> candidates ;
-	candidates.resize(nbPoints);
-	
-	for (std::size_t i = 0; i < nbPoints; ++i) candidates[i] = i;
-	
-	const std::size_t nbCandidates = candidates.size();
+	//A.1 and A.2 - All points are candidates
+	const std::size_t nbCandidates = nbPoints;
 	
 	//Compute centroid
-	Vector3 center;
-	for(std::size_t i = 0; i < featDim - 1; ++i) center(i) = T(0.);
-	
-	for (std::size_t i = 0; i < nbCandidates; ++i)
-		for (std::size_t f = 0; f < 3; ++f)
-			center(f) += cloud.features(f,candidates[i]);
-	
-	for(std::size_t i = 0; i < 3; ++i) center(i) /= T(nbCandidates);
+	const Vector3 center = cloud.features.template topRows<3>().rowwise().sum() / T(nbCandidates);
 	
 	//Compute torque normalization
 	T Lnorm = 1.0;
@@ -118,10 +104,7 @@ void CovarianceSamplingDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
 	}
 	else if(normalizationMethod == TorqueNormMethod::Lavg)
 	{
-		Lnorm = 0.0;
-		for (std::size_t i = 0; i < nbCandidates; ++i)
-			Lnorm += (cloud.features.col(candidates[i]).head(3) - center).norm();
-		Lnorm /= nbCandidates;
+		Lnorm = (cloud.features.template topRows<3>().colwise() - center).colwise().norm().sum() / T(nbCandidates);
 	}
 	else if(normalizationMethod == TorqueNormMethod::Lmax)	
 	{	
@@ -132,67 +115,80 @@ void CovarianceSamplingDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
 		Lnorm = radii.maxCoeff() / 2.; //radii.mean() / 2.; 
 	}
 	
-	//A.3 - Compute 6x6 covariance matrix + EigenVectors
-	auto computeCovariance = [Lnorm, nbCandidates, &cloud, &center, &normals, &candidates](Matrix66 & cov) -> void {
-			//Compute F matrix, see Eq. (4)
-			Eigen::Matrix<T, 6, Eigen::Dynamic> F(6, nbCandidates);
-	
-			for(std::size_t i = 0; i < nbCandidates; ++i)
+	//A.3 and B.1 - Compute the 6-vector of each candidate, v_i = [(1 / L) * (pi-c) x ni ; ni], see Eq. (4),
+	// and the 6x6 covariance matrix Cov = FF', with F = [v_1 ... v_n].
+	// The covariance is summed over blocks of fixed size, so that it does not depend on the number of threads.
+	const std::size_t blockSize(4096);
+	const std::size_t nbBlocks((nbCandidates + blockSize - 1) / blockSize);
+	const unsigned chunkCount(PointMatcherSupport::getChunkCount(nbBlocks, nbThreads));
+	Eigen::Matrix<T, 6, Eigen::Dynamic> F(6, nbCandidates);
+	std::vector<Matrix66, Eigen::aligned_allocator<Matrix66>> blockCovariances(nbBlocks);
+	PointMatcherSupport::parallelForChunks(nbBlocks, chunkCount, [&](const unsigned, const std::size_t firstBlock, const std::size_t lastBlock)
+	{
+		for(std::size_t block = firstBlock; block < lastBlock; ++block)
+		{
+			const std::size_t begin(block * blockSize);
+			const std::size_t end(std::min(begin + blockSize, nbCandidates));
+			for(std::size_t i = begin; i < end; ++i)
 			{
-				const Vector3 p = cloud.features.col(candidates[i]).head(3) - center; // pi-c
-				const Vector3 ni = normals.col(candidates[i]).head(3);
+				const Vector3 p = cloud.features.col(i).template head<3>() - center; // pi-c
+				const Vector3 ni = normals.col(i).template head<3>();
 				
-				//compute (1 / L) * (pi - c) x ni 
 				F.template block<3, 1>(0, i) = (1. / Lnorm) * p.cross(ni);
-				//set ni part
 				F.template block<3, 1>(3, i) = ni;
 			}
-
-			// Compute the covariance matrix Cov = FF'
-			cov = F * F.transpose(); 
-		};
-		
-	Matrix66 covariance;
-	computeCovariance(covariance);
+			const auto blockF = F.middleCols(begin, end - begin);
+			blockCovariances[block].noalias() = blockF * blockF.transpose();
+		}
+	});
 	
-	Eigen::EigenSolver<Matrix66> solver(covariance);		
-	const Matrix66  eigenVe = solver.eigenvectors().real();
-	const Vector6   eigenVa = solver.eigenvalues().real();
+	Matrix66 covariance(Matrix66::Zero());
+	for(const Matrix66& blockCovariance : blockCovariances)
+		covariance += blockCovariance;
 	
-	///---- Part B
-	//B.1 - Compute the v-6 for each candidate
-	std::vector<Vector6, Eigen::aligned_allocator<Vector6>> v; // v[i] = [(pi-c) x ni ; ni ]'
-	v.resize(nbCandidates);
-
-	for(std::size_t i = 0; i < nbCandidates; ++i)
-	{
-		const Vector3 p = cloud.features.col(candidates[i]).head(3) - center; // pi-c
-		const Vector3 ni = normals.col(candidates[i]).head(3);
-		
-		v[i].template block<3, 1>(0, 0) = (1. / Lnorm) * p.cross(ni);
-		v[i].template block<3, 1>(3, 0) = ni;
-	}
+	// the covariance is symmetric positive semi-definite, so its left singular
+	// vectors are its eigenvectors, reversed to be sorted by increasing eigenvalue
+	const Eigen::JacobiSVD<Matrix66> svd(covariance, Eigen::ComputeFullU);
+	const Matrix66 eigenVe = svd.matrixU().rowwise().reverse();
 	
-	//B.2 - Compute the 6 sorted list based on dot product (vi . Xk) = magnitude, with Xk the kth-EigenVector
-	std::vector<std::list<std::pair<int, T>>> L; // contain list of pair (index, magnitude) contribution to the eigens vectors
-	L.resize(6);
-	
-	//sort by decreasing magnitude
-	auto comp = [](const std::pair<int, T>& p1, const std::pair<int, T>& p2) -> bool {
-			return p1.second > p2.second;
+	//B.2 - Compute the magnitudes |vi . Xk|, with Xk the kth-EigenVector
+	Eigen::Matrix<T, 6, Eigen::Dynamic> magnitudes(6, nbCandidates);
+	PointMatcherSupport::parallelForChunks(nbBlocks, chunkCount, [&](const unsigned, const std::size_t firstBlock, const std::size_t lastBlock)
+	{
+		for(std::size_t block = firstBlock; block < lastBlock; ++block)
+		{
+			const std::size_t begin(block * blockSize);
+			const std::size_t end(std::min(begin + blockSize, nbCandidates));
+			auto blockMagnitudes = magnitudes.middleCols(begin, end - begin);
+			blockMagnitudes.noalias() = eigenVe.transpose() * F.middleCols(begin, end - begin);
+			blockMagnitudes = blockMagnitudes.cwiseAbs();
+		}
+	});
+	
+	// ...and the 6 lists of candidates sorted by decreasing magnitude.
+	// Every entry consumed from a list is a distinct sampled point, so at
+	// most nbSample entries of each list are used: only these are sorted.
+	typedef std::pair<Index, T> Candidate;
+	const auto comp = [](const Candidate& c1, const Candidate& c2) -> bool {
+			return c1.second > c2.second || (c1.second == c2.second && c1.first < c2.first);
 		};
-	
-	for(std::size_t k = 0; k < 6; ++k)
-	{		
-		for(std::size_t i = 0; i < nbCandidates; ++i )
+	std::vector<std::vector<Candidate>> L(6); // contain list of pair (index, magnitude) contribution to the eigens vectors
+	PointMatcherSupport::parallelForChunks(6, PointMatcherSupport::getChunkCount(6, nbThreads), [&](const unsigned, const std::size_t begin, const std::size_t end)
+	{
+		for(std::size_t k = begin; k < end; ++k)
 		{
-			L[k].push_back(std::make_pair(i, std::fabs( v[i].dot(eigenVe.template block<6,1>(0, k)) )));
+			std::vector<Candidate>& list(L[k]);
+			list.resize(nbCandidates);
+			for(std::size_t i = 0; i < nbCandidates; ++i)
+				list[i] = Candidate(Index(i), magnitudes(k, i));
+			std::nth_element(list.begin(), list.begin() + nbSample, list.end(), comp);
+			list.resize(nbSample);
+			std::sort(list.begin(), list.end(), comp);
 		}
-		
-		L[k].sort(comp);
-	}	
+	});
 	
 	std::vector<T> t(6, T(0.)); //contains the sums of squared magnitudes
+	std::vector<std::size_t> heads(6, 0); //first entry of each list not consumed yet
 	std::vector<bool> sampledPoints(nbCandidates, false); //maintain flag to avoid resampling the same point in an other list 
 	
 	///Add point iteratively till we got the desired number of point
@@ -209,42 +205,32 @@ void CovarianceSamplingDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
 				k = i;
 		}
 		// Add the point from the top of the list corresponding to the dimension to the set of samples
-		while(sampledPoints[L[k].front().first])
-			L[k].pop_front(); //remove already sampled point
+		while(sampledPoints[L[k][heads[k]].first])
+			++heads[k]; //skip already sampled point
 		
 		//Get index to keep
-		const std::size_t idToKeep = static_cast<std::size_t>(L[k].front().first);
-		L[k].pop_front();
+		const Index idToKeep = L[k][heads[k]].first;
+		++heads[k];
 			
 		sampledPoints[idToKeep] = true; //set flag to avoid resampling
 				
 		//B.4 - Update the running total
 		for (std::size_t k = 0; k < 6; ++k)
 		{
-			const T magnitude = v[idToKeep].dot(eigenVe.template block<6, 1>(0, k));
+			const T magnitude = magnitudes(k, idToKeep);
 			t[k] += (magnitude * magnitude);
 		}
-		
-		keepIndexes[i] = candidates[idToKeep];
 	}
 
-	//TODO: evaluate performances between this solution and sorting the indexes
-	// We build map of (old index to new index), in case we sample pts at the begining of the pointcloud
-	std::unordered_map<std::size_t, std::size_t> mapidx;
-	std::size_t idx = 0;
-	
-	///(4) Sample the point cloud
-	for(std::size_t id : keepIndexes)
+	///(4) Sample the point cloud, keeping the order of the points
+	Index j = 0;
+	for(std::size_t i = 0; i < nbCandidates; ++i)
 	{
-		//retrieve index from lookup table if sampling in already switched element
-		if(id<idx)
-			id = mapidx[id];
-		//Switch columns id and idx
-		cloud.swapCols(idx, id);	
-		//Maintain new index position	
-		mapidx[idx] = id;
-		//Update index
-		++idx;
+		if(sampledPoints[i])
+		{
+			cloud.setColFrom(j, cloud, Index(i));
+			++j;
+		}
 	}
 	cloud.conservativeResize(nbSample);
 }
@@ -254,12 +240,10 @@ void CovarianceSamplingDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
 template <typename T>
 T CovarianceSamplingDataPointsFilter<T>::computeConditionNumber(const Matrix66 &cov)
 {
-	Vector eigenVa = Vector::Identity(6, 1);		
-	
-	Eigen::EigenSolver<Matrix66> solver(cov);		
-	eigenVa = solver.eigenvalues().real();
+	// the eigenvalues of a covariance are its singular values, sorted in decreasing order
+	const Vector6 eigenVa = Eigen::JacobiSVD<Matrix66>(cov).singularValues();
 
-	return eigenVa.maxCoeff() / eigenVa.minCoeff();
+	return eigenVa(0) / eigenVa(5);
 }
 
 template struct CovarianceSamplingDataPointsFilter<float>;
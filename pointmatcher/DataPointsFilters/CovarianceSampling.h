@@ -71,7 +71,8 @@ struct CovarianceSamplingDataPointsFilter : public PointMatcher<T>::DataPointsFi
 	{
 		return {
 			{"nbSample", "Number of point to select.", "5000", "1", "4294967295", &P::Comp<std::size_t>},
-			{"torqueNorm", "Method for torque normalization: (0) L=1 (no normalization, more t-normals), (1) L=Lavg (average distance, torque is scale-independent), (2) L=Lmax (scale in unit ball, more r-normals)", "1", "0", "2", &P::Comp<std::uint8_t>}
+			{"torqueNorm", "Method for torque normalization: (0) L=1 (no normalization, more t-normals), (1) L=Lavg (average distance, torque is scale-independent), (2) L=Lmax (scale in unit ball, more r-normals)", "1", "0", "2", &P::Comp<std::uint8_t>},
+			{"nbThreads", "number of threads used to compute the covariance and the contributions of the points to its eigenvectors, each one processing a contiguous chunk of points. 0: one thread per hardware thread", "1", "0", "2147483647", &P::Comp<unsigned>}
 		};
 	}
 
@@ -79,6 +80,7 @@ struct CovarianceSamplingDataPointsFilter : public PointMatcher<T>::DataPointsFi
 
 	std::size_t nbSample;
 	TorqueNormMethod normalizationMethod;
+	const unsigned nbThreads;
 	
 	//Ctor, uses parameter interface
 	CovarianceSamplingDataPointsFilter(const Parameters& params = Parameters());
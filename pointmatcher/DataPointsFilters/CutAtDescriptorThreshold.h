@@ -73,4 +73,5 @@ struct CutAtDescriptorThresholdDataPointsFilter: public PointMatcher<T>::DataPoi
   CutAtDescriptorThresholdDataPointsFilter(const Parameters& params = Parameters());
   virtual DataPoints filter(const DataPoints& input);
   virtual void inPlaceFilter(DataPoints& cloud);
+  virtual bool isStreamable() const { return true; } //!< every point is filtered on its own
 };
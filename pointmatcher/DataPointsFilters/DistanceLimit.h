@@ -70,4 +70,5 @@ struct DistanceLimitDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	DistanceLimitDataPointsFilter(const Parameters& params = Parameters());
 	virtual DataPoints filter(const DataPoints& input);
 	virtual void inPlaceFilter(DataPoints& cloud);
+	virtual bool isStreamable() const { return true; } //!< every point is filtered on its own
 };
@@ -41,6 +41,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Eigen/Eigenvalues"
 
 #include "PointMatcherPrivate.h"
+#include "Random.h"
 
 // ElipsoidsDataPointsFilter
 
@@ -64,7 +65,8 @@ ElipsoidsDataPointsFilter<T>::ElipsoidsDataPointsFilter(const Parameters& params
 	keepWeights(Parametrizable::get<bool>("keepWeights")),
 	keepMeans(Parametrizable::get<bool>("keepMeans")),
 	keepShapes(Parametrizable::get<bool>("keepShapes")),
-	keepIndices(Parametrizable::get<bool>("keepIndices"))
+	keepIndices(Parametrizable::get<bool>("keepIndices")),
+	seed(Parametrizable::get<std::size_t>("seed"))
 {
 }
 
@@ -327,9 +329,7 @@ void ElipsoidsDataPointsFilter<T>::fuseRange(
   {
     if(C.fullPivHouseholderQr().rank()+1 >= featDim-1)
     {
-      const Eigen::EigenSolver<Matrix> solver(C);
-      eigenVa = solver.eigenvalues().real();
-      eigenVe = solver.eigenvectors().real();
+      computeSortedEigen<T>(C, eigenVa, eigenVe);
     }
     else
     {
@@ -341,7 +341,8 @@ void ElipsoidsDataPointsFilter<T>::fuseRange(
       Eigen::Matrix<T, 3, 1> vals;
       (vals << eigenVa(0),eigenVa(1),eigenVa(2));
       vals = vals/eigenVa.sum();
-      const T planarity = 2 * vals(1)-2*vals(2);
+      // eigenvalues are sorted in ascending order
+      const T planarity = 2 * vals(1)-2*vals(0);
       // throw out surfel if it does not meet planarity criteria
       if (planarity < minPlanarity)
       {
@@ -385,13 +386,14 @@ void ElipsoidsDataPointsFilter<T>::fuseRange(
   // Filter points randomly
   if(samplingMethod == 0)
   {
+    const PointMatcherSupport::CounterRandom random(seed);
     for(int i=0; i<colCount; ++i)
     {
-      const float r = (float)std::rand()/(float)RAND_MAX;
-      if(r < ratio)
+      // Draw keyed by the point index, so the box traversal order does not matter
+      const int k = data.indices[first+i];
+      if(random.uniform(k) < ratio)
       {
         // Keep points with their descriptors
-        const int k = data.indices[first+i];
         // Mark the indices which will be part of the final data
         data.indicesToKeep.push_back(k);
 
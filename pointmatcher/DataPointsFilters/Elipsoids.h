@@ -74,7 +74,8 @@ struct ElipsoidsDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 		{"keepCovariances", "whether the covariances should be added as descriptors to the resulting cloud", "0" },
 		{"keepWeights", "whether the original number of points should be added as descriptors to the resulting cloud", "0" },
 		{"keepShapes", "whether the shape parameters of cylindricity (C), sphericality (S) and planarity (P) shall be calculated", "0" },
-		{"keepIndices", "whether the indices of points an ellipsoid is constructed of shall be kept", "0" }
+		{"keepIndices", "whether the indices of points an ellipsoid is constructed of shall be kept", "0" },
+		{"seed", "seed of the random generator used by random subsampling, the same seed keeping the same points at every call", "1", "0", "4294967295", &P::Comp<std::size_t> }
     }
     ;
   }
@@ -95,6 +96,7 @@ struct ElipsoidsDataPointsFilter: public PointMatcher<T>::DataPointsFilter
   const bool keepMeans;
   const bool keepShapes;
   const bool keepIndices;
+  const std::size_t seed;
 
 
  public:
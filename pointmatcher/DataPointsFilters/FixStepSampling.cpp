@@ -35,6 +35,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "FixStepSampling.h"
 
 #include "PointMatcherPrivate.h"
+#include "Random.h"
 
 
 // FixStepSamplingDataPointsFilter
@@ -46,7 +47,9 @@ FixStepSamplingDataPointsFilter<T>::FixStepSamplingDataPointsFilter(const Parame
 	startStep(Parametrizable::get<unsigned>("startStep")),
 	endStep(Parametrizable::get<unsigned>("endStep")),
 	stepMult(Parametrizable::get<double>("stepMult")),
-	step(startStep)
+	seed(Parametrizable::get<std::size_t>("seed")),
+	step(startStep),
+	callCount(0)
 {
 	LOG_INFO_STREAM("Using FixStepSamplingDataPointsFilter with startStep=" << startStep << ", endStep=" << endStep << ", stepMult=" << stepMult);
 }
@@ -56,6 +59,7 @@ template<typename T>
 void FixStepSamplingDataPointsFilter<T>::init()
 {
 	step = startStep;
+	callCount = 0;
 }
 
 // Compute
@@ -74,7 +78,8 @@ void FixStepSamplingDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
 {
 	const int iStep(step);
 	const int nbPointsIn = cloud.features.cols();
-	const int phase(rand() % iStep);
+	const PointMatcherSupport::CounterRandom random(seed);
+	const int phase(random.uniformInt(callCount++, iStep));
 
 	int j = 0;
 	for (int i = phase; i < nbPointsIn; i += iStep)
@@ -58,7 +58,8 @@ struct FixStepSamplingDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 		return {
 			{"startStep", "initial number of point to skip (initial decimation factor)", "10", "1", "2147483647", &P::Comp<unsigned>},
 			{"endStep", "maximal or minimal number of points to skip (final decimation factor)", "10", "1", "2147483647", &P::Comp<unsigned>},
-			{"stepMult", "multiplication factor to compute the new decimation factor for each iteration", "1", "0.0000001", "inf", &P::Comp<double>}
+			{"stepMult", "multiplication factor to compute the new decimation factor for each iteration", "1", "0.0000001", "inf", &P::Comp<double>},
+			{"seed", "seed of the random generator drawing the first point kept, the sequence of phases restarting at each init", "1", "0", "4294967295", &P::Comp<std::size_t>}
 		};
 	}
 	
@@ -66,9 +67,12 @@ struct FixStepSamplingDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	const unsigned startStep;
 	const unsigned endStep;
 	const double stepMult;
+	const std::size_t seed;
 
 protected:
 	double step;
+	//! number of calls since init, indexing the random phase of each call
+	std::uint64_t callCount;
 	
 public:
 	FixStepSamplingDataPointsFilter(const Parameters& params = Parameters());
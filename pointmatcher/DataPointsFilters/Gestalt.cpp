@@ -43,6 +43,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Eigen/Eigenvalues"
 
 #include "PointMatcherPrivate.h"
+#include "Random.h"
 
 #include <vector>
 
@@ -69,7 +70,8 @@ GestaltDataPointsFilter<T>::GestaltDataPointsFilter(const Parameters& params):
 	keepEigenValues(Parametrizable::get<bool>("keepEigenValues")),
 	keepEigenVectors(Parametrizable::get<bool>("keepEigenVectors")),
 	keepCovariances(Parametrizable::get<bool>("keepCovariances")),
-	keepGestaltFeatures(Parametrizable::get<bool>("keepGestaltFeatures"))
+	keepGestaltFeatures(Parametrizable::get<bool>("keepGestaltFeatures")),
+	seed(Parametrizable::get<std::size_t>("seed"))
 {
 }
 
@@ -293,6 +295,10 @@ void GestaltDataPointsFilter<T>::buildNew(
   // store which points contain voxel position
   std::vector<unsigned int> pointsToKeep;
 
+  // two independent streams: one for the point picked per voxel, one for the ratio subsampling
+  const PointMatcherSupport::CounterRandom pickRandom(seed, 0);
+  const PointMatcherSupport::CounterRandom ratioRandom(seed, 1);
+
   // take centers of voxels for now
   // Todo revert to random point selection within cell
   for (int p = 0; p < numPoints ; ++p)
@@ -301,7 +307,7 @@ void GestaltDataPointsFilter<T>::buildNew(
     const unsigned int firstPoint = voxels[idx].firstPoint;
 
     // Choose random point in voxel
-    const int randomIndex = std::rand() % numPoints;
+    const int randomIndex = pickRandom.uniformInt(first + p, numPoints);
     for (int f = 0; f < (featDim - 1); ++f)
     {
       data.features(f,firstPoint) = data.features(f,randomIndex);
@@ -328,11 +334,10 @@ void GestaltDataPointsFilter<T>::buildNew(
   // downsample with ratio
   for(unsigned int i=0; i<nbPointsToKeep; ++i)
   {
-    const float r = (float)std::rand()/(float)RAND_MAX;
-    if(r < ratio)
+    const int k = pointsToKeep[i];
+    if(ratioRandom.uniform(k) < ratio)
     {
       // Keep points with their descriptors
-      const int k = pointsToKeep[i];
       // Mark the indices which will be part of the final data
       data.indicesToKeep.push_back(k);
     }
@@ -410,9 +415,7 @@ void GestaltDataPointsFilter<T>::fuseRange(
     {
       if(C.fullPivHouseholderQr().rank()+1 >= featDim-1)
       {
-        const Eigen::EigenSolver<Matrix> solver(C);
-        eigenVa = solver.eigenvalues().real();
-        eigenVe = solver.eigenvectors().real();
+        computeSortedEigen<T>(C, eigenVa, eigenVe);
       }
       else
       {
@@ -73,7 +73,8 @@ struct GestaltDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 		{"keepEigenValues", "whether the eigen values should be added as descriptors to the resulting cloud", "0"},
 		{"keepEigenVectors", "whether the eigen vectors should be added as descriptors to the resulting cloud", "0"},
 		{"keepCovariances", "whether the covariances should be added as descriptors to the resulting cloud", "0"},
-		{"keepGestaltFeatures", "whether the Gestalt features shall be added to the resulting cloud", "1"}
+		{"keepGestaltFeatures", "whether the Gestalt features shall be added to the resulting cloud", "1"},
+		{"seed", "seed of the random generator used by random subsampling, the same seed keeping the same points at every call", "1", "0", "4294967295", &P::Comp<std::size_t>}
     };
   }
 
@@ -92,6 +93,7 @@ struct GestaltDataPointsFilter: public PointMatcher<T>::DataPointsFilter
   const bool keepEigenVectors;
   const bool keepCovariances;
   const bool keepGestaltFeatures;
+  const std::size_t seed;
 
 
  public:
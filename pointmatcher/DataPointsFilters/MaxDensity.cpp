@@ -33,6 +33,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 */
 #include "MaxDensity.h"
+#include "Parallel.h"
+#include "Random.h"
+
+#include <vector>
 
 // MaxDensityDataPointsFilter
 // Constructor
@@ -40,8 +44,17 @@ template<typename T>
 MaxDensityDataPointsFilter<T>::MaxDensityDataPointsFilter(const Parameters& params):
 	PointMatcher<T>::DataPointsFilter("MaxDensityDataPointsFilter", 
 		MaxDensityDataPointsFilter::availableParameters(), params),
-	maxDensity(Parametrizable::get<T>("maxDensity"))
+	maxDensity(Parametrizable::get<T>("maxDensity")),
+	seed(Parametrizable::get<std::size_t>("seed")),
+	nbThreads(Parametrizable::get<unsigned>("nbThreads")),
+	callCount(0)
+{
+}
+
+template<typename T>
+void MaxDensityDataPointsFilter<T>::init()
 {
+	callCount = 0;
 }
 
 // Compute
@@ -72,29 +85,39 @@ void MaxDensityDataPointsFilter<T>::inPlaceFilter(
 	const T lastDensity = densities.maxCoeff();
 	const int nbSaturatedPts = (densities.array() == lastDensity).count();
 
-	// fill cloud values
-	int j = 0;
-	for (int i = 0; i < nbPointsIn; ++i)
+	// draw the kept points, the number drawn for a point only depending on
+	// its index and on the call, so that the kept points do not depend on the
+	// number of threads, but change from a call to the next one
+	const PointMatcherSupport::CounterRandom random(seed, callCount++);
+	std::vector<char> keep(nbPointsIn);
+	PointMatcherSupport::parallelForChunks(nbPointsIn, PointMatcherSupport::getChunkCount(nbPointsIn, nbThreads, 65536), [&](const unsigned, const size_t begin, const size_t end)
 	{
-		const T density(densities(0,i));
-		if (density > maxDensity)
+		for (size_t i = begin; i < end; ++i)
 		{
-			const float r = (float)std::rand()/(float)RAND_MAX;
-			float acceptRatio = maxDensity/density;
-
-			// Handle saturation value of density
-			if (density == lastDensity)
+			const T density(densities(0,i));
+			if (density > maxDensity)
 			{
-				acceptRatio = acceptRatio * (1-nbSaturatedPts/nbPointsIn);
-			}
+				const float r = random.uniform(i);
+				float acceptRatio = maxDensity/density;
 
-			if (r < acceptRatio)
-			{
-				cloud.setColFrom(j, cloud, i);
-				++j;
+				// Handle saturation value of density
+				if (density == lastDensity)
+				{
+					acceptRatio = acceptRatio * (1-nbSaturatedPts/nbPointsIn);
+				}
+
+				keep[i] = r < acceptRatio;
 			}
+			else
+				keep[i] = true;
 		}
-		else
+	});
+
+	// fill cloud values
+	int j = 0;
+	for (int i = 0; i < nbPointsIn; ++i)
+	{
+		if (keep[i])
 		{
 			cloud.setColFrom(j, cloud, i);
 			++j;
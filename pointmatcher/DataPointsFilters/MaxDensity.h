@@ -57,14 +57,24 @@ struct MaxDensityDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	inline static const ParametersDoc availableParameters()
 	{
 		return {
-			{"maxDensity", "Maximum density of points to target. Unit: number of points per m^3.", "10", "0.0000001", "inf", &P::Comp<T>}
+			{"maxDensity", "Maximum density of points to target. Unit: number of points per m^3.", "10", "0.0000001", "inf", &P::Comp<T>},
+			{"seed", "seed of the random generator, each call drawing other points and the sequence of calls restarting at each init", "1", "0", "4294967295", &P::Comp<std::size_t>},
+			{"nbThreads", "number of threads used to draw the kept points, each one processing a contiguous chunk of points. 0: one thread per hardware thread", "1", "0", "2147483647", &P::Comp<unsigned>}
 		};
 	}
 	
 	const T maxDensity;
-	
+	const std::size_t seed;
+	const unsigned nbThreads;
+
+protected:
+	//! number of calls since init, indexing the random stream of each call
+	std::uint64_t callCount;
+
+public:
 	//! Constructor, uses parameter interface
 	MaxDensityDataPointsFilter(const Parameters& params = Parameters());
+	virtual void init();
 	virtual DataPoints filter(const DataPoints& input);
 	virtual void inPlaceFilter(DataPoints& cloud);
 };
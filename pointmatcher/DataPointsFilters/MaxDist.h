@@ -68,4 +68,5 @@ struct MaxDistDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	MaxDistDataPointsFilter(const Parameters& params = Parameters());
 	virtual DataPoints filter(const DataPoints& input);
 	virtual void inPlaceFilter(DataPoints& cloud);
+	virtual bool isStreamable() const { return true; } //!< every point is filtered on its own
 };
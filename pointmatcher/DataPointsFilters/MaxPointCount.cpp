@@ -33,6 +33,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 */
 #include "MaxPointCount.h"
+#include "Random.h"
 
 // MaxPointCountDataPointsFilter
 // Constructor
@@ -70,13 +71,13 @@ void MaxPointCountDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
 	
 	if (maxCount <= N) 
 	{
-		//Re-init seed at each call, to ensure same results
-		std::srand(seed);
+		//Draw from the same numbers at each call, to ensure same results
+		const PointMatcherSupport::CounterRandom random(seed);
 		
 		for(size_t j=0; j<maxCount; ++j)
 		{
 			//Get a random index in [j; N]
-			const size_t idx = j + static_cast<size_t>((N-j)*(static_cast<float>(std::rand()/static_cast<float>(RAND_MAX))));
+			const size_t idx = j + random.uniformInt(j, N - j + 1);
 			
 			//Switch columns j and idx
 			const auto feat = cloud.features.col(j);
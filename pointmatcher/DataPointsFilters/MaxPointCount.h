@@ -56,7 +56,7 @@ struct MaxPointCountDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	inline static const ParametersDoc availableParameters()
 	{
 		return {
-			{"seed",     "srand seed",               "1",    "0", "2147483647", &P::Comp<size_t>},
+			{"seed",     "seed of the random generator",               "1",    "0", "2147483647", &P::Comp<size_t>},
 			{"maxCount", "maximum number of points", "1000", "0", "2147483647", &P::Comp<size_t>}
 		}
 		;
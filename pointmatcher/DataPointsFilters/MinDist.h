@@ -68,4 +68,5 @@ struct MinDistDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	MinDistDataPointsFilter(const Parameters& params = Parameters());
 	virtual DataPoints filter(const DataPoints& input);
 	virtual void inPlaceFilter(DataPoints& cloud);
+	virtual bool isStreamable() const { return true; } //!< every point is filtered on its own
 };
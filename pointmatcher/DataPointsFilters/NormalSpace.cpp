@@ -33,14 +33,13 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 */
 #include "NormalSpace.h"
+#include "Parallel.h"
+#include "Random.h"
 
 #include <algorithm>
 #include <vector>
-#include <unordered_map>
-#include <random>
 #include <ciso646>
 #include <cmath>
-#include <numeric>
 
 // NormalSpaceDataPointsFilter
 template <typename T>
@@ -50,7 +49,12 @@ NormalSpaceDataPointsFilter<T>::NormalSpaceDataPointsFilter(const Parameters& pa
 	nbSample{Parametrizable::get<std::size_t>("nbSample")},
 	seed{Parametrizable::get<std::size_t>("seed")},
 	epsilon{Parametrizable::get<T>("epsilon")},
-	nbBucket{std::size_t(ceil(2.0 * M_PI / epsilon) * ceil(M_PI / epsilon))}
+	nbThreads{Parametrizable::get<unsigned>("nbThreads")},
+	// arcs of at most epsilon radians
+	nbBucketOnCircle{std::size_t(ceil(2.0 * M_PI / epsilon))},
+	// buckets of at most epsilon^2 steradians, as the map preserves areas
+	// and its square of side 2 covers the 4pi steradians of the sphere
+	nbBucketBySide{std::size_t(ceil(2.0 * sqrt(M_PI) / epsilon))}
 {
 }
 
@@ -63,121 +67,161 @@ NormalSpaceDataPointsFilter<T>::filter(const DataPoints& input)
 	return output;
 }
 
-//TODO: Add support for 2D by building histogram of polar coordinate with uniform sampling
-
 template <typename T>
 void NormalSpaceDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
 {
-	//check dimension
-	const std::size_t featDim = cloud.features.rows();
-	if(featDim < 4) //3D case support only
-	{
-		std::cerr << "ERROR: NormalSpaceDataPointsFilter does not support 2D point cloud yet (does nothing)" << std::endl;
-		return;
-	}
-		
 	//Check number of points
-	const int nbPoints = cloud.getNbPoints();		
-	if(nbSample >= std::size_t(nbPoints))
+	const std::size_t nbPoints = cloud.getNbPoints();
+	if(nbSample >= nbPoints)
 		return;
 
 	//Check if there is normals info
 	if (!cloud.descriptorExists("normals"))
-		throw InvalidField("OrientNormalsDataPointsFilter: Error, cannot find normals in descriptors.");
+		throw InvalidField("NormalSpaceDataPointsFilter: Error, cannot find normals in descriptors.");
 
 	const auto& normals = cloud.getDescriptorViewByName("normals");
-	
-	std::mt19937 gen(seed); //Standard mersenne_twister_engine seeded with seed
-
-	//bucketed normal space
-	std::vector<std::vector<int> > idBuckets;
-	idBuckets.resize(nbBucket);
-	
-	std::vector<std::size_t> keepIndexes;
-	keepIndexes.reserve(nbSample);
-
-	// Generate a random sequence of indices so that elements are placed in buckets in random order
-	std::vector<std::size_t> randIdcs(nbPoints);
-	std::iota(randIdcs.begin(), randIdcs.end(), 0);
-	std::random_shuffle(randIdcs.begin(), randIdcs.end());
-
-	///(1) put all points of the data into buckets based on their normal direction
-	for (auto randIdx : randIdcs)
+	const bool is3D = cloud.features.rows() >= 4;
+	if (normals.rows() < (is3D ? 3 : 2))
+		throw InvalidField("NormalSpaceDataPointsFilter: Error, normals have less dimensions than the point cloud.");
+	const std::size_t nbBucket = is3D ? nbBucketBySide * nbBucketBySide : nbBucketOnCircle;
+
+	///(1) put all points of the data into buckets based on their normal direction,
+	// each chunk counting its points per bucket
+	const unsigned chunkCount = PointMatcherSupport::getChunkCount(nbPoints, nbThreads, 65536);
+	std::vector<std::size_t> pointBuckets(nbPoints);
+	std::vector<std::size_t> chunkBucketCounts(chunkCount * nbBucket, 0);
+	PointMatcherSupport::parallelForChunks(nbPoints, chunkCount, [&](const unsigned chunk, const std::size_t begin, const std::size_t end)
+	{
+		std::size_t* bucketCounts = &chunkBucketCounts[chunk * nbBucket];
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			const std::size_t bucket = is3D ?
+				sphereBucketIdx(normals(0, i), normals(1, i), normals(2, i)) :
+				circleBucketIdx(normals(0, i), normals(1, i));
+			pointBuckets[i] = bucket;
+			++bucketCounts[bucket];
+		}
+	});
+
+	// Store the buckets in compressed form: the points of bucket b are
+	// bucketPoints[bucketBegins[b]] to bucketPoints[bucketBegins[b+1]-1],
+	// by increasing index, so that they do not depend on the number of threads
+	std::vector<std::size_t> bucketBegins(nbBucket + 1);
+	std::size_t offset = 0;
+	for (std::size_t bucket = 0; bucket < nbBucket; ++bucket)
 	{
-		// Allow for slight approximiation errors
-		assert(normals.col(randIdx).head(3).norm() >= 1.0-0.00001);
-		assert(normals.col(randIdx).head(3).norm() <= 1.0+0.00001);
-		// Catch errors where theta will be NaN
-		assert((normals(2,randIdx) <= 1.0) && (normals(2,randIdx) >= -1.0));
-
-		//Theta = polar angle in [0 ; pi]
-		const T theta = std::acos(normals(2, randIdx));
-		//Phi = azimuthal angle in [0 ; 2pi]
-		const T phi = std::fmod(std::atan2(normals(1, randIdx), normals(0, randIdx)) + 2. * M_PI, 2. * M_PI);
-
-		// Catch normal space hashing errors
-		assert(bucketIdx(theta, phi) < nbBucket);
-		idBuckets[bucketIdx(theta, phi)].push_back(randIdx);
+		bucketBegins[bucket] = offset;
+		for (unsigned chunk = 0; chunk < chunkCount; ++chunk)
+		{
+			std::size_t& bucketCount = chunkBucketCounts[chunk * nbBucket + bucket];
+			const std::size_t count = bucketCount;
+			// from now on, the position where the chunk writes its next point of the bucket
+			bucketCount = offset;
+			offset += count;
+		}
 	}
+	bucketBegins[nbBucket] = offset;
 
-	// Remove empty buckets
-	idBuckets.erase(std::remove_if(idBuckets.begin(), idBuckets.end(),
-				[](const std::vector<int>& bucket) { return bucket.empty(); }),
-				idBuckets.end());
+	std::vector<std::size_t> bucketPoints(nbPoints);
+	PointMatcherSupport::parallelForChunks(nbPoints, chunkCount, [&](const unsigned chunk, const std::size_t begin, const std::size_t end)
+	{
+		std::size_t* bucketCursors = &chunkBucketCounts[chunk * nbBucket];
+		for (std::size_t i = begin; i < end; ++i)
+			bucketPoints[bucketCursors[pointBuckets[i]]++] = i;
+	});
+
+	// Non-empty buckets, an emptied bucket being replaced by the last one
+	std::vector<std::size_t> activeBuckets;
+	for (std::size_t bucket = 0; bucket < nbBucket; ++bucket)
+		if (bucketBegins[bucket] != bucketBegins[bucket + 1])
+			activeBuckets.push_back(bucket);
+	// First point of each bucket not picked yet
+	std::vector<std::size_t> bucketHeads(bucketBegins.begin(), bucketBegins.end() - 1);
+
+	//Draw from the same numbers at each call, one stream to pick the buckets and one to pick the points in them
+	const PointMatcherSupport::CounterRandom bucketRandom(seed, 1);
+	const PointMatcherSupport::CounterRandom pointRandom(seed, 0);
 
 	///(2) uniformly pick points from all the buckets until the desired number of points is selected
-	for (std::size_t i=0; i<nbSample; i++)
+	std::vector<char> keep(nbPoints, false);
+	for (std::size_t i = 0; i < nbSample; ++i)
 	{
 		// Get a random bucket
-		std::uniform_int_distribution<std::size_t> uniBucket(0,idBuckets.size()-1);
-		std::size_t curBucketIdx = uniBucket(gen);
-		std::vector<int>& curBucket = idBuckets[curBucketIdx];
+		const std::size_t activeIdx = bucketRandom.uniformInt(i, activeBuckets.size());
+		const std::size_t bucket = activeBuckets[activeIdx];
+		std::size_t& head = bucketHeads[bucket];
+		const std::size_t bucketEnd = bucketBegins[bucket + 1];
 
 		///(3) A point is randomly picked in a bucket that contains multiple points
-		int idToKeep = curBucket[curBucket.size()-1];
-		curBucket.pop_back();
-		keepIndexes.push_back(static_cast<std::size_t>(idToKeep));
+		std::swap(bucketPoints[head], bucketPoints[head + pointRandom.uniformInt(i, bucketEnd - head)]);
+		keep[bucketPoints[head]] = true;
+		++head;
 
 		// Remove the bucket if it is empty
-		if (curBucket.empty()) {
-			idBuckets.erase(idBuckets.begin()+curBucketIdx);
+		if (head == bucketEnd)
+		{
+			activeBuckets[activeIdx] = activeBuckets.back();
+			activeBuckets.pop_back();
 		}
 	}
 
-	//TODO: evaluate performances between this solution and sorting the indexes
-	// We build map of (old index to new index), in case we sample pts at the begining of the pointcloud
-	std::unordered_map<std::size_t, std::size_t> mapidx;
-	std::size_t idx = 0;
-	
-	///(4) Sample the point cloud
-	for(std::size_t id : keepIndexes)
+	///(4) Sample the point cloud, keeping the order of the points
+	std::size_t j = 0;
+	for (std::size_t i = 0; i < nbPoints; ++i)
 	{
-		//retrieve index from lookup table if sampling in already switched element
-		if(id<idx)
-			id = mapidx[id];
-		//Switch columns id and idx
-		cloud.swapCols(idx, id);	
-		//Maintain new index position	
-		mapidx[idx] = id;
-		//Update index
-		++idx;
+		if (keep[i])
+		{
+			cloud.setColFrom(j, cloud, i);
+			++j;
+		}
 	}
 	cloud.conservativeResize(nbSample);
 }
 
+//! Return the cell of position in [0, count), clamping out-of-range and NaN positions
 template <typename T>
-std::size_t NormalSpaceDataPointsFilter<T>::bucketIdx(T theta, T phi) const
+static std::size_t bucketCell(const T position, const std::size_t count)
 {
-	//Theta = polar angle in [0 ; pi] and Phi = azimuthal angle in [0 ; 2pi]
-	assert( (theta >= 0.0) && (theta <= static_cast<T>(M_PI)) && "Theta not in [0, Pi]");
-	assert( (phi >= 0) && (phi <= 2*static_cast<T>(M_PI)) && "Phi not in [0, 2Pi]");
-
-	// Wrap Theta at Pi
-	if (theta == static_cast<T>(M_PI)) { theta = 0.0; };
-	// Wrap Phi at 2Pi
-	if (phi == 2*static_cast<T>(M_PI)) { phi = 0.0; };
-	//                               block number           block size               element number
-	return static_cast<std::size_t>( floor(theta/epsilon) * ceil(2.0*M_PI/epsilon) + floor(phi/epsilon) );
+	return static_cast<std::size_t>(std::max(T(0), std::min(T(count - 1), position)));
+}
+
+template <typename T>
+std::size_t NormalSpaceDataPointsFilter<T>::circleBucketIdx(const T x, const T y) const
+{
+	// Angle of the normal, in [0 ; 2pi), counter-clockwise from x
+	T angle = std::atan2(y, x);
+	if (angle < 0)
+		angle += T(2 * M_PI);
+	return bucketCell<T>(angle * T(nbBucketOnCircle) / T(2 * M_PI), nbBucketOnCircle);
+}
+
+template <typename T>
+std::size_t NormalSpaceDataPointsFilter<T>::sphereBucketIdx(const T x, const T y, const T z) const
+{
+	// Equal-area octahedral map (Clarberg, 2008): in the octant of the normal,
+	// the distance to the pole maps to the diamond of radius r = sqrt(1-|z|),
+	// and the azimuth maps linearly to the position along that diamond
+	const T ax = std::abs(x);
+	const T ay = std::abs(y);
+	const T r = std::sqrt(std::max(T(0), 1 - std::abs(z)));
+	T t = std::atan2(std::min(ax, ay), std::max(ax, ay)) * T(2 / M_PI);
+	if (ax < ay)
+		t = 1 - t;
+	T v = t * r;
+	T u = r - v;
+	// Unfold the lower half on the corners of the square [-1 ; 1]^2
+	if (z < 0)
+	{
+		const T foldedU = 1 - v;
+		v = 1 - u;
+		u = foldedU;
+	}
+	if (x < 0)
+		u = -u;
+	if (y < 0)
+		v = -v;
+	const T scale = T(nbBucketBySide) / 2;
+	return bucketCell<T>((v + 1) * scale, nbBucketBySide) * nbBucketBySide + bucketCell<T>((u + 1) * scale, nbBucketBySide);
 }
 
 template struct NormalSpaceDataPointsFilter<float>;
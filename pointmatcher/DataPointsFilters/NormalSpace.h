@@ -57,15 +57,16 @@ struct NormalSpaceDataPointsFilter : public PointMatcher<T>::DataPointsFilter
 
 	inline static const std::string description()
 	{
-		return "Normal Space Sampling (NSS) \\cite{Rusinkiewicz2001}. Construct a set of buckets in the normal-space, then put all points of the data into buckets based on their normal direction; Finally, uniformly pick points from all the buckets until the desired number of points is selected. **Required** to compute normals as pre-step.";
+		return "Normal Space Sampling (NSS) \\cite{Rusinkiewicz2001}. Construct a set of buckets in the normal-space, then put all points of the data into buckets based on their normal direction; Finally, uniformly pick points from all the buckets until the desired number of points is selected. In 3D, the buckets are the cells of a grid over the equal-area octahedral map of the sphere of normals, all covering the same solid angle; in 2D, they are equal arcs of the circle of normals. **Required** to compute normals as pre-step.";
 	}
 
 	inline static const ParametersDoc availableParameters()
 	{
 		return {
 			{"nbSample", "Number of point to select.", "5000", "1", "4294967295", &P::Comp<std::size_t>},
-			{"seed", "Seed for the random generator.", "1", "0", "4294967295", &P::Comp<std::size_t>},
-			{"epsilon", "Step of discretization for the angle spaces", "0.09817477042" /* PI/32 */, "0.04908738521" /* PI/64 */, "3.14159265359" /* PI */, &P::Comp<T>}
+			{"seed", "Seed for the random generator, the same seed keeping the same points at every call.", "1", "0", "4294967295", &P::Comp<std::size_t>},
+			{"epsilon", "Step of discretization for the angle spaces, i.e. approximate angular size of a bucket", "0.09817477042" /* PI/32 */, "0.04908738521" /* PI/64 */, "3.14159265359" /* PI */, &P::Comp<T>},
+			{"nbThreads", "number of threads used to put the points into buckets, each one processing a contiguous chunk of points. 0: one thread per hardware thread", "1", "0", "2147483647", &P::Comp<unsigned>}
 		};
 	}
 
@@ -73,6 +74,7 @@ public:
 	const std::size_t nbSample;
 	const std::size_t seed;
 	const T epsilon;
+	const unsigned nbThreads;
 	
 	//Ctor, uses parameter interface
 	NormalSpaceDataPointsFilter(const Parameters& params = Parameters());
@@ -85,9 +87,15 @@ public:
 	virtual void inPlaceFilter(DataPoints& cloud);
 
 private:
-	inline std::size_t bucketIdx(T theta, T phi) const;
+	//! Return the bucket of a 2D normal, among equal arcs of the unit circle
+	std::size_t circleBucketIdx(const T x, const T y) const;
+	//! Return the bucket of a 3D normal, in the grid over its equal-area octahedral map
+	std::size_t sphereBucketIdx(const T x, const T y, const T z) const;
 	
-	const std::size_t nbBucket;
+	//! Number of buckets on the circle of 2D normals
+	const std::size_t nbBucketOnCircle;
+	//! Number of buckets along each side of the octahedral map of 3D normals
+	const std::size_t nbBucketBySide;
 };
 	
 
@@ -77,4 +77,5 @@ struct ObservationDirectionDataPointsFilter: public PointMatcher<T>::DataPointsF
 	ObservationDirectionDataPointsFilter(const Parameters& params = Parameters());
 	virtual DataPoints filter(const DataPoints& input);
 	virtual void inPlaceFilter(DataPoints& cloud);
+	virtual bool isStreamable() const { return true; } //!< every point is filtered on its own
 };
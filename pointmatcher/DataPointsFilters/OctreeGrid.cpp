@@ -44,8 +44,8 @@ OctreeGridDataPointsFilter<T>::FirstPtsSampler::FirstPtsSampler(DataPoints& dp)
 }
 
 template <typename T>
-template<std::size_t dim>
-bool OctreeGridDataPointsFilter<T>::FirstPtsSampler::operator()(Octree_<T,dim>& oc)
+template<typename Node>
+bool OctreeGridDataPointsFilter<T>::FirstPtsSampler::operator()(Node& oc)
 {
 	if(oc.isLeaf() and not oc.isEmpty())
 	{			
@@ -83,28 +83,25 @@ bool OctreeGridDataPointsFilter<T>::FirstPtsSampler::finalize()
 
 template<typename T>
 OctreeGridDataPointsFilter<T>::RandomPtsSampler::RandomPtsSampler(DataPoints& dp) 
-	: OctreeGridDataPointsFilter<T>::FirstPtsSampler{dp}, seed{1}
+	: OctreeGridDataPointsFilter<T>::FirstPtsSampler{dp}, seed{1}, random{seed}
 {
-	std::srand(seed);
 }
 template<typename T>
 OctreeGridDataPointsFilter<T>::RandomPtsSampler::RandomPtsSampler(
 	DataPoints& dp, const std::size_t seed_
-): OctreeGridDataPointsFilter<T>::FirstPtsSampler{dp}, seed{seed_}
+): OctreeGridDataPointsFilter<T>::FirstPtsSampler{dp}, seed{seed_}, random{seed}
 {
-	std::srand(seed);
 }
 template<typename T>
-template<std::size_t dim>
-bool OctreeGridDataPointsFilter<T>::RandomPtsSampler::operator()(Octree_<T,dim>& oc)
+template<typename Node>
+bool OctreeGridDataPointsFilter<T>::RandomPtsSampler::operator()(Node& oc)
 {
 	if(oc.isLeaf() and not oc.isEmpty())
 	{			
 		auto* data = oc.getData();
-		const std::size_t nbData = (*data).size() - 1;
-		const std::size_t randId = 
-			static_cast<std::size_t>( nbData * 
-				(static_cast<float>(std::rand()/static_cast<float>(RAND_MAX))));
+		const std::size_t nbData = (*data).size();
+		//Draw the point of the idx-th sampled leaf
+		const std::size_t randId = random.uniformInt(idx, nbData);
 				
 		const auto& d = (*data)[randId];
 		
@@ -129,11 +126,7 @@ bool OctreeGridDataPointsFilter<T>::RandomPtsSampler::operator()(Octree_<T,dim>&
 template<typename T>
 bool OctreeGridDataPointsFilter<T>::RandomPtsSampler::finalize()
 {
-	bool ret = FirstPtsSampler::finalize();
-	//Reset seed
-	std::srand(seed);
-	
-	return ret;			
+	return FirstPtsSampler::finalize();
 }
 
 template<typename T>
@@ -143,8 +136,8 @@ OctreeGridDataPointsFilter<T>::CentroidSampler::CentroidSampler(DataPoints& dp)
 }
 	
 template<typename T>
-template<std::size_t dim>
-bool OctreeGridDataPointsFilter<T>::CentroidSampler::operator()(Octree_<T,dim>& oc)
+template<typename Node>
+bool OctreeGridDataPointsFilter<T>::CentroidSampler::operator()(Node& oc)
 {
 	if(oc.isLeaf() and not oc.isEmpty())
 	{			
@@ -215,20 +208,23 @@ OctreeGridDataPointsFilter<T>::MedoidSampler::MedoidSampler(DataPoints& dp)
 }
 	
 template<typename T>
-template<std::size_t dim>
-bool OctreeGridDataPointsFilter<T>::MedoidSampler::operator()(Octree_<T,dim>& oc)
+template<typename Node>
+bool OctreeGridDataPointsFilter<T>::MedoidSampler::operator()(Node& oc)
 {
 	if(oc.isLeaf() and not oc.isEmpty())
 	{		
+		typedef typename Node::Point Point;
+		const std::size_t dim(Point::RowsAtCompileTime);
+		
 		auto* data = oc.getData();
 		const std::size_t nbData = (*data).size();
 
-		auto dist = [](const typename Octree_<T,dim>::Point& p1, const typename Octree_<T,dim>::Point& p2) -> T {		
+		auto dist = [](const Point& p1, const Point& p2) -> T {		
 				return (p1 - p2).norm();		
 			};
 			
 		//Build centroid
-		typename Octree_<T,dim>::Point center;
+		Point center;
 		for(std::size_t i=0;i<dim;++i) center(i)=T(0.);
 		
 		for(std::size_t id=0;id<nbData;++id)
@@ -288,7 +284,8 @@ OctreeGridDataPointsFilter<T>::OctreeGridDataPointsFilter(const Parameters& para
 		OctreeGridDataPointsFilter::availableParameters(), params),
 	buildParallel{Parametrizable::get<bool>("buildParallel")},
 	maxPointByNode{Parametrizable::get<std::size_t>("maxPointByNode")},
-	maxSizeByNode{Parametrizable::get<T>("maxSizeByNode")}
+	maxSizeByNode{Parametrizable::get<T>("maxSizeByNode")},
+	seed{Parametrizable::get<std::size_t>("seed")}
 {
 	try 
 	{
@@ -328,9 +325,9 @@ template<typename T>
 template<std::size_t dim>
 void OctreeGridDataPointsFilter<T>::sample(DataPoints& cloud)
 {
-	Octree_<T,dim> oc;
+	LinearOctree_<T,dim> oc;
 	
-	oc.build(cloud, maxPointByNode, maxSizeByNode, buildParallel);
+	oc.build(cloud, maxPointByNode, maxSizeByNode, buildParallel ? 0 : 1);
 	
 	switch(samplingMethod)
 	{
@@ -343,7 +340,7 @@ void OctreeGridDataPointsFilter<T>::sample(DataPoints& cloud)
 		}
 		case SamplingMethod::RAND_PTS:
 		{
-			RandomPtsSampler sampler(cloud); //FIXME: add seed parameter
+			RandomPtsSampler sampler(cloud, seed);
 			oc.visit(sampler);
 			sampler.finalize();
 			break;
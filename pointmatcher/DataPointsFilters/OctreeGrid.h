@@ -36,6 +36,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "PointMatcher.h"
 #include "utils/octree.h"
+#include "utils/linearoctree.h"
+#include "Random.h"
 
 #include <unordered_map>
 
@@ -77,11 +79,11 @@ struct OctreeGridDataPointsFilter : public PointMatcher<T>::DataPointsFilter
 	inline static const ParametersDoc availableParameters()
 	{
 		return {
-			{"buildParallel", "If 1 (true), use threads to build the octree.", "1", "0", "1", P::Comp<bool>},
+			{"buildParallel", "If 1 (true), build the octree with one thread per hardware thread.", "1", "0", "1", P::Comp<bool>},
 			{"maxPointByNode", "Number of point under which the octree stop dividing.", "1", "1", "4294967295", &P::Comp<std::size_t>},
 			{"maxSizeByNode", "Size of the bounding box under which the octree stop dividing.", "0", "0", "+inf", &P::Comp<T>},
-			{"samplingMethod", "Method to sample the Octree: First Point (0), Random (1), Centroid (2) (more accurate but costly), Medoid (3) (more accurate but costly)", "0", "0", "3", &P::Comp<int>}
-		//FIXME: add seed parameter for the random sampling
+			{"samplingMethod", "Method to sample the Octree: First Point (0), Random (1), Centroid (2) (more accurate but costly), Medoid (3) (more accurate but costly)", "0", "0", "3", &P::Comp<int>},
+			{"seed", "seed of the random generator of the Random sampling method, the same seed keeping the same points at every call", "1", "0", "4294967295", &P::Comp<std::size_t>}
 		};
 	}
 
@@ -99,8 +101,8 @@ public:
 		FirstPtsSampler(DataPoints& dp);
 		virtual ~FirstPtsSampler(){}
 		
-		template<std::size_t dim>
-		bool operator()(Octree_<T,dim>& oc);
+		template<typename Node>
+		bool operator()(Node& oc);
 		
 		virtual bool finalize();
 	};
@@ -111,13 +113,14 @@ public:
 		using FirstPtsSampler::mapidx;
 		
 		const std::size_t seed;
+		const PointMatcherSupport::CounterRandom random;
 	
 		RandomPtsSampler(DataPoints& dp);
 		RandomPtsSampler(DataPoints& dp, const std::size_t seed_);
 		virtual ~RandomPtsSampler(){}
 	
-		template<std::size_t dim>
-		bool operator()(Octree_<T,dim>& oc);
+		template<typename Node>
+		bool operator()(Node& oc);
 		
 		virtual bool finalize();
 	};
@@ -131,8 +134,8 @@ public:
 	
 		virtual ~CentroidSampler(){}
 	
-		template<std::size_t dim>
-		bool operator()(Octree_<T,dim>& oc);
+		template<typename Node>
+		bool operator()(Node& oc);
 	};
 	//Nearest point from the centroid (contained in the cloud)
 	struct MedoidSampler : public FirstPtsSampler
@@ -145,8 +148,8 @@ public:
 	
 		virtual ~MedoidSampler(){}
 	
-		template<std::size_t dim>
-		bool operator()(Octree_<T,dim>& oc);		
+		template<typename Node>
+		bool operator()(Node& oc);		
 	};
 
 //-------	
@@ -159,6 +162,8 @@ public:
 	T           maxSizeByNode;
 	
 	SamplingMethod samplingMethod;
+	
+	const std::size_t seed;
 
 //Methods	
 	//Constructor, uses parameter interface
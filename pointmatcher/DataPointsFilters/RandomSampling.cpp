@@ -33,16 +33,29 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 */
 #include "RandomSampling.h"
+#include "Parallel.h"
+#include "Random.h"
+
+#include <vector>
 
 // RandomSamplingDataPointsFilter
 // Constructor
 template<typename T>
 RandomSamplingDataPointsFilter<T>::RandomSamplingDataPointsFilter(const Parameters& params):
 	PointMatcher<T>::DataPointsFilter("RandomSamplingDataPointsFilter", RandomSamplingDataPointsFilter::availableParameters(), params),
-	prob(Parametrizable::get<double>("prob"))
+	prob(Parametrizable::get<double>("prob")),
+	seed(Parametrizable::get<std::size_t>("seed")),
+	nbThreads(Parametrizable::get<unsigned>("nbThreads")),
+	callCount(0)
 {
 }
 
+template<typename T>
+void RandomSamplingDataPointsFilter<T>::init()
+{
+	callCount = 0;
+}
+
 // Compute
 template<typename T>
 typename PointMatcher<T>::DataPoints
@@ -60,11 +73,21 @@ void RandomSamplingDataPointsFilter<T>::inPlaceFilter(
 {
 	const int nbPointsIn = cloud.features.cols();
 
+	// the number drawn for a point only depends on its index and on the call,
+	// so that the kept points do not depend on the number of threads, but
+	// change from a call to the next one
+	const PointMatcherSupport::CounterRandom random(seed, callCount++);
+	std::vector<char> keep(nbPointsIn);
+	PointMatcherSupport::parallelForChunks(nbPointsIn, PointMatcherSupport::getChunkCount(nbPointsIn, nbThreads, 65536), [&](const unsigned, const size_t begin, const size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+			keep[i] = random.uniform(i) < prob;
+	});
+
 	int j = 0;
 	for (int i = 0; i < nbPointsIn; ++i)
 	{
-		const float r = (float)std::rand()/(float)RAND_MAX;
-		if (r < prob)
+		if (keep[i])
 		{
 			cloud.setColFrom(j, cloud, i);
 			++j;
@@ -58,14 +58,25 @@ struct RandomSamplingDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	inline static const ParametersDoc availableParameters()
 	{
 		return {
-			{"prob", "probability to keep a point, one over decimation factor ", "0.75", "0", "1", &P::Comp<T>}
+			{"prob", "probability to keep a point, one over decimation factor ", "0.75", "0", "1", &P::Comp<T>},
+			{"seed", "seed of the random generator, each call drawing other points and the sequence of calls restarting at each init", "1", "0", "4294967295", &P::Comp<std::size_t>},
+			{"nbThreads", "number of threads used to draw the kept points, each one processing a contiguous chunk of points. 0: one thread per hardware thread", "1", "0", "2147483647", &P::Comp<unsigned>}
 		};
 	}
 	
 	const double prob;
-	
+	const std::size_t seed;
+	const unsigned nbThreads;
+
+protected:
+	//! number of calls since init, indexing the random stream of each call
+	std::uint64_t callCount;
+
+public:
 	RandomSamplingDataPointsFilter(const Parameters& params = Parameters());
 	virtual ~RandomSamplingDataPointsFilter() {};
+	virtual void init();
 	virtual DataPoints filter(const DataPoints& input);
 	virtual void inPlaceFilter(DataPoints& cloud);
+	virtual bool isStreamable() const { return true; } //!< every point is filtered on its own
 };
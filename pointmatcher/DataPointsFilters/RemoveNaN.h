@@ -52,4 +52,5 @@ struct RemoveNaNDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 																																	PointMatcherSupport::Parametrizable::Parameters()) {}
 	virtual DataPoints filter(const DataPoints& input);
 	virtual void inPlaceFilter(DataPoints& cloud);
+	virtual bool isStreamable() const { return true; } //!< every point is filtered on its own
 };
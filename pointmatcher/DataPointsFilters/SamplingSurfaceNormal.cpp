@@ -40,6 +40,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "Eigen/Eigenvalues"
 
 #include "PointMatcherPrivate.h"
+#include "Random.h"
 
 #include <utility>
 #include <algorithm>
@@ -60,7 +61,8 @@ SamplingSurfaceNormalDataPointsFilter<T>::SamplingSurfaceNormalDataPointsFilter(
 	keepNormals(Parametrizable::get<bool>("keepNormals")),
 	keepDensities(Parametrizable::get<bool>("keepDensities")),
 	keepEigenValues(Parametrizable::get<bool>("keepEigenValues")),
-	keepEigenVectors(Parametrizable::get<bool>("keepEigenVectors"))
+	keepEigenVectors(Parametrizable::get<bool>("keepEigenVectors")),
+	seed(Parametrizable::get<std::size_t>("seed"))
 {
 }
 
@@ -253,9 +255,7 @@ void SamplingSurfaceNormalDataPointsFilter<T>::fuseRange(
 	{
 		if(C.fullPivHouseholderQr().rank()+1 >= featDim-1)
 		{
-			const Eigen::EigenSolver<Matrix> solver(C);
-			eigenVa = solver.eigenvalues().real();
-			eigenVe = solver.eigenvectors().real();
+			computeSortedEigen<T>(C, eigenVa, eigenVe);
 		}
 		else
 		{
@@ -285,13 +285,14 @@ void SamplingSurfaceNormalDataPointsFilter<T>::fuseRange(
 	// Filter points randomly
 	if(samplingMethod == 0)
 	{
+		const PointMatcherSupport::CounterRandom random(seed);
 		for(int i=0; i<colCount; ++i)
 		{
-			const float r = (float)std::rand()/(float)RAND_MAX;
-			if(r < ratio)
+			// Draw keyed by the point index, so the box traversal order does not matter
+			const int k = data.indices[first+i];
+			if(random.uniform(k) < ratio)
 			{
 				// Keep points with their descriptors
-				const int k = data.indices[first+i];
 				// Mark the indices which will be part of the final data
 				data.indicesToKeep.push_back(k);
 
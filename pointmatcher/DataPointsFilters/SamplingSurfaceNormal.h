@@ -68,7 +68,8 @@ struct SamplingSurfaceNormalDataPointsFilter: public PointMatcher<T>::DataPoints
 			{"keepNormals", "whether the normals should be added as descriptors to the resulting cloud", "1"},
 			{"keepDensities", "whether the point densities should be added as descriptors to the resulting cloud", "0"},
 			{"keepEigenValues", "whether the eigen values should be added as descriptors to the resulting cloud", "0"},
-			{"keepEigenVectors", "whether the eigen vectors should be added as descriptors to the resulting cloud", "0"}
+			{"keepEigenVectors", "whether the eigen vectors should be added as descriptors to the resulting cloud", "0"},
+			{"seed", "seed of the random generator used by random subsampling, the same seed keeping the same points at every call", "1", "0", "4294967295", &P::Comp<std::size_t>}
 		};
 	}
 	
@@ -81,6 +82,7 @@ struct SamplingSurfaceNormalDataPointsFilter: public PointMatcher<T>::DataPoints
 	const bool keepDensities;
 	const bool keepEigenValues;
 	const bool keepEigenVectors;
+	const std::size_t seed;
 	
 public:
 	SamplingSurfaceNormalDataPointsFilter(const Parameters& params = Parameters());
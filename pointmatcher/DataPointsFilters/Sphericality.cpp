@@ -128,7 +128,7 @@ void SphericalityDataPointsFilter<T>::inPlaceFilter(
 	for (size_t i = 0; i < pointsCount; ++i)
 	{
 		// extract the three eigenvalues relevant to the current point
-		Vector eig_vals_col = eigValues.col(i);
+		Eigen::Matrix<T, 3, 1> eig_vals_col = eigValues.col(i);
 		// might be already sorted but sort anyway
 		std::sort(eig_vals_col.data(),eig_vals_col.data()+eig_vals_col.size());
 
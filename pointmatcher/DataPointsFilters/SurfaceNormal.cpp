@@ -44,7 +44,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <boost/format.hpp>
 
+#include <numeric>
+
 #include "DataPointsFilters/utils/utils.h"
+#include "Parallel.h"
 
 // SurfaceNormalDataPointsFilter
 // Constructor
@@ -62,7 +65,8 @@ SurfaceNormalDataPointsFilter<T>::SurfaceNormalDataPointsFilter(const Parameters
 	keepMatchedIds(Parametrizable::get<bool>("keepMatchedIds")),
 	keepMeanDist(Parametrizable::get<bool>("keepMeanDist")),
 	sortEigen(Parametrizable::get<bool>("sortEigen")),
-	smoothNormals(Parametrizable::get<bool>("smoothNormals"))
+	smoothNormals(Parametrizable::get<bool>("smoothNormals")),
+	nbThreads(Parametrizable::get<unsigned>("nbThreads"))
 {
 }
 
@@ -110,13 +114,7 @@ void SurfaceNormalDataPointsFilter<T>::inPlaceFilter(
 	//const int dimMatchedIds(knn);
 	const int dimMeanDist(1);
 
-	boost::optional<View> normals;
-	boost::optional<View> densities;
-	boost::optional<View> eigenValues;
-	boost::optional<View> eigenVectors;
-	boost::optional<View> matchedValues;
-	boost::optional<View> matchIds;
-	boost::optional<View> meanDists;
+	DescriptorViews views;
 
 	Labels cloudLabels;
 	if (keepNormals)
@@ -136,17 +134,15 @@ void SurfaceNormalDataPointsFilter<T>::inPlaceFilter(
 	cloud.allocateDescriptors(cloudLabels);
 
 	if (keepNormals)
-		normals = cloud.getDescriptorViewByName("normals");
+		views.normals = cloud.getDescriptorViewByName("normals");
 	if (keepDensities)
-		densities = cloud.getDescriptorViewByName("densities");
+		views.densities = cloud.getDescriptorViewByName("densities");
 	if (keepEigenValues)
-		eigenValues = cloud.getDescriptorViewByName("eigValues");
+		views.eigenValues = cloud.getDescriptorViewByName("eigValues");
 	if (keepEigenVectors)
-		eigenVectors = cloud.getDescriptorViewByName("eigVectors");
-	if (keepMatchedIds)
-		matchIds = cloud.getDescriptorViewByName("matchedIds");
+		views.eigenVectors = cloud.getDescriptorViewByName("eigVectors");
 	if (keepMeanDist)
-		meanDists = cloud.getDescriptorViewByName("meanDists");
+		views.meanDists = cloud.getDescriptorViewByName("meanDists");
 
 	using namespace PointMatcherSupport;
 	// Build kd-tree
@@ -154,20 +150,90 @@ void SurfaceNormalDataPointsFilter<T>::inPlaceFilter(
 	boost::assign::insert(param) ( "knn", toParam(knn) );
 	boost::assign::insert(param) ( "epsilon", toParam(epsilon) );
 	boost::assign::insert(param) ( "maxDist", toParam(maxDist) );
+	boost::assign::insert(param) ( "nbThreads", toParam(nbThreads) );
 
 	KDTreeMatcher matcher(param);
 	matcher.init(cloud);
 
 	Matches matches(typename Matches::Dists(knn, pointsCount), typename Matches::Ids(knn, pointsCount));
 	matches = matcher.findClosests(cloud);
+	if (keepMatchedIds)
+		cloud.getDescriptorViewByName("matchedIds") = matches.ids.template cast<T>();
+
+	// Every chunk of points is processed by its own thread, degenerated points are counted per chunk
+	const size_t minChunkSize(256);
+	const unsigned chunkCount(getChunkCount(pointsCount, nbThreads, minChunkSize));
+	std::vector<int> degenerateCounts(chunkCount, 0);
+	parallelForChunks(pointsCount, chunkCount,
+		[&](const unsigned chunk, const size_t begin, const size_t end)
+		{
+			// use fixed-size matrices for 2D and 3D clouds
+			if (featDim == 4)
+				degenerateCounts[chunk] = computeDescriptors<3>(cloud, matches, views, begin, end);
+			else if (featDim == 3)
+				degenerateCounts[chunk] = computeDescriptors<2>(cloud, matches, views, begin, end);
+			else
+				degenerateCounts[chunk] = computeDescriptors<Eigen::Dynamic>(cloud, matches, views, begin, end);
+		}
+	);
+	const int degenerateCount(std::accumulate(degenerateCounts.begin(), degenerateCounts.end(), 0));
 
-	// Search for surrounding points and compute descriptors
+	if(smoothNormals)
+	{
+		boost::optional<View>& normals(views.normals);
+		for (int i = 0; i < pointsCount; ++i)
+		{
+			const Vector currentNormal = normals->col(i);
+			Vector mean = Vector::Zero(featDim-1);
+			int n=0;
+			for(int j = 0; j < int(knn); ++j)
+			{
+				if (matches.dists(j,i) != Matches::InvalidDist)
+				{
+					const int refIndex(matches.ids(j,i));
+					const Vector normal = normals->col(refIndex);
+					if(currentNormal.dot(normal) > 0.)
+						mean += normal;
+					else // flip normal vector
+						mean -= normal;
+
+					++n;
+				}
+			}
+
+			normals->col(i) = mean / T(n);
+		}
+	}
+
+	if (degenerateCount)
+	{
+		LOG_WARNING_STREAM("WARNING: Matrix C needed for eigen decomposition was degenerated in " << degenerateCount << " points over " << pointsCount << " (" << float(degenerateCount)*100.f/float(pointsCount) << " %)");
+	}
+
+}
+
+template<typename T>
+template<int Dim>
+int SurfaceNormalDataPointsFilter<T>::computeDescriptors(
+	const DataPoints& cloud, const Matches& matches, DescriptorViews& views, const int begin, const int end) const
+{
+	typedef Eigen::Matrix<T, Dim, 1> DimVector;
+	typedef Eigen::Matrix<T, Dim, Dim> DimMatrix;
+	typedef Eigen::Matrix<T, Dim, Eigen::Dynamic> DimNeighbors;
+
+	using namespace PointMatcherSupport;
+
+	const int dim(cloud.features.rows() - 1);
 	int degenerateCount(0);
-	for (int i = 0; i < pointsCount; ++i)
+
+	// Nearest neighbors (NN) of the current point, the buffer is reused for all points
+	DimNeighbors NN(dim, knn);
+	DimVector eigenVa(DimVector::Zero(dim));
+	DimMatrix eigenVe(DimMatrix::Zero(dim, dim));
+
+	for (int i = begin; i < end; ++i)
 	{
 		bool isDegenerate = false;
-		// Mean of nearest neighbors (NN)
-		Matrix d(featDim-1, knn);
 		int realKnn = 0;
 
 		for(int j = 0; j < int(knn); ++j)
@@ -175,39 +241,24 @@ void SurfaceNormalDataPointsFilter<T>::inPlaceFilter(
 			if (matches.dists(j,i) != Matches::InvalidDist)
 			{
 				const int refIndex(matches.ids(j,i));
-				d.col(realKnn) = cloud.features.block(0, refIndex, featDim-1, 1);
+				NN.col(realKnn) = cloud.features.col(refIndex).head(dim);
 				++realKnn;
 			}
 		}
-		d.conservativeResize(Eigen::NoChange, realKnn);
 
-		const Vector mean = d.rowwise().sum() / T(realKnn);
-		const Matrix NN = d.colwise() - mean;
+		// Mean of nearest neighbors, which are then centered in place
+		const DimVector mean = NN.leftCols(realKnn).rowwise().sum() / T(realKnn);
+		NN.leftCols(realKnn).colwise() -= mean;
 
-		const Matrix C(NN * NN.transpose());
-		Vector eigenVa = Vector::Zero(featDim-1, 1);
-		Matrix eigenVe = Matrix::Zero(featDim-1, featDim-1);
+		const DimMatrix C(NN.leftCols(realKnn).lazyProduct(NN.leftCols(realKnn).transpose()));
+		eigenVa.setZero();
+		eigenVe.setZero();
 		// Ensure that the matrix is suited for eigenvalues calculation
 		if(keepNormals || keepEigenValues || keepEigenVectors)
 		{
-			if(C.fullPivHouseholderQr().rank()+1 >= featDim-1)
+			if(C.fullPivHouseholderQr().rank()+1 >= dim)
 			{
-				const Eigen::EigenSolver<Matrix> solver(C);
-				eigenVa = solver.eigenvalues().real();
-				eigenVe = solver.eigenvectors().real();
-
-				if(sortEigen)
-				{
-					const std::vector<size_t> idx = sortIndexes<T>(eigenVa);
-					const size_t idxSize = idx.size();
-					Vector tmp_eigenVa = eigenVa;
-					Matrix tmp_eigenVe = eigenVe;
-					for(size_t i=0; i<idxSize; ++i)
-					{
-						eigenVa(i,0) = tmp_eigenVa(idx[i], 0);
-						eigenVe.col(i) = tmp_eigenVe.col(idx[i]);
-					}
-				}
+				computeSortedEigenDirect<T, Dim>(C, eigenVa, eigenVe);
 			}
 			else
 			{
@@ -219,74 +270,35 @@ void SurfaceNormalDataPointsFilter<T>::inPlaceFilter(
 
 		if(keepNormals)
 		{
-			if(sortEigen)
-				normals->col(i) = eigenVe.col(0);
-			else
-				normals->col(i) = computeNormal<T>(eigenVa, eigenVe);
-			
+			// eigenvalues are sorted, the smallest eigenvector is the surface normal
 			// clamp normals to [-1,1] to handle approximation errors
-			normals->col(i) = normals->col(i).cwiseMax(-1.0).cwiseMin(1.0);
+			views.normals->col(i) = eigenVe.col(0).cwiseMax(-1.0).cwiseMin(1.0);
 		}
 		if(keepDensities)
 		{
 			if(isDegenerate)
-				(*densities)(0, i) = 0.;
+				(*views.densities)(0, i) = 0.;
 			else
-				(*densities)(0, i) = computeDensity<T>(NN);
+				(*views.densities)(0, i) = computeDensity<T>(NN.leftCols(realKnn));
 		}
 		if(keepEigenValues)
-			eigenValues->col(i) = eigenVa;
+			views.eigenValues->col(i).template head<Dim>(dim) = eigenVa;
 		if(keepEigenVectors)
-			eigenVectors->col(i) = serializeEigVec<T>(eigenVe);
+		{
+			// serialize row major
+			for(int k = 0; k < dim; ++k)
+				views.eigenVectors->col(i).segment(k*dim, dim) = eigenVe.row(k).transpose();
+		}
 		if(keepMeanDist)
 		{
 			if(isDegenerate)
-				(*meanDists)(0, i) = std::numeric_limits<std::size_t>::max();
+				(*views.meanDists)(0, i) = std::numeric_limits<std::size_t>::max();
 			else
-			{
-				const Vector point = cloud.features.block(0, i, featDim-1, 1);
-				(*meanDists)(0, i) = (point - mean).norm();
-			}
-		}
-
-	}
-
-	if(keepMatchedIds)
-	{
-		matchIds.get() = matches.ids.template cast<T>();
-	}
-
-	if(smoothNormals)
-	{
-		for (int i = 0; i < pointsCount; ++i)
-		{
-			const Vector currentNormal = normals->col(i);
-			Vector mean = Vector::Zero(featDim-1);
-			int n=0;
-			for(int j = 0; j < int(knn); ++j)
-			{
-				if (matches.dists(j,i) != Matches::InvalidDist)
-				{
-					const int refIndex(matches.ids(j,i));
-					const Vector normal = normals->col(refIndex);
-					if(currentNormal.dot(normal) > 0.)
-						mean += normal;
-					else // flip normal vector
-						mean -= normal;
-
-					++n;
-				}
-			}
-
-			normals->col(i) = mean / T(n);
+				(*views.meanDists)(0, i) = (cloud.features.col(i).head(dim) - mean).norm();
 		}
 	}
 
-	if (degenerateCount)
-	{
-		LOG_WARNING_STREAM("WARNING: Matrix C needed for eigen decomposition was degenerated in " << degenerateCount << " points over " << pointsCount << " (" << float(degenerateCount)*100.f/float(pointsCount) << " %)");
-	}
-
+	return degenerateCount;
 }
 
 template struct SurfaceNormalDataPointsFilter<float>;
@@ -53,6 +53,7 @@ struct SurfaceNormalDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	typedef typename PointMatcher<T>::Matrix Matrix;	
 	typedef typename PointMatcher<T>::DataPoints DataPoints;
 	typedef typename PointMatcher<T>::DataPoints::InvalidField InvalidField;
+	typedef typename PointMatcher<T>::Matches Matches;
 
 	inline static const std::string description()
 	{
@@ -74,8 +75,9 @@ struct SurfaceNormalDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 			{"keepEigenVectors", "whether the eigen vectors should be added as descriptors to the resulting cloud", "0"},
 			{"keepMatchedIds" , "whether the identifiers of matches points should be added as descriptors to the resulting cloud", "0"},
 			{"keepMeanDist" , "whether the distance to the nearest neighbor mean should be added as descriptors to the resulting cloud", "0"},
-			{"sortEigen" , "whether the eigenvalues and eigenvectors should be sorted (ascending) based on the eigenvalues", "0"},
-			{"smoothNormals", "whether the normal vector should be average with the nearest neighbors", "0"}
+			{"sortEigen" , "kept for backward compatibility, the eigenvalues and eigenvectors are always sorted (ascending) based on the eigenvalues", "0"},
+			{"smoothNormals", "whether the normal vector should be average with the nearest neighbors", "0"},
+			{"nbThreads", "number of threads used to search the neighbors and to compute the descriptors, each one processing a contiguous chunk of points. 0: one thread per hardware thread", "1", "0", "2147483647", &P::Comp<unsigned>}
 		};
 	}
 	
@@ -90,9 +92,31 @@ struct SurfaceNormalDataPointsFilter: public PointMatcher<T>::DataPointsFilter
 	const bool keepMeanDist;
 	const bool sortEigen;
 	const bool smoothNormals;
+	const unsigned nbThreads;
 
 	SurfaceNormalDataPointsFilter(const Parameters& params = Parameters());
 	virtual ~SurfaceNormalDataPointsFilter() {};
 	virtual DataPoints filter(const DataPoints& input);
 	virtual void inPlaceFilter(DataPoints& cloud);
+
+protected:
+	//! Views on the descriptors produced by the filter, only the kept ones are set
+	struct DescriptorViews
+	{
+		typedef typename DataPoints::View View;
+
+		boost::optional<View> normals;
+		boost::optional<View> densities;
+		boost::optional<View> eigenValues;
+		boost::optional<View> eigenVectors;
+		boost::optional<View> meanDists;
+	};
+
+	//! Compute the descriptors of the points in [begin, end) and return how many of them were degenerated
+	/**
+		Dim is the Euclidean dimension of the cloud, or Eigen::Dynamic.
+		With a fixed Dim, the covariance and its eigen-decomposition use fixed-size matrices on the stack.
+	*/
+	template<int Dim>
+	int computeDescriptors(const DataPoints& cloud, const Matches& matches, DescriptorViews& views, const int begin, const int end) const;
 };
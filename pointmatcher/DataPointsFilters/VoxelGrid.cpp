@@ -33,6 +33,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 */
 #include "VoxelGrid.h"
+#include "Parallel.h"
+
+#include <cstdint>
+#include <limits>
 
 
 // VoxelGridDataPointsFilter
@@ -42,7 +46,9 @@ VoxelGridDataPointsFilter<T>::VoxelGridDataPointsFilter() :
 	vSizeY(1),
 	vSizeZ(1),
 	useCentroid(true),
-	averageExistingDescriptors(true) 
+	averageExistingDescriptors(true),
+	sparse(false),
+	nbThreads(1)
 {
 }
 
@@ -54,7 +60,9 @@ VoxelGridDataPointsFilter<T>::VoxelGridDataPointsFilter(const Parameters& params
 	vSizeY(Parametrizable::get<T>("vSizeY")),
 	vSizeZ(Parametrizable::get<T>("vSizeZ")),
 	useCentroid(Parametrizable::get<bool>("useCentroid")),
-	averageExistingDescriptors(Parametrizable::get<bool>("averageExistingDescriptors"))
+	averageExistingDescriptors(Parametrizable::get<bool>("averageExistingDescriptors")),
+	sparse(Parametrizable::get<bool>("sparse")),
+	nbThreads(Parametrizable::get<unsigned>("nbThreads"))
 {
 }
 
@@ -124,7 +132,7 @@ void VoxelGridDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
 	if (featDim == 4)
 		numVox *= numDivZ;
 	
-	if(numVox == 0)
+	if(numDivX == 0 || numDivY == 0 || (featDim == 4 && numDivZ == 0))
 	{
 		throw InvalidParameter("VoxelGridDataPointsFilter: The number of voxel couldn't be computed. There might be NaNs in the feature matrix. Use the fileter RemoveNaNDataPointsFilter before this one if it's the case.");
 	}
@@ -142,205 +150,342 @@ void VoxelGridDataPointsFilter<T>::inPlaceFilter(DataPoints& cloud)
 
 	std::vector<Voxel> voxels;
 
-	// try allocating vector. If too big return error
-	try 
-	{
-		voxels = std::vector<Voxel>(numVox);
-	} 
-	catch (std::bad_alloc&) 
-	{
-		throw InvalidParameter((boost::format("VoxelGridDataPointsFilter: Memory allocation error with %1% voxels.  Try increasing the voxel dimensions.") % numVox).str());
-	}
+	// in sparse mode, voxels only holds the occupied voxels, in order of
+	// their first point, and this holds their linear index in the grid
+	std::vector<std::uint64_t> voxelIndices;
 
-	for (unsigned int p = 0; p < numPoints; ++p)
-	{	
-		const unsigned int i = floor(cloud.features(0,p)/vSizeX - minBoundX);
-		const unsigned int j = floor(cloud.features(1,p)/vSizeY- minBoundY);
-		unsigned int k = 0;
-		unsigned int idx = 0;
-		if ( featDim == 4 )
+	if (sparse)
+	{
+		// open-addressing hash table from the linear index of a voxel
+		// to its position in voxels, with linear probing
+		const unsigned int emptySlot(std::numeric_limits<unsigned int>::max());
+		int tableBits(4);
+		while ((size_t(1) << tableBits) < 2 * size_t(numPoints))
+			++tableBits;
+		const size_t tableMask((size_t(1) << tableBits) - 1);
+		std::vector<unsigned int> table(tableMask + 1, emptySlot);
+
+		for (unsigned int p = 0; p < numPoints; ++p)
 		{
-			k = floor(cloud.features(2,p)/vSizeZ - minBoundZ);
-			idx = i + j * numDivX + k * numDivX * numDivY;
+			const std::uint64_t i = floor(cloud.features(0,p)/vSizeX - minBoundX);
+			const std::uint64_t j = floor(cloud.features(1,p)/vSizeY- minBoundY);
+			std::uint64_t idx = i + j * numDivX;
+			if ( featDim == 4 )
+			{
+				const std::uint64_t k = floor(cloud.features(2,p)/vSizeZ - minBoundZ);
+				idx += k * std::uint64_t(numDivX) * numDivY;
+			}
+
+			// Fibonacci hashing, keeping the high bits of the product
+			size_t slot = (idx * 0x9E3779B97F4A7C15ull) >> (64 - tableBits);
+			while (table[slot] != emptySlot && voxelIndices[table[slot]] != idx)
+				slot = (slot + 1) & tableMask;
+
+			if (table[slot] == emptySlot)
+			{
+				table[slot] = voxels.size();
+				voxels.push_back(Voxel());
+				voxels.back().firstPoint = p;
+				voxelIndices.push_back(idx);
+			}
+
+			++voxels[table[slot]].numPoints;
+			indices[p] = table[slot];
 		}
-		else
+	}
+	else
+	{
+		// try allocating vector. If too big return error
+		try 
+		{
+			voxels = std::vector<Voxel>(numVox);
+		} 
+		catch (std::bad_alloc&) 
 		{
-			idx = i + j * numDivX;
+			throw InvalidParameter((boost::format("VoxelGridDataPointsFilter: Memory allocation error with %1% voxels.  Try increasing the voxel dimensions or setting sparse to 1.") % numVox).str());
 		}
 
-		const unsigned int pointsInVox = voxels[idx].numPoints + 1;
+		for (unsigned int p = 0; p < numPoints; ++p)
+		{	
+			const unsigned int i = floor(cloud.features(0,p)/vSizeX - minBoundX);
+			const unsigned int j = floor(cloud.features(1,p)/vSizeY- minBoundY);
+			unsigned int k = 0;
+			unsigned int idx = 0;
+			if ( featDim == 4 )
+			{
+				k = floor(cloud.features(2,p)/vSizeZ - minBoundZ);
+				idx = i + j * numDivX + k * numDivX * numDivY;
+			}
+			else
+			{
+				idx = i + j * numDivX;
+			}
 
-		if (pointsInVox == 1)
-		{
-			voxels[idx].firstPoint = p;
-		}
+			const unsigned int pointsInVox = voxels[idx].numPoints + 1;
 
-		voxels[idx].numPoints = pointsInVox;
+			if (pointsInVox == 1)
+			{
+				voxels[idx].firstPoint = p;
+			}
 
-		indices[p] = idx;
+			voxels[idx].numPoints = pointsInVox;
 
-	}
+			indices[p] = idx;
 
+		}
+	}
 
-	// store which points contain voxel position
-	std::vector<unsigned int> pointsToKeep;
 
-	// Store voxel centroid in output
-	if (useCentroid)
+	// Number the occupied voxels in the order of their first point, which is
+	// the order in which they are output, and make indices refer to them
+	std::vector<unsigned int> keptVoxels;
+	if (sparse)
+	{
+		// voxels are already created in the order of their first point
+		keptVoxels.resize(voxels.size());
+		for (unsigned int v = 0; v < voxels.size(); ++v)
+			keptVoxels[v] = v;
+	}
+	else
 	{
-		// Iterate through the indices and sum values to compute centroid
-		for (unsigned int p = 0; p < numPoints ; ++p)
+		std::vector<unsigned int> keptIndices(voxels.size());
+		for (unsigned int p = 0; p < numPoints; ++p)
 		{
 			const unsigned int idx = indices[p];
-			const unsigned int firstPoint = voxels[idx].firstPoint;
-
-			// If this is the first point in the voxel, leave as is
-			// if not sum up this point for centroid calculation
-			if (firstPoint != p)
+			if (voxels[idx].firstPoint == p)
 			{
-				// Sum up features and descriptors (if we are also averaging descriptors)
-
-				for (int f = 0; f < (featDim - 1); ++f)
-				{
-					cloud.features(f,firstPoint) += cloud.features(f,p);
-				}
-
-				if (averageExistingDescriptors) 
-				{
-					for (int d = 0; d < descDim; ++d)
-					{
-						cloud.descriptors(d,firstPoint) += cloud.descriptors(d,p);
-					}
-					for (int d = 0; d < timeDim; ++d)
-					{
-						cloud.times(d,firstPoint) += cloud.times(d,p);
-					}
-				}
+				keptIndices[idx] = keptVoxels.size();
+				keptVoxels.push_back(idx);
 			}
+			indices[p] = keptIndices[idx];
 		}
-
-		// Now iterating through the voxels
-		// Normalize sums to get centroid (average)
-		// Some voxels may be empty and are discarded
-		for(unsigned int idx = 0; idx < numVox; ++idx)
-		{
-			const unsigned int numPoints = voxels[idx].numPoints;
-			const unsigned int firstPoint = voxels[idx].firstPoint;
-			if(numPoints > 0)
+	}
+	const unsigned int numPtsOut = keptVoxels.size();
+
+	// Sum the features (for centroids) and the descriptors and times (if averaging)
+	// of every voxel. Every chunk of points is processed by its own thread, which
+	// accumulates in its own partial sums, these being merged in chunk order.
+	const int sumFeatDim = useCentroid ? featDim - 1 : 0;
+	const int sumDescDim = averageExistingDescriptors ? descDim : 0;
+	const int sumTimeDim = averageExistingDescriptors ? timeDim : 0;
+	const bool hasSums = sumFeatDim + sumDescDim + sumTimeDim > 0;
+
+	using namespace PointMatcherSupport;
+	const size_t minChunkSize(4096);
+	const unsigned chunkCount(hasSums ? getChunkCount(numPoints, nbThreads, minChunkSize) : 1);
+	std::vector<Matrix> featureSums(chunkCount);
+	std::vector<Matrix> descriptorSums(chunkCount);
+	std::vector<Int64Matrix> timeSums(chunkCount);
+	if (hasSums)
+	{
+		parallelForChunks(numPoints, chunkCount,
+			[&](const unsigned chunk, const size_t begin, const size_t end)
 			{
-				for (int f = 0; f < (featDim - 1); ++f)
-					cloud.features(f,firstPoint) /= numPoints;
-
-				if (averageExistingDescriptors) 
+				Matrix& features(featureSums[chunk]);
+				Matrix& descriptors(descriptorSums[chunk]);
+				Int64Matrix& times(timeSums[chunk]);
+				features = Matrix::Zero(sumFeatDim, numPtsOut);
+				descriptors = Matrix::Zero(sumDescDim, numPtsOut);
+				times = Int64Matrix::Zero(sumTimeDim, numPtsOut);
+				for (size_t p = begin; p < end; ++p)
 				{
-					for ( int d = 0; d < descDim; ++d )
-						cloud.descriptors(d,firstPoint) /= numPoints;
-					for ( int d = 0; d < timeDim; ++d )
-						cloud.times(d,firstPoint) /= numPoints;
+					const unsigned int v = indices[p];
+					if (sumFeatDim > 0)
+						features.col(v) += cloud.features.col(p).head(sumFeatDim);
+					if (sumDescDim > 0)
+						descriptors.col(v) += cloud.descriptors.col(p);
+					if (sumTimeDim > 0)
+						times.col(v) += cloud.times.col(p);
 				}
-				pointsToKeep.push_back(firstPoint);
 			}
-		}
+		);
 	}
-	else
+	if (chunkCount > 1)
 	{
-		// Although we don't sum over the features, we may still need to sum the descriptors
-		if (averageExistingDescriptors)
-		{
-			// Iterate through the indices and sum values to compute centroid
-			for (unsigned int p = 0; p < numPoints ; ++p)
+		parallelForChunks(numPtsOut, getChunkCount(numPtsOut, nbThreads, minChunkSize),
+			[&](const unsigned, const size_t begin, const size_t end)
 			{
-				const unsigned int idx = indices[p];
-				const unsigned int firstPoint = voxels[idx].firstPoint;
-
-				// If this is the first point in the voxel, leave as is
-				// if not sum up this point for centroid calculation
-				if (firstPoint != p)
+				const size_t count(end - begin);
+				for (unsigned chunk = 1; chunk < chunkCount; ++chunk)
 				{
-					for (int d = 0; d < descDim; ++d)
-					{
-						cloud.descriptors(d,firstPoint) += cloud.descriptors(d,p);
-					}
-					for (int d = 0; d < timeDim; ++d)
-					{
-						cloud.times(d,firstPoint) += cloud.times(d,p);
-					}
+					featureSums[0].middleCols(begin, count) += featureSums[chunk].middleCols(begin, count);
+					descriptorSums[0].middleCols(begin, count) += descriptorSums[chunk].middleCols(begin, count);
+					timeSums[0].middleCols(begin, count) += timeSums[chunk].middleCols(begin, count);
 				}
 			}
-		}
+		);
+	}
 
-		for (unsigned int idx = 0; idx < numVox; ++idx)
-		{
-			const unsigned int numPoints = voxels[idx].numPoints;
-			const unsigned int firstPoint = voxels[idx].firstPoint;
+	// Bring the data we keep to the front of the arrays, in a single pass
+	// as the first point of the v-th kept voxel is never before v, then
+	// wipe the leftover unused space.
+	for (unsigned int v = 0; v < numPtsOut; ++v)
+	{
+		const unsigned int numPoints = voxels[keptVoxels[v]].numPoints;
+		const unsigned int firstPoint = voxels[keptVoxels[v]].firstPoint;
+		assert(v <= firstPoint);
 
-			if (numPoints > 0)
-			{
-				// get back voxel indices in grid format
-				// If we are in the last division, the voxel is smaller in size
-				// We adjust the center as from the end of the last voxel to the bounding area
-				unsigned int i = 0;
-				unsigned int j = 0;
-				unsigned int k = 0;
-				if (featDim == 4)
-				{
-					k = idx / (numDivX * numDivY);
-					if (k == numDivZ)
-						cloud.features(3,firstPoint) = maxValues.z() - (k-1) * vSizeZ/2;
-					else
-						cloud.features(3,firstPoint) = k * vSizeZ + vSizeZ/2;
-				}
+		cloud.features.col(v) = cloud.features.col(firstPoint);
+		if (cloud.descriptors.rows() != 0)
+			cloud.descriptors.col(v) = cloud.descriptors.col(firstPoint);
+		if (cloud.times.rows() != 0)
+			cloud.times.col(v) = cloud.times.col(firstPoint);
 
-				j = (idx - k * numDivX * numDivY) / numDivX;
-				if (j == numDivY)
-					cloud.features(2,firstPoint) = maxValues.y() - (j-1) * vSizeY/2;
+		// Features: normalize the sums to get the centroid (average), or use the
+		// center of the voxel
+		if (useCentroid)
+		{
+			for (int f = 0; f < (featDim - 1); ++f)
+				cloud.features(f,v) = featureSums[0](f,v) / numPoints;
+		}
+		else
+		{
+			// get back voxel indices in grid format
+			// If we are in the last division, the voxel is smaller in size
+			// We adjust the center as from the end of the last voxel to the bounding area
+			const std::uint64_t idx = sparse ? voxelIndices[keptVoxels[v]] : keptVoxels[v];
+			std::uint64_t i = 0;
+			std::uint64_t j = 0;
+			std::uint64_t k = 0;
+			if (featDim == 4)
+			{
+				k = idx / (std::uint64_t(numDivX) * numDivY);
+				if (k == numDivZ)
+					cloud.features(3,v) = maxValues.z() - (k-1) * vSizeZ/2;
 				else
-					cloud.features(2,firstPoint) = j * vSizeY + vSizeY / 2;
+					cloud.features(3,v) = k * vSizeZ + vSizeZ/2;
+			}
 
-				i = idx - k * numDivX * numDivY - j * numDivX;
-				if (i == numDivX)
-					cloud.features(1,firstPoint) = maxValues.x() - (i-1) * vSizeX/2;
-				else
-					cloud.features(1,firstPoint) = i * vSizeX + vSizeX / 2;
+			j = (idx - k * numDivX * numDivY) / numDivX;
+			if (j == numDivY)
+				cloud.features(2,v) = maxValues.y() - (j-1) * vSizeY/2;
+			else
+				cloud.features(2,v) = j * vSizeY + vSizeY / 2;
+
+			i = idx - k * numDivX * numDivY - j * numDivX;
+			if (i == numDivX)
+				cloud.features(1,v) = maxValues.x() - (i-1) * vSizeX/2;
+			else
+				cloud.features(1,v) = i * vSizeX + vSizeX / 2;
+		}
 
-				// Descriptors : normalize if we are averaging or keep as is
-				if (averageExistingDescriptors) 
-				{
-					for ( int d = 0; d < descDim; ++d)
-						cloud.descriptors(d,firstPoint) /= numPoints;
-					for ( int d = 0; d < timeDim; ++d)
-						cloud.times(d,firstPoint) /= numPoints;
-				}
-				pointsToKeep.push_back(firstPoint);
-			}
+		// Descriptors : normalize if we are averaging or keep as is
+		if (averageExistingDescriptors)
+		{
+			for (int d = 0; d < descDim; ++d)
+				cloud.descriptors(d,v) = descriptorSums[0](d,v) / numPoints;
+			for (int d = 0; d < timeDim; ++d)
+				cloud.times(d,v) = timeSums[0](d,v) / numPoints;
 		}
 	}
 
-	// Move the points to be kept to the start
-	// Bring the data we keep to the front of the arrays then
-	// wipe the leftover unused space.
-	std::sort(pointsToKeep.begin(), pointsToKeep.end());
-	int numPtsOut = pointsToKeep.size();
-	for (int i = 0; i < numPtsOut; ++i)
+	cloud.conservativeResize(numPtsOut);
+}
+
+//! Add the points of chunk to the voxels of the stream, and empty it
+/*!
+	As the bounding box of a streamed cloud is unknown until its end, voxels
+	start at multiples of the voxel size instead of at the minimum of the cloud.
+	Memory grows with the number of occupied voxels only.
+*/
+template <typename T>
+void VoxelGridDataPointsFilter<T>::inPlaceFilterChunk(DataPoints& chunk)
+{
+	const unsigned int numPoints(chunk.features.cols());
+	const int featDim(chunk.features.rows());
+	assert (featDim == 3 || featDim == 4);
+
+	StreamedVoxels& s(streamed);
+	if (s.keys.empty())
 	{
-		const int k = pointsToKeep[i];
-		assert(i <= k);
-		cloud.features.col(i) = cloud.features.col(k);
-		if (cloud.descriptors.rows() != 0)
-			cloud.descriptors.col(i) = cloud.descriptors.col(k);
-		if (cloud.times.rows() != 0)
-			cloud.times.col(i) = cloud.times.col(k);
+		if (averageExistingDescriptors && chunk.descriptorLabels.totalDim() != size_t(chunk.descriptors.rows()))
+			throw InvalidField("VoxelGridDataPointsFilter: Error, descriptor labels do not match descriptor data");
+		// start with some spare columns, as resizing an empty DataPoints does not resize its descriptors
+		const unsigned int capacity(1024);
+		s.firstPoints = DataPoints(chunk.featureLabels, chunk.descriptorLabels, chunk.timeLabels, capacity);
+		s.featureSums.resize(useCentroid ? featDim - 1 : 0, capacity);
+		s.descriptorSums.resize(averageExistingDescriptors ? chunk.descriptors.rows() : 0, capacity);
+		s.timeSums.resize(averageExistingDescriptors ? chunk.times.rows() : 0, capacity);
+	}
+	else if (!(chunk.featureLabels == s.firstPoints.featureLabels) ||
+		!(chunk.descriptorLabels == s.firstPoints.descriptorLabels) ||
+		!(chunk.timeLabels == s.firstPoints.timeLabels))
+		throw InvalidField("VoxelGridDataPointsFilter: Error, all chunks of a stream must have the same labels");
+
+	for (unsigned int p = 0; p < numPoints; ++p)
+	{
+		VoxelKey key;
+		key[0] = std::floor(chunk.features(0,p) / vSizeX);
+		key[1] = std::floor(chunk.features(1,p) / vSizeY);
+		key[2] = featDim == 4 ? std::floor(chunk.features(2,p) / vSizeZ) : 0;
+
+		const auto inserted(s.voxelIds.insert(std::make_pair(key, unsigned(s.keys.size()))));
+		const unsigned int v(inserted.first->second);
+		if (inserted.second)
+		{
+			// grow by doubling, keeping spare columns at the end
+			if (v == s.firstPoints.features.cols())
+			{
+				const unsigned int capacity(2 * v);
+				s.firstPoints.conservativeResize(capacity);
+				s.featureSums.conservativeResize(Eigen::NoChange, capacity);
+				s.descriptorSums.conservativeResize(Eigen::NoChange, capacity);
+				s.timeSums.conservativeResize(Eigen::NoChange, capacity);
+			}
+			s.keys.push_back(key);
+			s.numPoints.push_back(0);
+			s.firstPoints.setColFrom(v, chunk, p);
+			s.featureSums.col(v).setZero();
+			s.descriptorSums.col(v).setZero();
+			s.timeSums.col(v).setZero();
+		}
 
+		++s.numPoints[v];
+		if (s.featureSums.rows() > 0)
+			s.featureSums.col(v) += chunk.features.col(p).head(featDim - 1);
+		if (s.descriptorSums.rows() > 0)
+			s.descriptorSums.col(v) += chunk.descriptors.col(p);
+		if (s.timeSums.rows() > 0)
+			s.timeSums.col(v) += chunk.times.col(p);
 	}
-	
+
+	chunk.conservativeResize(0);
+}
+
+//! Output one point per voxel of the stream, ordered by their first point, and reset the stream
+template <typename T>
+bool VoxelGridDataPointsFilter<T>::finishStream(DataPoints& cloud)
+{
+	StreamedVoxels& s(streamed);
+	const unsigned int numPtsOut(s.keys.size());
+	if (numPtsOut == 0)
+		return false;
+
+	PM::swapDataPoints(cloud, s.firstPoints);
 	cloud.conservativeResize(numPtsOut);
-	
-	//cloud.features.conservativeResize(Eigen::NoChange, numPtsOut);
-	//
-	//if (cloud.descriptors.rows() != 0)
-	//	cloud.descriptors.conservativeResize(Eigen::NoChange, numPtsOut);
-	//if (cloud.times.rows() != 0)
-	//	cloud.times.conservativeResize(Eigen::NoChange, numPtsOut)
+	const int featDim(cloud.features.rows());
+	const Vector3 voxelSize(vSizeX, vSizeY, vSizeZ);
+	for (unsigned int v = 0; v < numPtsOut; ++v)
+	{
+		const unsigned int numPoints(s.numPoints[v]);
+		for (int f = 0; f < featDim - 1; ++f)
+		{
+			if (useCentroid)
+				cloud.features(f,v) = s.featureSums(f,v) / numPoints;
+			else
+				cloud.features(f,v) = (s.keys[v][f] + T(0.5)) * voxelSize(f);
+		}
+		if (averageExistingDescriptors)
+		{
+			for (int d = 0; d < s.descriptorSums.rows(); ++d)
+				cloud.descriptors(d,v) = s.descriptorSums(d,v) / numPoints;
+			for (int d = 0; d < s.timeSums.rows(); ++d)
+				cloud.times(d,v) = s.timeSums(d,v) / numPoints;
+		}
+	}
+
+	streamed = StreamedVoxels();
+	return true;
 }
 
 template struct VoxelGridDataPointsFilter<float>;
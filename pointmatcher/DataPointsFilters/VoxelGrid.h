@@ -36,6 +36,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "PointMatcher.h"
 
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+
 template<typename T>
 struct VoxelGridDataPointsFilter : public PointMatcher<T>::DataPointsFilter
 {
@@ -53,6 +57,7 @@ struct VoxelGridDataPointsFilter : public PointMatcher<T>::DataPointsFilter
 
 	typedef typename PointMatcher<T>::Matrix Matrix;
 	typedef typename PointMatcher<T>::Vector Vector;
+	typedef typename PointMatcher<T>::Int64Matrix Int64Matrix;
 	typedef typename Eigen::Matrix<T,2,1> Vector2;
 	typedef typename Eigen::Matrix<T,3,1> Vector3;
 	typedef typename PointMatcher<T>::DataPoints::InvalidField InvalidField;
@@ -70,7 +75,9 @@ struct VoxelGridDataPointsFilter : public PointMatcher<T>::DataPointsFilter
 			{"vSizeY", "Dimension of each voxel cell in y direction", "1.0", "0.001", "+inf", &P::Comp<T>},
 			{"vSizeZ", "Dimension of each voxel cell in z direction", "1.0", "0.001", "+inf", &P::Comp<T>},
 			{"useCentroid", "If 1 (true), down-sample by using centroid of voxel cell.  If false (0), use center of voxel cell.", "1", "0", "1", P::Comp<bool>},
-			{"averageExistingDescriptors", "whether the filter keep the existing point descriptors and average them or should it drop them", "1", "0", "1", P::Comp<bool>}
+			{"averageExistingDescriptors", "whether the filter keep the existing point descriptors and average them or should it drop them", "1", "0", "1", P::Comp<bool>},
+			{"sparse", "If 1 (true), only store the occupied voxels in a hash table, so that memory scales with the number of points instead of the volume of the bounding box.  If 0 (false), allocate every voxel of the bounding box.", "0", "0", "1", P::Comp<bool>},
+			{"nbThreads", "number of threads used to sum the points of every voxel, each one processing a contiguous chunk of points. 0: one thread per hardware thread", "1", "0", "2147483647", &P::Comp<unsigned>}
 		};
 	}
 
@@ -79,6 +86,8 @@ struct VoxelGridDataPointsFilter : public PointMatcher<T>::DataPointsFilter
 	const T vSizeZ;
 	const bool useCentroid;
 	const bool averageExistingDescriptors;
+	const bool sparse;
+	const unsigned nbThreads;
 
 	struct Voxel {
 		unsigned int    numPoints;
@@ -95,4 +104,35 @@ struct VoxelGridDataPointsFilter : public PointMatcher<T>::DataPointsFilter
 
 	virtual DataPoints filter(const DataPoints& input);
 	virtual void inPlaceFilter(DataPoints& cloud);
+
+	virtual bool isStreamable() const { return true; } //!< voxels are accumulated over the chunks
+	virtual void inPlaceFilterChunk(DataPoints& chunk);
+	virtual bool finishStream(DataPoints& cloud);
+
+private:
+	//! Integer coordinates of a voxel on a grid aligned with the origin
+	typedef std::array<std::int64_t, 3> VoxelKey;
+
+	//! Spatial hash of a voxel
+	struct VoxelKeyHash
+	{
+		size_t operator()(const VoxelKey& key) const
+		{
+			// unsigned products wrap around instead of overflowing
+			return size_t((std::uint64_t(key[0]) * 73856093u) ^ (std::uint64_t(key[1]) * 19349663u) ^ (std::uint64_t(key[2]) * 83492791u));
+		}
+	};
+
+	//! Voxels accumulated over the chunks of a stream
+	struct StreamedVoxels
+	{
+		std::unordered_map<VoxelKey, unsigned, VoxelKeyHash> voxelIds; //!< position of every voxel in the following
+		std::vector<VoxelKey> keys; //!< coordinates of every voxel
+		std::vector<unsigned> numPoints; //!< number of points in every voxel
+		DataPoints firstPoints; //!< first point of every voxel, with spare columns at the end
+		Matrix featureSums; //!< sums of the features of the points of every voxel, if using centroids
+		Matrix descriptorSums; //!< sums of the descriptors of the points of every voxel, if averaging them
+		Int64Matrix timeSums; //!< sums of the times of the points of every voxel, if averaging them
+	};
+	StreamedVoxels streamed;
 };
@@ -0,0 +1,170 @@
+// kate: replace-tabs off; indent-width 4; indent-mode normal
+// vim: ts=4:sw=4:noexpandtab
+/*
+
+Copyright (c) 2010--2018,
+François Pomerleau and Stephane Magnenat, ASL, ETHZ, Switzerland
+You can contact the authors at <f dot pomerleau at gmail dot com> and
+<stephane at magnenat dot net>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ETH-ASL BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "PointMatcher.h"
+
+#include "octree.h"
+
+/*!
+ * \class linearoctree.h
+ * \brief Pointerless Octree class for DataPoints spatial representation
+ *
+ * Octree/Quadtree with the same decomposition and visiting order as Octree_,
+ * but whose nodes are stored contiguously in an arena instead of being
+ * allocated one by one.
+ *
+ * Building:
+ *	- the Morton code of every point is computed by following the splits of Octree_,
+ *	  the cell id of each level giving dim bits of the code,
+ *	- the (code, index) pairs are sorted, so that the points of every node are contiguous,
+ *	- each node is split by searching in its range where the digit of its depth changes.
+ *
+ * The top of the tree is split until there are enough subtrees for the threads,
+ * then a bounded pool of threads builds the subtrees, each thread taking the next
+ * largest subtree not taken yet, and the subtrees are moved into the arena.
+ *
+ * Callbacks of visit() receive a LinearOctree_::Node, with the same accessors as Octree_,
+ * so that the same visitors can be used for both trees.
+ *
+ * Remark:
+ *	- The depth is limited to maxDepth, the nodes of that depth being leaves.
+ *	- Data of a node is a view on the sorted indexes, valid as long as the tree.
+ *
+ */
+
+template < typename T, std::size_t dim >
+class LinearOctree_ 
+{
+public:		
+	using PM = PointMatcher<T>;
+	using DP = typename PM::DataPoints; /**/
+	using Id = typename DP::Index; /**/
+	
+	using Data = typename DP::Index; /**/
+	
+	using Point = Eigen::Matrix<T,dim,1>;
+	
+	static constexpr std::size_t nbCells = PointMatcherSupport::pow(2, dim);
+	//! Maximum depth of a node, the Morton codes having dim bits per level
+	static constexpr std::size_t maxDepth = 64 / dim;
+	
+	//! Contiguous indexes of the points of a node
+	struct DataView
+	{
+		const Data* first;
+		std::size_t count;
+		
+		std::size_t size() const { return count; }
+		bool empty() const { return count == 0; }
+		const Data& operator[](std::size_t i) const { return first[i]; }
+		const Data* begin() const { return first; }
+		const Data* end() const { return first + count; }
+	};
+	
+private:
+	typedef std::uint64_t Code;
+	typedef std::pair<Code, Data> Key;
+	
+	static constexpr std::size_t noCell = std::size_t(-1);
+	
+	struct Cell
+	{
+		Point center;
+		T radius;
+		std::size_t depth;
+		std::size_t parent; //!< noCell for the root
+		std::size_t firstChild; //!< the nbCells children are contiguous, noCell for a leaf
+		std::size_t begin; //!< first index of the data in the sorted keys
+		std::size_t end; //!< past-the-end index of the data
+	};
+	typedef std::vector<Cell, Eigen::aligned_allocator<Cell>> Cells;
+	
+	Cells cells; //!< arena of the nodes, the root being the first
+	std::vector<Data> data; //!< indexes of the points, sorted by Morton code
+	
+public:
+	//! A node of the tree, as seen by the callbacks of visit()
+	class Node
+	{
+	public:
+		using Point = typename LinearOctree_::Point;
+		using DataView = typename LinearOctree_::DataView;
+		
+		Node(const LinearOctree_* tree, std::size_t id);
+		
+		bool isLeaf() const;
+		bool isRoot() const;
+		bool isEmpty() const;
+		
+		std::size_t getDepth() const;
+		
+		T getRadius() const;
+		Point getCenter() const;
+		
+		const DataView* getData() const;
+		Node operator[](std::size_t idx) const;
+		
+	private:
+		const LinearOctree_* tree;
+		std::size_t id;
+		DataView dataView;
+	};
+	
+	// Build tree from DataPoints with a specified stop parameter, nbThreads=0 uses one thread per hardware thread
+	bool build(const DP& pts, std::size_t maxDataByNode=1, T maxSizeByNode=T(0.), unsigned nbThreads=1);
+	
+	//! Return the number of nodes, including empty leaves
+	std::size_t getNbNodes() const;
+	
+	template < typename Callback >
+	bool visit(Callback& cb);
+	
+private:
+	Code computeCode(const Point& pt, Point center, T radius) const;
+	static void sortKeys(std::vector<Key>& keys, unsigned nbThreads);
+	bool split(Cells& arena, std::size_t id, const std::vector<Key>& keys, std::size_t maxDataByNode, T maxSizeByNode) const;
+	void buildSubtree(Cells& arena, std::size_t id, const std::vector<Key>& keys, std::size_t maxDataByNode, T maxSizeByNode) const;
+	
+	template < typename Callback >
+	bool visit(std::size_t id, Callback& cb);
+};
+	
+#include "linearoctree.hpp"
+
+template<typename T> using LinearQuadtree = LinearOctree_<T,2>;
+template<typename T> using LinearOctree = LinearOctree_<T,3>;
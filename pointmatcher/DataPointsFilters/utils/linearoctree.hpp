@@ -0,0 +1,345 @@
+// kate: replace-tabs off; indent-width 4; indent-mode normal
+// vim: ts=4:sw=4:noexpandtab
+/*
+
+Copyright (c) 2010--2018,
+François Pomerleau and Stephane Magnenat, ASL, ETHZ, Switzerland
+You can contact the authors at <f dot pomerleau at gmail dot com> and
+<stephane at magnenat dot net>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ETH-ASL BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#include "octree.h"
+#include "linearoctree.h"
+
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <ciso646>
+
+template<typename T, std::size_t dim>
+constexpr std::size_t LinearOctree_<T,dim>::nbCells;
+template<typename T, std::size_t dim>
+constexpr std::size_t LinearOctree_<T,dim>::maxDepth;
+template<typename T, std::size_t dim>
+constexpr std::size_t LinearOctree_<T,dim>::noCell;
+
+template<typename T, std::size_t dim>
+LinearOctree_<T,dim>::Node::Node(const LinearOctree_* tree, std::size_t id):
+	tree{tree}, id{id}
+{
+	const Cell& cell(tree->cells[id]);
+	dataView.first = tree->data.data() + cell.begin;
+	dataView.count = cell.end - cell.begin;
+}
+
+template<typename T, std::size_t dim>
+bool LinearOctree_<T,dim>::Node::isLeaf() const
+{
+	return (tree->cells[id].firstChild == noCell);
+}
+template<typename T, std::size_t dim>
+bool LinearOctree_<T,dim>::Node::isRoot() const
+{
+	return (tree->cells[id].parent == noCell);
+}
+template<typename T, std::size_t dim>
+bool LinearOctree_<T,dim>::Node::isEmpty() const
+{
+	// as in Octree_, only leaves hold data
+	return (!isLeaf() or dataView.empty());
+}
+template<typename T, std::size_t dim>
+std::size_t LinearOctree_<T,dim>::Node::getDepth() const
+{
+	return tree->cells[id].depth;
+}
+template<typename T, std::size_t dim>
+T LinearOctree_<T,dim>::Node::getRadius() const
+{
+	return tree->cells[id].radius;
+}
+template<typename T, std::size_t dim>
+typename LinearOctree_<T,dim>::Point LinearOctree_<T,dim>::Node::getCenter() const
+{
+	return tree->cells[id].center;
+}
+template<typename T, std::size_t dim>
+const typename LinearOctree_<T,dim>::DataView* LinearOctree_<T,dim>::Node::getData() const
+{
+	return &dataView;
+}
+template<typename T, std::size_t dim>
+typename LinearOctree_<T,dim>::Node LinearOctree_<T,dim>::Node::operator[](std::size_t idx) const
+{
+	assert(idx<nbCells and not isLeaf());
+	return Node(tree, tree->cells[id].firstChild + idx);
+}
+
+template<typename T, std::size_t dim>
+std::size_t LinearOctree_<T,dim>::getNbNodes() const
+{
+	return cells.size();
+}
+
+// Morton code of pt, the cell id of each level being computed as in Octree_
+template<typename T, std::size_t dim>
+typename LinearOctree_<T,dim>::Code LinearOctree_<T,dim>::computeCode(const Point& pt, Point center, T radius) const
+{
+	Code code = 0;
+	for(std::size_t depth=0; depth<maxDepth; ++depth)
+	{
+		std::size_t id = 0;
+		for(std::size_t i=0; i<dim; ++i)
+			id|= ((pt(i) > center(i)) << i);
+		code|= (Code(id) << ((maxDepth - 1 - depth) * dim));
+		
+		const Point offset = OctreeHelper<T,dim>::offsetTable[id] * radius;
+		center = center + offset;
+		radius = radius * 0.5;
+	}
+	return code;
+}
+
+// Sort chunks in parallel, then merge pairs of neighbouring chunks in parallel
+template<typename T, std::size_t dim>
+void LinearOctree_<T,dim>::sortKeys(std::vector<Key>& keys, unsigned nbThreads)
+{
+	using namespace PointMatcherSupport;
+	
+	const std::size_t nbKeys = keys.size();
+	const unsigned chunkCount = getChunkCount(nbKeys, nbThreads, 65536);
+	parallelForChunks(nbKeys, chunkCount, [&keys](const unsigned, const std::size_t begin, const std::size_t end) {
+			std::sort(keys.begin() + begin, keys.begin() + end);
+		});
+	
+	for(unsigned width=1; width<chunkCount; width*=2)
+	{
+		const unsigned nbMerges = (chunkCount + 2 * width - 1) / (2 * width);
+		parallelForChunks(nbMerges, getChunkCount(nbMerges, nbThreads), [&](const unsigned, const std::size_t begin, const std::size_t end) {
+				for(std::size_t merge=begin; merge<end; ++merge)
+				{
+					const unsigned first = unsigned(merge) * 2 * width;
+					const unsigned middle = std::min(first + width, chunkCount);
+					const unsigned last = std::min(first + 2 * width, chunkCount);
+					std::inplace_merge(
+						keys.begin() + getChunkBegin(nbKeys, chunkCount, first),
+						keys.begin() + getChunkBegin(nbKeys, chunkCount, middle),
+						keys.begin() + getChunkBegin(nbKeys, chunkCount, last));
+				}
+			});
+	}
+}
+
+// Append the children of arena[id] if it has to be split, return whether it was
+template<typename T, std::size_t dim>
+bool LinearOctree_<T,dim>::split(Cells& arena, std::size_t id, const std::vector<Key>& keys, 
+	std::size_t maxDataByNode, T maxSizeByNode) const
+{
+	const Cell cell = arena[id];
+	
+	//Check stop condition, as Octree_ does
+	if((cell.radius*2.0 <= maxSizeByNode) or ((cell.end - cell.begin) <= maxDataByNode) or (cell.depth == maxDepth))
+		return false;
+	
+	arena[id].firstChild = arena.size();
+	
+	//Split the range where the cell id of this depth changes
+	const std::size_t shift = (maxDepth - 1 - cell.depth) * dim;
+	const T half_radius = cell.radius * 0.5;
+	std::size_t begin = cell.begin;
+	for(std::size_t i=0; i<nbCells; ++i)
+	{
+		const auto endIt = std::partition_point(keys.begin() + begin, keys.begin() + cell.end, 
+			[shift, i](const Key& key) { return ((key.first >> shift) & (nbCells - 1)) <= i; });
+		
+		const Point offset = OctreeHelper<T,dim>::offsetTable[i] * cell.radius;
+		Cell child;
+		child.center = cell.center + offset;
+		child.radius = half_radius;
+		child.depth = cell.depth + 1;
+		child.parent = id;
+		child.firstChild = noCell;
+		child.begin = begin;
+		child.end = endIt - keys.begin();
+		arena.push_back(child);
+		
+		begin = child.end;
+	}
+	return true;
+}
+
+template<typename T, std::size_t dim>
+void LinearOctree_<T,dim>::buildSubtree(Cells& arena, std::size_t id, const std::vector<Key>& keys, 
+	std::size_t maxDataByNode, T maxSizeByNode) const
+{
+	if(!split(arena, id, keys, maxDataByNode, maxSizeByNode))
+		return;
+	
+	const std::size_t firstChild = arena[id].firstChild;
+	for(std::size_t i=0; i<nbCells; ++i)
+		buildSubtree(arena, firstChild + i, keys, maxDataByNode, maxSizeByNode);
+}
+
+// Build tree from DataPoints with a specified number of points by node
+template<typename T, std::size_t dim>
+bool LinearOctree_<T,dim>::build(const DP& pts, std::size_t maxDataByNode, T maxSizeByNode, unsigned nbThreads)
+{
+	typedef typename PM::Vector Vector;
+	using namespace PointMatcherSupport;
+	
+	nbThreads = getThreadCount(nbThreads);
+	cells.clear();
+	data.clear();
+	
+	//Build bounding box, as Octree_ does
+	Cell root;
+	
+	Vector minValues = pts.features.rowwise().minCoeff();
+	Vector maxValues = pts.features.rowwise().maxCoeff();
+	
+	Point min = minValues.head(dim);
+	Point max = maxValues.head(dim);
+	
+	Point radii = max - min;
+	root.center = min + radii * 0.5;
+	
+	root.radius = radii(0);
+	for(size_t i=1; i<dim; ++i)
+		if (root.radius < radii(i)) root.radius = radii(i);
+		
+	root.radius*=0.5;
+	
+	const std::size_t nbpts = pts.getNbPoints();
+	root.depth = 0;
+	root.parent = noCell;
+	root.firstChild = noCell;
+	root.begin = 0;
+	root.end = nbpts;
+	
+	//Sort the points by Morton code
+	std::vector<Key> keys(nbpts);
+	parallelForChunks(nbpts, getChunkCount(nbpts, nbThreads, 4096), [&](const unsigned, const std::size_t begin, const std::size_t end) {
+			for(std::size_t i=begin; i<end; ++i)
+				keys[i] = Key(computeCode(pts.features.col(i).template head<dim>(), root.center, root.radius), Data(i));
+		});
+	sortKeys(keys, nbThreads);
+	
+	cells.push_back(root);
+	
+	//Split the top of the tree until there are enough subtrees to balance the threads
+	std::vector<std::size_t> subtrees(1, 0);
+	const std::size_t minSubtreeCount = (nbThreads > 1 ? 8 * nbThreads : 1);
+	while(not subtrees.empty() and subtrees.size() < minSubtreeCount)
+	{
+		std::vector<std::size_t> children;
+		for(const std::size_t id : subtrees)
+			if(split(cells, id, keys, maxDataByNode, maxSizeByNode))
+				for(std::size_t i=0; i<nbCells; ++i)
+					children.push_back(cells[id].firstChild + i);
+		subtrees.swap(children);
+	}
+	
+	//Build the subtrees, largest first, each one in its own arena
+	std::sort(subtrees.begin(), subtrees.end(), [this](const std::size_t a, const std::size_t b) {
+			return (cells[a].end - cells[a].begin) > (cells[b].end - cells[b].begin);
+		});
+	std::vector<Cells> arenas(subtrees.size());
+	std::atomic<std::size_t> nextSubtree(0);
+	const unsigned workerCount = getChunkCount(subtrees.size(), nbThreads);
+	parallelForChunks(workerCount, workerCount, [&](const unsigned, const std::size_t, const std::size_t) {
+			for(std::size_t s=nextSubtree++; s<subtrees.size(); s=nextSubtree++)
+			{
+				arenas[s].push_back(cells[subtrees[s]]);
+				buildSubtree(arenas[s], 0, keys, maxDataByNode, maxSizeByNode);
+			}
+		});
+	
+	//Move the subtrees into the arena, their root already being in it
+	for(std::size_t s=0; s<subtrees.size(); ++s)
+	{
+		const Cells& arena = arenas[s];
+		const std::size_t rootId = subtrees[s];
+		const std::size_t offset = cells.size() - 1;
+		if(arena.front().firstChild != noCell)
+			cells[rootId].firstChild = arena.front().firstChild + offset;
+		for(std::size_t i=1; i<arena.size(); ++i)
+		{
+			Cell cell = arena[i];
+			cell.parent = (cell.parent == 0 ? rootId : cell.parent + offset);
+			if(cell.firstChild != noCell)
+				cell.firstChild += offset;
+			cells.push_back(cell);
+		}
+		Cells().swap(arenas[s]);
+	}
+	
+	data.resize(nbpts);
+	for(std::size_t i=0; i<nbpts; ++i)
+		data[i] = keys[i].second;
+	
+	//Sort the data of every leaf by index, as in Octree_
+	const std::size_t nbCellsInArena = cells.size();
+	parallelForChunks(nbCellsInArena, getChunkCount(nbCellsInArena, nbThreads, 4096), [this](const unsigned, const std::size_t begin, const std::size_t end) {
+			for(std::size_t id=begin; id<end; ++id)
+			{
+				const Cell& cell = cells[id];
+				if(cell.firstChild == noCell and cell.end - cell.begin > 1)
+					std::sort(data.begin() + cell.begin, data.begin() + cell.end);
+			}
+		});
+	
+	return true;
+}
+
+//------------------------------------------------------------------------------
+template<typename T, std::size_t dim>
+template<typename Callback>
+bool LinearOctree_<T,dim>::visit(Callback& cb)
+{
+	if(cells.empty())
+		return true;
+	return visit(0, cb);
+}
+
+template<typename T, std::size_t dim>
+template<typename Callback>
+bool LinearOctree_<T,dim>::visit(std::size_t id, Callback& cb)
+{
+	// Call the callback for this node (if the callback returns false, then
+	// stop traversing.
+	Node node(this, id);
+	if (!cb(node)) return false;
+
+	// If I'm a node, recursively traverse my children
+	const std::size_t firstChild = cells[id].firstChild;
+	if (firstChild != noCell)
+		for (size_t i=0; i<nbCells; ++i)
+			if (!visit(firstChild + i, cb)) return false;
+
+	return true;
+}
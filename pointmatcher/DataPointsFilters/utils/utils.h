@@ -36,6 +36,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "PointMatcher.h"
 
+#include "Eigen/Eigenvalues"
+
 #include <vector>
 #include <algorithm>
 #include <cmath>
@@ -102,8 +104,8 @@ serializeEigVec(const typename PointMatcher<T>::Matrix& eigenVe)
 	return output;
 }
 
-template<typename T>
-T computeDensity(const typename PointMatcher<T>::Matrix& NN)
+template<typename T, typename Derived>
+T computeDensity(const Eigen::MatrixBase<Derived>& NN)
 {
 	//volume in meter
 	const T volume = (4./3.)*M_PI*std::pow(NN.colwise().norm().maxCoeff(), 3);
@@ -138,6 +140,50 @@ computeNormal(const typename PointMatcher<T>::Vector& eigenVa, const typename Po
   return eigenVe.col(smallestId);
 }
 
+//! Eigen-decomposition of a symmetric covariance matrix, with the eigenvalues sorted in ascending order
+/**
+	Fixed-size 2x2 and 3x3 matrices are decomposed in closed form without any heap allocation,
+	other sizes fall back to the iterative self-adjoint solver.
+	The eigenvectors are the columns of eigenVe, in the same order as eigenVa.
+*/
+template<typename T, int Dim>
+void computeSortedEigenDirect(const Eigen::Matrix<T, Dim, Dim>& C, Eigen::Matrix<T, Dim, 1>& eigenVa, Eigen::Matrix<T, Dim, Dim>& eigenVe)
+{
+	Eigen::SelfAdjointEigenSolver<Eigen::Matrix<T, Dim, Dim> > solver;
+	solver.computeDirect(C);
+	eigenVa = solver.eigenvalues();
+	eigenVe = solver.eigenvectors();
+}
+
+//! Closed-form eigen-decomposition of a Dim x Dim covariance stored in a dynamic-size matrix, with the eigenvalues sorted in ascending order
+template<typename T, int Dim>
+void computeSortedEigenFixed(const typename PointMatcher<T>::Matrix& C, typename PointMatcher<T>::Vector& eigenVa, typename PointMatcher<T>::Matrix& eigenVe)
+{
+	Eigen::Matrix<T, Dim, 1> fixedEigenVa;
+	Eigen::Matrix<T, Dim, Dim> fixedEigenVe;
+	computeSortedEigenDirect<T, Dim>(C, fixedEigenVa, fixedEigenVe);
+	// copy through fixed-size blocks, which are not written with packets larger than them
+	eigenVa.resize(Dim);
+	eigenVa.template head<Dim>() = fixedEigenVa;
+	eigenVe.resize(Dim, Dim);
+	eigenVe.template topLeftCorner<Dim, Dim>() = fixedEigenVe;
+}
+
+//! Eigen-decomposition of a symmetric covariance matrix of any size, with the eigenvalues sorted in ascending order
+/**
+	2D and 3D covariances are dispatched to the closed-form fixed-size solver.
+*/
+template<typename T>
+void computeSortedEigen(const typename PointMatcher<T>::Matrix& C, typename PointMatcher<T>::Vector& eigenVa, typename PointMatcher<T>::Matrix& eigenVe)
+{
+	if (C.rows() == 3)
+		computeSortedEigenFixed<T, 3>(C, eigenVa, eigenVe);
+	else if (C.rows() == 2)
+		computeSortedEigenFixed<T, 2>(C, eigenVa, eigenVe);
+	else
+		computeSortedEigenDirect<T, Eigen::Dynamic>(C, eigenVa, eigenVe);
+}
+
 template<typename T>
 size_t argMax(const typename PointMatcher<T>::Vector& v)
 {
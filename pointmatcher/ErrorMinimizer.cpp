@@ -58,9 +58,17 @@ PointMatcher<T>::ErrorMinimizer::ErrorElements::ErrorElements():
 template<typename T>
 PointMatcher<T>::ErrorMinimizer::ErrorElements::ErrorElements(const DataPoints& requestedPts, const DataPoints& sourcePts, const OutlierWeights& outlierWeights, const Matches& matches)
 {
-	typedef typename Matches::Ids Ids;
-	typedef typename Matches::Dists Dists;
-	
+	gather(requestedPts, sourcePts, outlierWeights, matches, 0, 0);
+}
+
+//! Align the data into this structure, reusing its storage when the number of kept points does not change.
+/**
+	Only the descriptors listed in requestedDescriptors and sourceDescriptors are kept, in that order, skipping those missing from the clouds, and times are dropped.
+	A null list keeps all descriptors and times of the corresponding cloud.
+*/
+template<typename T>
+void PointMatcher<T>::ErrorMinimizer::ErrorElements::gather(const DataPoints& requestedPts, const DataPoints& sourcePts, const OutlierWeights& outlierWeights, const Matches& matches, const StringVector* requestedDescriptors, const StringVector* sourceDescriptors)
+{
 	assert(matches.ids.rows() > 0);
 	assert(matches.ids.cols() > 0);
 	assert(matches.ids.cols() == requestedPts.features.cols()); //nbpts
@@ -68,26 +76,43 @@ PointMatcher<T>::ErrorMinimizer::ErrorElements::ErrorElements(const DataPoints&
 	
 	const int knn = outlierWeights.rows();
 	const int dimFeat = requestedPts.features.rows();
-	const int dimReqDesc = requestedPts.descriptors.rows();
-	const int dimReqTime = requestedPts.times.rows();
+	const int nbReqPts = requestedPts.features.cols();
 
 	// Count points with no weights
 	const int pointsCount = (outlierWeights.array() != 0.0).count();
 	if (pointsCount == 0)
 		throw ConvergenceError("ErrorMnimizer: no point to minimize");
 
-	Matrix keptFeat(dimFeat, pointsCount);
-	
-	Matrix keptDesc;
-	if(dimReqDesc > 0)
-		keptDesc = Matrix(dimReqDesc, pointsCount);
-	
-	Int64Matrix keptTime;
-	if(dimReqTime > 0)
-		keptTime = Int64Matrix(dimReqTime, pointsCount);
-	
-	Matches keptMatches (Dists(1,pointsCount), Ids(1, pointsCount));
-	OutlierWeights keptWeights(1, pointsCount);
+	assert(dimFeat == sourcePts.features.rows());
+
+	// Select the descriptor blocks to gather, as (source row, span) pairs
+	Labels reqDescLabels, sourDescLabels;
+	std::vector<std::pair<int, int> > reqDescBlocks, sourDescBlocks;
+	selectDescriptors(requestedPts, requestedDescriptors, reqDescLabels, reqDescBlocks);
+	selectDescriptors(sourcePts, sourceDescriptors, sourDescLabels, sourDescBlocks);
+	const int dimReqDesc = reqDescLabels.totalDim();
+	const int dimSourDesc = sourDescLabels.totalDim();
+	const int dimReqTime = requestedDescriptors ? 0 : requestedPts.times.rows();
+	const int dimSourTime = sourceDescriptors ? 0 : sourcePts.times.rows();
+
+	// Resizing is a no-op when the sizes did not change since the last call
+	reading.featureLabels = requestedPts.featureLabels;
+	reading.descriptorLabels = reqDescLabels;
+	reading.timeLabels = requestedDescriptors ? Labels() : requestedPts.timeLabels;
+	reading.features.resize(dimFeat, pointsCount);
+	reading.descriptors.resize(dimReqDesc, dimReqDesc > 0 ? pointsCount : 0);
+	reading.times.resize(dimReqTime, dimReqTime > 0 ? pointsCount : 0);
+
+	reference.featureLabels = sourcePts.featureLabels;
+	reference.descriptorLabels = sourDescLabels;
+	reference.timeLabels = sourceDescriptors ? Labels() : sourcePts.timeLabels;
+	reference.features.resize(dimFeat, pointsCount);
+	reference.descriptors.resize(dimSourDesc, dimSourDesc > 0 ? pointsCount : 0);
+	reference.times.resize(dimSourTime, dimSourTime > 0 ? pointsCount : 0);
+
+	this->matches.dists.resize(1, pointsCount);
+	this->matches.ids.resize(1, pointsCount);
+	this->weights.resize(1, pointsCount);
 
 	int j = 0;
 	int rejectedMatchCount = 0;
@@ -95,7 +120,7 @@ PointMatcher<T>::ErrorMinimizer::ErrorElements::ErrorElements(const DataPoints&
 	bool matchExist = false;
 	this->weightedPointUsedRatio = 0;
 	
-	for (int i = 0; i < requestedPts.features.cols(); ++i) //nb pts
+	for (int i = 0; i < nbReqPts; ++i) //nb pts
 	{
 		matchExist = false;
 		for(int k = 0; k < knn; k++) // knn
@@ -107,17 +132,21 @@ PointMatcher<T>::ErrorMinimizer::ErrorElements::ErrorElements(const DataPoints&
 
 			if (outlierWeights(k,i) != 0.0)
 			{
-				if(dimReqDesc > 0)
-					keptDesc.col(j) = requestedPts.descriptors.col(i);
+				const int refIndex(matches.ids(k, i));
 
+				reading.features.col(j) = requestedPts.features.col(i);
+				gatherDescriptors(requestedPts, reqDescBlocks, i, reading.descriptors, j);
 				if(dimReqTime > 0)
-					keptTime.col(j) = requestedPts.times.col(i);
+					reading.times.col(j) = requestedPts.times.col(i);
 
-				
-				keptFeat.col(j) = requestedPts.features.col(i);
-				keptMatches.ids(0, j) = matches.ids(k, i);
-				keptMatches.dists(0, j) = matchDist;
-				keptWeights(0,j) = outlierWeights(k,i);
+				reference.features.col(j) = sourcePts.features.col(refIndex);
+				gatherDescriptors(sourcePts, sourDescBlocks, refIndex, reference.descriptors, j);
+				if(dimSourTime > 0)
+					reference.times.col(j) = sourcePts.times.col(refIndex);
+
+				this->matches.ids(0, j) = refIndex;
+				this->matches.dists(0, j) = matchDist;
+				this->weights(0,j) = outlierWeights(k,i);
 				++j;
 				this->weightedPointUsedRatio += outlierWeights(k,i);
 				matchExist = true;
@@ -136,60 +165,45 @@ PointMatcher<T>::ErrorMinimizer::ErrorElements::ErrorElements(const DataPoints&
 
 	assert(j == pointsCount);
 
-	this->pointUsedRatio = T(j)/T(knn*requestedPts.features.cols());
-	this->weightedPointUsedRatio /= T(knn*requestedPts.features.cols());
-	
-	assert(dimFeat == sourcePts.features.rows());
-	const int dimSourDesc = sourcePts.descriptors.rows();
-	const int dimSourTime = sourcePts.times.rows();
-	
-	Matrix associatedFeat(dimFeat, pointsCount);
-	
-	Matrix associatedDesc;
-	if(dimSourDesc > 0)
-		associatedDesc = Matrix(dimSourDesc, pointsCount);
-	
-	Int64Matrix associatedTime;
-	if(dimSourTime> 0)
-		associatedTime = Int64Matrix(dimSourTime, pointsCount);
-	
-	// Fetch matched points
-	for (int i = 0; i < pointsCount; ++i)
-	{
-		const int refIndex(keptMatches.ids(i));
-		associatedFeat.col(i) = sourcePts.features.block(0, refIndex, dimFeat, 1);
-		
-		if(dimSourDesc > 0)
-			associatedDesc.col(i) = sourcePts.descriptors.block(0, refIndex, dimSourDesc, 1);
+	this->pointUsedRatio = T(j)/T(knn*nbReqPts);
+	this->weightedPointUsedRatio /= T(knn*nbReqPts);
+	this->nbRejectedMatches = rejectedMatchCount;
+	this->nbRejectedPoints = rejectedPointCount;
+}
 
-		if(dimSourTime> 0)
-			associatedTime.col(i) = sourcePts.times.block(0, refIndex, dimSourTime, 1);
+//! Select the descriptors of cloud listed in names, or all of them if names is null
+template<typename T>
+void PointMatcher<T>::ErrorMinimizer::ErrorElements::selectDescriptors(const DataPoints& cloud, const StringVector* names, Labels& labels, std::vector<std::pair<int, int> >& blocks)
+{
+	if (!names)
+	{
+		labels = cloud.descriptorLabels;
+		if (cloud.descriptors.rows() > 0)
+			blocks.push_back(std::make_pair(0, int(cloud.descriptors.rows())));
+		return;
+	}
 
+	for (size_t i = 0; i < names->size(); ++i)
+	{
+		const std::string& name((*names)[i]);
+		if (!cloud.descriptorExists(name))
+			continue;
+		const unsigned span(cloud.getDescriptorDimension(name));
+		labels.push_back(Label(name, span));
+		blocks.push_back(std::make_pair(int(cloud.getDescriptorStartingRow(name)), int(span)));
 	}
+}
 
-	// Copy final data to structure
-	this->reading = DataPoints(
-		keptFeat, 
-		requestedPts.featureLabels,
-		keptDesc,
-		requestedPts.descriptorLabels,
-		keptTime,
-		requestedPts.timeLabels
-	);
-
-	this->reference = DataPoints(
-		associatedFeat,
-		sourcePts.featureLabels,
-		associatedDesc,
-		sourcePts.descriptorLabels,
-		associatedTime,
-		sourcePts.timeLabels
-	);
-
-	this->weights = keptWeights;
-	this->matches = keptMatches;
-	this->nbRejectedMatches = rejectedMatchCount;
-	this->nbRejectedPoints = rejectedPointCount;
+//! Copy the selected descriptor blocks of column srcCol of cloud to column dstCol of dst
+template<typename T>
+void PointMatcher<T>::ErrorMinimizer::ErrorElements::gatherDescriptors(const DataPoints& cloud, const std::vector<std::pair<int, int> >& blocks, const int srcCol, Matrix& dst, const int dstCol)
+{
+	int row(0);
+	for (size_t b = 0; b < blocks.size(); ++b)
+	{
+		dst.block(row, dstCol, blocks[b].second, 1) = cloud.descriptors.block(blocks[b].first, srcCol, blocks[b].second, 1);
+		row += blocks[b].second;
+	}
 }
 
 
@@ -231,6 +245,29 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ErrorMinimiz
 	return transform;
 }
 
+//! Find the transformation that minimizes the error, gathering the matched points into the storage of lastErrorElements
+/**
+	Unlike compute(), only the descriptors returned by getRequiredDescriptors() are kept in lastErrorElements.
+*/
+template<typename T>
+typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ErrorMinimizer::computeReusingBuffers(const DataPoints& filteredReading, const DataPoints& filteredReference, const OutlierWeights& outlierWeights, const Matches& matches)
+{
+	StringVector readingDescriptors, referenceDescriptors;
+	if (getRequiredDescriptors(readingDescriptors, referenceDescriptors))
+		this->lastErrorElements.gather(filteredReading, filteredReference, outlierWeights, matches, &readingDescriptors, &referenceDescriptors);
+	else
+		this->lastErrorElements.gather(filteredReading, filteredReference, outlierWeights, matches, 0, 0);
+	
+	return this->compute(this->lastErrorElements);
+}
+
+//! If not redefined by child class, return false as any descriptor might be used
+template<typename T>
+bool PointMatcher<T>::ErrorMinimizer::getRequiredDescriptors(StringVector& readingDescriptors, StringVector& referenceDescriptors) const
+{
+	return false;
+}
+
 //! Return the ratio of how many points were used for error minimization
 template<typename T>
 T PointMatcher<T>::ErrorMinimizer::getPointUsedRatio() const
@@ -42,5 +42,11 @@ typename PointMatcher<T>::TransformationParameters IdentityErrorMinimizer<T>::co
 	return TransformationParameters::Identity(dim, dim);
 }
 
+template<typename T>
+bool IdentityErrorMinimizer<T>::getRequiredDescriptors(StringVector& readingDescriptors, StringVector& referenceDescriptors) const
+{
+	return true;
+}
+
 template struct IdentityErrorMinimizer<float>;
 template struct IdentityErrorMinimizer<double>;
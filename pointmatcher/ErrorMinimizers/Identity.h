@@ -43,6 +43,7 @@ struct IdentityErrorMinimizer: PointMatcher<T>::ErrorMinimizer
 {
 	typedef typename PointMatcher<T>::TransformationParameters TransformationParameters;
 	typedef typename PointMatcher<T>::ErrorMinimizer::ErrorElements ErrorElements;
+	typedef typename PointMatcher<T>::ErrorMinimizer::StringVector StringVector;
 	
 	inline static const std::string description()
 	{
@@ -54,6 +55,7 @@ struct IdentityErrorMinimizer: PointMatcher<T>::ErrorMinimizer
 																														 PointMatcherSupport::Parametrizable::Parameters()) {}
 	//virtual TransformationParameters compute(const DataPoints& filteredReading, const DataPoints& filteredReference, const OutlierWeights& outlierWeights, const Matches& matches);
 	virtual TransformationParameters compute(const ErrorElements& mPts);
+	virtual bool getRequiredDescriptors(StringVector& readingDescriptors, StringVector& referenceDescriptors) const;
 };
 
 #endif //LIBPOINTMATCHER_IDENTITY_H
@@ -40,6 +40,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "ErrorMinimizersImpl.h"
 #include "PointMatcherPrivate.h"
 #include "Functions.h"
+#include "Parallel.h"
+
+#include <vector>
 
 using namespace Eigen;
 using namespace std;
@@ -54,7 +57,8 @@ template<typename T>
 PointToPlaneErrorMinimizer<T>::PointToPlaneErrorMinimizer(const Parameters& params):
 	ErrorMinimizer(name(), availableParameters(), params),
 	force2D(Parametrizable::get<T>("force2D")),
-    force4DOF(Parametrizable::get<T>("force4DOF"))
+    force4DOF(Parametrizable::get<T>("force4DOF")),
+	nbThreads(Parametrizable::get<unsigned>("nbThreads"))
 {
 	if(force2D)
 		{
@@ -81,7 +85,8 @@ template<typename T>
 PointToPlaneErrorMinimizer<T>::PointToPlaneErrorMinimizer(const ParametersDoc paramsDoc, const Parameters& params):
 	ErrorMinimizer(name(), paramsDoc, params),
 	force2D(Parametrizable::get<T>("force2D")),
-	force4DOF(Parametrizable::get<T>("force4DOF"))
+	force4DOF(Parametrizable::get<T>("force4DOF")),
+	nbThreads(Parametrizable::get<unsigned>("nbThreads"))
 {
 	if(force2D)
 	{
@@ -141,7 +146,7 @@ void solvePossiblyUnderdeterminedLinearSystem(const MatrixA& A, const Vector & b
 		BOOST_AUTO(ax , (A * x).eval());
 		if (!b.isApprox(ax, 1e-5)) {
 			LOG_INFO_STREAM("PointMatcher::icp - encountered almost singular matrix while minimizing point to plane distance. QR solution was too inaccurate. Trying more accurate approach using double precision SVD.");
-			x = A.template cast<double>().jacobiSvd(ComputeThinU | ComputeThinV).solve(b.template cast<double>()).template cast<T>();
+			x = A.template cast<double>().jacobiSvd(ComputeFullU | ComputeFullV).solve(b.template cast<double>()).template cast<T>();
 			ax = A * x;
 
 			if((b - ax).norm() > 1e-5 * std::max(A.norm() * x.norm(), b.norm())){
@@ -160,11 +165,77 @@ void solvePossiblyUnderdeterminedLinearSystem(const MatrixA& A, const Vector & b
 	}
 }
 
+//! Solve the normal equations A x = b of the point-to-plane minimization, accumulated in a single pass over the matches
+/**
+	row(i, v) sets v to the column of F = [cross, normals] of the i-th match,
+	and returns the distance of its reading point to the plane of its
+	reference point, so that A = sum(w * v * v') and b = -sum(w * v * distance).
+	The matches are summed by batches into fixed-size matrices, without
+	temporaries of the size of the matches. Blocks of matches are summed in
+	parallel and reduced in order, so that x does not depend on the number of threads.
+*/
+template<typename T, int ParamCount, typename Row>
+typename PointMatcher<T>::Vector solveAccumulatedNormalEquations(const typename PointMatcher<T>::OutlierWeights& weights, const unsigned nbThreads, Row row)
+{
+	typedef Eigen::Matrix<T, ParamCount, ParamCount> MatrixA;
+	typedef Eigen::Matrix<T, ParamCount, 1> VectorB;
+	const int batchSize(64);
+	typedef Eigen::Matrix<T, ParamCount, batchSize> Batch;
+
+	const std::size_t nbPts(weights.cols());
+	const std::size_t blockSize(4096);
+	const std::size_t nbBlocks((nbPts + blockSize - 1) / blockSize);
+	std::vector<MatrixA, Eigen::aligned_allocator<MatrixA>> blockAs(nbBlocks, MatrixA::Zero());
+	std::vector<VectorB, Eigen::aligned_allocator<VectorB>> blockBs(nbBlocks, VectorB::Zero());
+	PointMatcherSupport::parallelForChunks(nbBlocks, PointMatcherSupport::getChunkCount(nbBlocks, nbThreads), [&](const unsigned, const std::size_t firstBlock, const std::size_t lastBlock)
+	{
+		Batch F;
+		Batch wF;
+		Eigen::Matrix<T, batchSize, 1> distances;
+		VectorB v;
+		for (std::size_t block = firstBlock; block < lastBlock; ++block)
+		{
+			const std::size_t end(std::min(nbPts, (block + 1) * blockSize));
+			for (std::size_t batchBegin = block * blockSize; batchBegin < end; batchBegin += batchSize)
+			{
+				const int count(int(std::min<std::size_t>(batchSize, end - batchBegin)));
+				for (int j = 0; j < count; ++j)
+				{
+					const std::size_t i(batchBegin + j);
+					distances(j) = row(i, v);
+					F.col(j) = v;
+					wF.col(j) = weights(0, i) * v;
+				}
+				// Pad the last batch, so that all products have a fixed size
+				for (int j = count; j < batchSize; ++j)
+				{
+					F.col(j).setZero();
+					wF.col(j).setZero();
+					distances(j) = 0;
+				}
+				blockAs[block].noalias() += wF * F.transpose();
+				blockBs[block].noalias() -= wF * distances;
+			}
+		}
+	});
+
+	MatrixA A(MatrixA::Zero());
+	VectorB b(VectorB::Zero());
+	for (std::size_t block = 0; block < nbBlocks; ++block)
+	{
+		A += blockAs[block];
+		b += blockBs[block];
+	}
+
+	VectorB x;
+	solvePossiblyUnderdeterminedLinearSystem<T>(A, b, x);
+	return x;
+}
+
 template<typename T>
-typename PointMatcher<T>::TransformationParameters PointToPlaneErrorMinimizer<T>::compute(const ErrorElements& mPts_const)
+typename PointMatcher<T>::TransformationParameters PointToPlaneErrorMinimizer<T>::compute(const ErrorElements& mPts)
 {
-		ErrorElements mPts = mPts_const;
-		return compute_in_place(mPts);
+		return computeTransformation(mPts);
 }
 
 
@@ -174,78 +245,78 @@ typename PointMatcher<T>::TransformationParameters PointToPlaneErrorMinimizer<T>
 		const int dim = mPts.reading.features.rows();
 		const int nbPts = mPts.reading.features.cols();
 
-		// Adjust if the user forces 2D minimization on XY-plane
-		int forcedDim = dim - 1;
+		const TransformationParameters transformation = computeTransformation(mPts);
+
+		// Leave the matched points on the XY-plane if the user forces 2D minimization, for the callers using them
 		if(force2D && dim == 4)
 		{
 				mPts.reading.features.conservativeResize(3, Eigen::NoChange);
 				mPts.reading.features.row(2) = Matrix::Ones(1, nbPts);
 				mPts.reference.features.conservativeResize(3, Eigen::NoChange);
 				mPts.reference.features.row(2) = Matrix::Ones(1, nbPts);
-				forcedDim = dim - 2;
 		}
+		return transformation;
+}
 
-		// Fetch normal vectors of the reference point cloud (with adjustment if needed)
-		const BOOST_AUTO(normalRef, mPts.reference.getDescriptorViewByName("normals").topRows(forcedDim));
 
-		// Note: Normal vector must be precalculated to use this error. Use appropriate input filter.
-		assert(normalRef.rows() > 0);
+template<typename T>
+typename PointMatcher<T>::TransformationParameters PointToPlaneErrorMinimizer<T>::computeTransformation(const ErrorElements& mPts) const
+{
+		typedef Eigen::Matrix<T, 2, 1> Vector2;
+		typedef Eigen::Matrix<T, 3, 1> Vector3;
+		typedef Eigen::Matrix<T, 4, 1> Vector4;
+		typedef Eigen::Matrix<T, 6, 1> Vector6;
 
-		// Compute cross product of cross = cross(reading X normalRef)
-		Matrix cross;
-		Matrix matrixGamma(3,3);
-		if(!force4DOF)
-		{
-			// Compute cross product of cross = cross(reading X normalRef)
-			cross = this->crossProduct(mPts.reading.features, normalRef);
-		}
-		else
-		{
-		   	//VK: Instead for "cross" as in 3D, we need only a dot product with the matrixGamma factor for 4DOF
-		   	//VK: This should be published in 2020 or 2021
-			matrixGamma << 0,-1, 0,
-			         1, 0, 0,
-			         0, 0, 0;
-			cross = ((matrixGamma*mPts.reading.features).transpose()*normalRef).diagonal().transpose();
-		}
+		const int dim = mPts.reading.features.rows();
+		const Matrix& reading = mPts.reading.features;
+		const Matrix& reference = mPts.reference.features;
 
+		// Fetch normal vectors of the reference point cloud
+		const BOOST_AUTO(normalRef, mPts.reference.getDescriptorViewByName("normals"));
 
-		// wF = [weights*cross, weights*normals]
-		// F  = [cross, normals]
-		Matrix wF(normalRef.rows()+ cross.rows(), normalRef.cols());
-		Matrix F(normalRef.rows()+ cross.rows(), normalRef.cols());
+		// Note: Normal vector must be precalculated to use this error. Use appropriate input filter.
+		assert(normalRef.rows() > 0);
 
-		for(int i=0; i < cross.rows(); i++)
+		// Solve for x=[alpha,beta,gamma,x,y,z] in 3D, x=[gamma,x,y,z] in 4DOF
+		// and x=[gamma,x,y] in 2D, forced or not (minimization on the XY-plane)
+		Vector x;
+		if(dim == 3 || force2D)
 		{
-				wF.row(i) = mPts.weights.array() * cross.row(i).array();
-				F.row(i) = cross.row(i);
+			x = solveAccumulatedNormalEquations<T, 3>(mPts.weights, nbThreads, [&](const std::size_t i, Vector3& v) -> T
+			{
+				const Vector2 n = normalRef.col(i).template head<2>();
+				// pseudo cross product cross(reading X normalRef) in 2D
+				v(0) = reading(0, i) * n(1) - reading(1, i) * n(0);
+				v.template tail<2>() = n;
+				return (reading.col(i).template head<2>() - reference.col(i).template head<2>()).dot(n);
+			});
 		}
-		for(int i=0; i < normalRef.rows(); i++)
+		else if(force4DOF)
 		{
-				wF.row(i + cross.rows()) = mPts.weights.array() * normalRef.row(i).array();
-				F.row(i + cross.rows()) = normalRef.row(i);
+			//VK: Instead for "cross" as in 3D, we need only a dot product with the matrixGamma factor for 4DOF
+			//VK: This should be published in 2020 or 2021
+			// matrixGamma * reading = [-y, x, 0]
+			x = solveAccumulatedNormalEquations<T, 4>(mPts.weights, nbThreads, [&](const std::size_t i, Vector4& v) -> T
+			{
+				const Vector3 n = normalRef.col(i).template head<3>();
+				v(0) = reading(0, i) * n(1) - reading(1, i) * n(0);
+				v.template tail<3>() = n;
+				return (reading.col(i).template head<3>() - reference.col(i).template head<3>()).dot(n);
+			});
 		}
-
-		// Unadjust covariance A = wF * F'
-		const Matrix A = wF * F.transpose();
-
-		const Matrix deltas = mPts.reading.features - mPts.reference.features;
-
-		// dot product of dot = dot(deltas, normals)
-		Matrix dotProd = Matrix::Zero(1, normalRef.cols());
-
-		for(int i=0; i<normalRef.rows(); i++)
+		else
 		{
-				dotProd += (deltas.row(i).array() * normalRef.row(i).array()).matrix();
+			x = solveAccumulatedNormalEquations<T, 6>(mPts.weights, nbThreads, [&](const std::size_t i, Vector6& v) -> T
+			{
+				const Vector3 p = reading.col(i).template head<3>();
+				const Vector3 n = normalRef.col(i).template head<3>();
+				// cross product cross(reading X normalRef)
+				v.template head<3>() = p.cross(n);
+				v.template tail<3>() = n;
+				return (p - reference.col(i).template head<3>()).dot(n);
+			});
 		}
 
-		// b = -(wF' * dot)
-		const Vector b = -(wF * dotProd.transpose());
-
-		Vector x(A.rows());
-
-		solvePossiblyUnderdeterminedLinearSystem<T>(A, b, x);
-
 		// Transform parameters to matrix
 		Matrix mOut;
 		if(dim == 4 && !force2D)
@@ -366,6 +437,17 @@ T PointToPlaneErrorMinimizer<T>::getResidualError(
 	return PointToPlaneErrorMinimizer::computeResidualError(mPts, force2D);
 }
 
+//! The reference normals are used by compute(), the sensor noises and densities by getOverlap()
+template<typename T>
+bool PointToPlaneErrorMinimizer<T>::getRequiredDescriptors(StringVector& readingDescriptors, StringVector& referenceDescriptors) const
+{
+	readingDescriptors.push_back("simpleSensorNoise");
+	referenceDescriptors.push_back("normals");
+	referenceDescriptors.push_back("densities");
+	referenceDescriptors.push_back("simpleSensorNoise");
+	return true;
+}
+
 template<typename T>
 T PointToPlaneErrorMinimizer<T>::getOverlap() const
 {
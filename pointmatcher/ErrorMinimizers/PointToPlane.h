@@ -52,6 +52,7 @@ struct PointToPlaneErrorMinimizer: public PointMatcher<T>::ErrorMinimizer
     typedef typename PointMatcher<T>::OutlierWeights OutlierWeights;
     typedef typename PointMatcher<T>::ErrorMinimizer ErrorMinimizer;
     typedef typename PointMatcher<T>::ErrorMinimizer::ErrorElements ErrorElements;
+    typedef typename PointMatcher<T>::ErrorMinimizer::StringVector StringVector;
     typedef typename PointMatcher<T>::TransformationParameters TransformationParameters;
     typedef typename PointMatcher<T>::Vector Vector;
     typedef typename PointMatcher<T>::Matrix Matrix;
@@ -70,13 +71,15 @@ struct PointToPlaneErrorMinimizer: public PointMatcher<T>::ErrorMinimizer
     {
         return {
                 {"force2D", "If set to true(1), the minimization will be forced to give a solution in 2D (i.e., on the XY-plane) even with 3D inputs.", "0", "0", "1", &P::Comp<bool>},
-                {"force4DOF", "If set to true(1), the minimization will optimize only yaw and translation, pitch and roll will follow the prior.", "0", "0", "1", &P::Comp<bool>}
+                {"force4DOF", "If set to true(1), the minimization will optimize only yaw and translation, pitch and roll will follow the prior.", "0", "0", "1", &P::Comp<bool>},
+                {"nbThreads", "number of threads used to accumulate the linear system, each one processing a contiguous chunk of matches. 0: one thread per hardware thread", "1", "0", "2147483647", &P::Comp<unsigned>}
 
         };
     }
 
     const bool force2D;
     const bool force4DOF;
+    const unsigned nbThreads;
 
     PointToPlaneErrorMinimizer(const Parameters& params = Parameters());
     PointToPlaneErrorMinimizer(const ParametersDoc paramsDoc, const Parameters& params);
@@ -85,8 +88,13 @@ struct PointToPlaneErrorMinimizer: public PointMatcher<T>::ErrorMinimizer
 	TransformationParameters compute_in_place(ErrorElements& mPts);
     virtual T getResidualError(const DataPoints& filteredReading, const DataPoints& filteredReference, const OutlierWeights& outlierWeights, const Matches& matches) const;
     virtual T getOverlap() const;
+    virtual bool getRequiredDescriptors(StringVector& readingDescriptors, StringVector& referenceDescriptors) const;
 
     static T computeResidualError(ErrorElements mPts, const bool& force2D);
+
+protected:
+    //! Minimize the point-to-plane error of the matched points, without modifying them
+    TransformationParameters computeTransformation(const ErrorElements& mPts) const;
 };
 
 template<typename T, typename MatrixA, typename Vector>
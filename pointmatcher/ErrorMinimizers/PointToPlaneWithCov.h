@@ -72,6 +72,7 @@ struct PointToPlaneWithCovErrorMinimizer: public PointToPlaneErrorMinimizer<T>
         return {
             {"force2D", "If set to true(1), the minimization will be force to give a solution in 2D (i.e., on the XY-plane) even with 3D inputs.", "0", "0", "1", &P::Comp<bool>},
             {"force4DOF", "If set to true(1), the minimization will optimize only yaw and translation, pitch and roll will follow the prior.", "0", "0", "1", &P::Comp<bool>},
+            {"nbThreads", "number of threads used to accumulate the linear system, each one processing a contiguous chunk of matches. 0: one thread per hardware thread", "1", "0", "2147483647", &P::Comp<unsigned>},
             {"sensorStdDev", "sensor standard deviation", "0.01", "0.", "inf", &P::Comp<T>}
         };
     }
@@ -35,71 +35,188 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ErrorMinimizersImpl.h"
 #include "PointMatcherPrivate.h"
+#include "Parallel.h"
 #include "Eigen/SVD"
 
+#include <vector>
+
 using namespace Eigen;
 
 template<typename T>
-PointToPointErrorMinimizer<T>::PointToPointErrorMinimizer() :
-PointMatcher<T>::ErrorMinimizer("PointToPointErrorMinimizer",
-																ParametersDoc(),
-																Parameters()) {}
+PointToPointErrorMinimizer<T>::PointToPointErrorMinimizer(const Parameters& params) :
+	PointMatcher<T>::ErrorMinimizer("PointToPointErrorMinimizer", availableParameters(), params),
+	nbThreads(Parametrizable::get<unsigned>("nbThreads"))
+{
+}
 
 template<typename T>
 PointToPointErrorMinimizer<T>::PointToPointErrorMinimizer(const std::string& className, const ParametersDoc paramsDoc, const Parameters& params):
-	ErrorMinimizer(className, paramsDoc, params)
+	ErrorMinimizer(className, paramsDoc, params),
+	nbThreads(Parametrizable::get<unsigned>("nbThreads"))
 {
 }
 
 template<typename T>
-typename PointMatcher<T>::TransformationParameters PointToPointErrorMinimizer<T>::compute(const ErrorElements& mPts_const)
+typename PointMatcher<T>::TransformationParameters PointToPointErrorMinimizer<T>::compute(const ErrorElements& mPts)
 {
-	ErrorElements mPts = mPts_const;
-	return compute_in_place(mPts);
+	return computeUmeyama(computeWeightedMoments(mPts, nbThreads), false);
 }
 
 template<typename T>
 typename PointMatcher<T>::TransformationParameters PointToPointErrorMinimizer<T>::compute_in_place(ErrorElements& mPts) {
 	const int dimCount(mPts.reading.features.rows());
-	//const int ptsCount(mPts.reading.features.cols()); //Both point clouds have now the same number of (matched) point
-	
-	
-	const Vector w = mPts.weights.row(0);
-	const T w_sum_inv = T(1.)/w.sum();
-	const Vector meanReading =
-		(mPts.reading.features.topRows(dimCount-1).array().rowwise() * w.array().transpose()).rowwise().sum() * w_sum_inv;
-	const Vector meanReference =
-		(mPts.reference.features.topRows(dimCount-1).array().rowwise() * w.array().transpose()).rowwise().sum() * w_sum_inv;
 	
+	const WeightedMoments moments(computeWeightedMoments(mPts, nbThreads));
 	
-	// Remove the mean from the point clouds
-	mPts.reading.features.topRows(dimCount-1).colwise() -= meanReading;
-	mPts.reference.features.topRows(dimCount-1).colwise() -= meanReference;
+	// Remove the mean from the point clouds, for the callers using them
+	mPts.reading.features.topRows(dimCount-1).colwise() -= moments.meanReading;
+	mPts.reference.features.topRows(dimCount-1).colwise() -= moments.meanReference;
 	
+	return computeUmeyama(moments, false);
+}
+
+//! Sum the matched points in a single pass, for D dimensions (Eigen::Dynamic if not 2 or 3)
+/**
+	Each match adds w * [q; p; 1] * [p; 1]' to a single matrix, holding the
+	sums of w, w*p, w*q, w*q*p' and w*p*p', p and q being the reading and
+	reference points relative to the first match, to limit cancellations.
+	The matches are summed by batches of fixed size, the batches in blocks
+	and the blocks in order, which is a pairwise summation keeping float
+	clouds accurate, and which does not depend on the number of threads.
+*/
+template<typename T, int D>
+typename PointToPointErrorMinimizer<T>::WeightedMoments computeWeightedMomentsInDim(const typename PointMatcher<T>::ErrorMinimizer::ErrorElements& mPts, const unsigned nbThreads)
+{
+	typedef typename PointMatcher<T>::Matrix Matrix;
+	typedef Eigen::Matrix<T, D, 1> VectorD;
+	const int SumRows(D == Eigen::Dynamic ? Eigen::Dynamic : 2 * D + 1);
+	const int SumCols(D == Eigen::Dynamic ? Eigen::Dynamic : D + 1);
+	typedef Eigen::Matrix<T, SumRows, SumCols> Sums;
+	const int batchSize(64);
+
+	const int dim(mPts.reading.features.rows() - 1);
+	const Matrix& reading(mPts.reading.features);
+	const Matrix& reference(mPts.reference.features);
+	const std::size_t nbPts(reading.cols());
+
+	const VectorD readingShift(nbPts > 0 ? VectorD(reading.col(0).head(dim)) : VectorD(VectorD::Zero(dim)));
+	const VectorD referenceShift(nbPts > 0 ? VectorD(reference.col(0).head(dim)) : VectorD(VectorD::Zero(dim)));
+
+	const std::size_t blockSize(4096);
+	const std::size_t nbBlocks((nbPts + blockSize - 1) / blockSize);
+	std::vector<Sums, Eigen::aligned_allocator<Sums>> blockSums(nbBlocks, Sums::Zero(2 * dim + 1, dim + 1));
+	PointMatcherSupport::parallelForChunks(nbBlocks, PointMatcherSupport::getChunkCount(nbBlocks, nbThreads), [&](const unsigned, const std::size_t firstBlock, const std::size_t lastBlock)
+	{
+		// Columns w * [q; p; 1] and [p; 1] of a batch of matches
+		Eigen::Matrix<T, SumRows, batchSize> weightedLeft(2 * dim + 1, int(batchSize));
+		Eigen::Matrix<T, SumCols, batchSize> right(dim + 1, int(batchSize));
+		for (std::size_t block = firstBlock; block < lastBlock; ++block)
+		{
+			const std::size_t end(std::min(nbPts, (block + 1) * blockSize));
+			for (std::size_t batchBegin = block * blockSize; batchBegin < end; batchBegin += batchSize)
+			{
+				const int count(int(std::min<std::size_t>(batchSize, end - batchBegin)));
+				for (int j = 0; j < count; ++j)
+				{
+					const std::size_t i(batchBegin + j);
+					const T w(mPts.weights(0, i));
+					right.col(j).head(dim) = reading.col(i).head(dim) - readingShift;
+					right(dim, j) = 1;
+					weightedLeft.col(j).head(dim) = w * (reference.col(i).head(dim) - referenceShift);
+					weightedLeft.col(j).segment(dim, dim + 1) = w * right.col(j);
+				}
+				// Pad the last batch, so that all products have a fixed size
+				for (int j = count; j < batchSize; ++j)
+				{
+					weightedLeft.col(j).setZero();
+					right.col(j).setZero();
+				}
+				blockSums[block].noalias() += weightedLeft * right.transpose();
+			}
+		}
+	});
+
+	Sums sums(Sums::Zero(2 * dim + 1, dim + 1));
+	for (std::size_t block = 0; block < nbBlocks; ++block)
+		sums += blockSums[block];
+
+	const T weightSum(sums(2 * dim, dim));
+	const VectorD meanReading(sums.row(2 * dim).head(dim).transpose() / weightSum);
+	const VectorD meanReference(sums.col(dim).head(dim) / weightSum);
+
+	// Write through blocks of size D, so that the fixed-size results are not copied with packets larger than them
+	typename PointToPointErrorMinimizer<T>::WeightedMoments moments;
+	moments.meanReading.resize(dim);
+	moments.meanReading.template head<D>(dim) = readingShift + meanReading;
+	moments.meanReference.resize(dim);
+	moments.meanReference.template head<D>(dim) = referenceShift + meanReference;
+	moments.covariance.resize(dim, dim);
+	moments.covariance.template topLeftCorner<D, D>(dim, dim) = sums.template topLeftCorner<D, D>(dim, dim) - weightSum * meanReference * meanReading.transpose();
+	moments.readingVariance = sums.block(dim, 0, dim, dim).trace() - weightSum * meanReading.squaredNorm();
+	return moments;
+}
+
+template<typename T>
+typename PointToPointErrorMinimizer<T>::WeightedMoments PointToPointErrorMinimizer<T>::computeWeightedMoments(const ErrorElements& mPts, const unsigned nbThreads)
+{
+	switch (mPts.reading.features.rows())
+	{
+		case 3: return computeWeightedMomentsInDim<T, 2>(mPts, nbThreads);
+		case 4: return computeWeightedMomentsInDim<T, 3>(mPts, nbThreads);
+		default: return computeWeightedMomentsInDim<T, Eigen::Dynamic>(mPts, nbThreads);
+	}
+}
+
+//! Solve the rotation, and the scale if withScale, by the SVD of the covariance, for D dimensions (Eigen::Dynamic if not 2 or 3)
+template<typename T, int D>
+typename PointMatcher<T>::TransformationParameters computeUmeyamaInDim(const typename PointToPointErrorMinimizer<T>::WeightedMoments& moments, const bool withScale)
+{
+	typedef typename PointMatcher<T>::Matrix Matrix;
+	typedef Eigen::Matrix<T, D, D> MatrixD;
+	typedef Eigen::Matrix<T, D, 1> VectorD;
+
+	const int dim(moments.meanReading.size());
+	const VectorD meanReading(moments.meanReading);
+	const VectorD meanReference(moments.meanReference);
+
 	// Singular Value Decomposition
-	const Matrix m(mPts.reference.features.topRows(dimCount-1) * w.asDiagonal()
-		       * mPts.reading.features.topRows(dimCount-1).transpose());
-	const JacobiSVD<Matrix> svd(m, ComputeThinU | ComputeThinV);
-	Matrix rotMatrix(svd.matrixU() * svd.matrixV().transpose());
+	const JacobiSVD<MatrixD> svd(MatrixD(moments.covariance), ComputeFullU | ComputeFullV);
+	MatrixD rotMatrix(svd.matrixU() * svd.matrixV().transpose());
+	VectorD singularValues(svd.singularValues());
 	// It is possible to get a reflection instead of a rotation. In this case, we
 	// take the second best solution, guaranteed to be a rotation. For more details,
 	// read the tech report: "Least-Squares Rigid Motion Using SVD", Olga Sorkine
 	// http://igl.ethz.ch/projects/ARAP/svd_rot.pdf
 	if (rotMatrix.determinant() < 0.)
 	{
-		Matrix tmpV = svd.matrixV().transpose();
-		tmpV.row(dimCount-2) *= -1.;
+		MatrixD tmpV = svd.matrixV().transpose();
+		tmpV.row(dim-1) *= -1.;
 		rotMatrix = svd.matrixU() * tmpV;
+		singularValues(dim-1) *= -1.;
 	}
-	const Vector trVector(meanReference - rotMatrix * meanReading);
+	T scale(1);
+	if (withScale && moments.readingVariance >= 0.0001)
+		scale = singularValues.sum() / moments.readingVariance;
+	const VectorD trVector(meanReference - scale * rotMatrix * meanReading);
 	
-	Matrix result(Matrix::Identity(dimCount, dimCount));
-	result.topLeftCorner(dimCount-1, dimCount-1) = rotMatrix;
-	result.topRightCorner(dimCount-1, 1) = trVector;
+	Matrix result(Matrix::Identity(dim+1, dim+1));
+	result.template topLeftCorner<D, D>(dim, dim) = scale * rotMatrix;
+	result.template topRightCorner<D, 1>(dim, 1) = trVector;
 	
 	return result;
 }
 
+template<typename T>
+typename PointMatcher<T>::TransformationParameters PointToPointErrorMinimizer<T>::computeUmeyama(const WeightedMoments& moments, const bool withScale)
+{
+	switch (moments.meanReading.size())
+	{
+		case 2: return computeUmeyamaInDim<T, 2>(moments, withScale);
+		case 3: return computeUmeyamaInDim<T, 3>(moments, withScale);
+		default: return computeUmeyamaInDim<T, Eigen::Dynamic>(moments, withScale);
+	}
+}
+
 template<typename T>
 T PointToPointErrorMinimizer<T>::getResidualError(
 	const DataPoints& filteredReading,
@@ -115,6 +232,14 @@ T PointToPointErrorMinimizer<T>::getResidualError(
 	return PointToPointErrorMinimizer::computeResidualError(mPts);
 }
 
+//! Only the sensor noise of the reading is used, by getOverlap()
+template<typename T>
+bool PointToPointErrorMinimizer<T>::getRequiredDescriptors(StringVector& readingDescriptors, StringVector& referenceDescriptors) const
+{
+	readingDescriptors.push_back("simpleSensorNoise");
+	return true;
+}
+
 template<typename T>
 T PointToPointErrorMinimizer<T>::getOverlap() const
 {
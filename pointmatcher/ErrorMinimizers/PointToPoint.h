@@ -42,6 +42,7 @@ template<typename T>
 struct PointToPointErrorMinimizer: PointMatcher<T>::ErrorMinimizer
 {
 	typedef PointMatcherSupport::Parametrizable Parametrizable;
+	typedef PointMatcherSupport::Parametrizable P;
 	typedef Parametrizable::Parameters Parameters;
 	typedef Parametrizable::ParametersDoc ParametersDoc;
 	
@@ -53,21 +54,42 @@ struct PointToPointErrorMinimizer: PointMatcher<T>::ErrorMinimizer
 	typedef typename PointMatcher<T>::Vector Vector;
 	typedef typename PointMatcher<T>::Matrix Matrix;
 	typedef typename PointMatcher<T>::ErrorMinimizer ErrorMinimizer;
+	typedef typename ErrorMinimizer::StringVector StringVector;
 	
 	inline static const std::string description()
 	{
 		return "Point-to-point error. Based on SVD decomposition. Per \\cite{Besl1992Point2Point}.";
 	}
 	
+	inline static const ParametersDoc availableParameters()
+	{
+		return {
+			{"nbThreads", "number of threads used to sum the matched points, each one processing a contiguous chunk of matches. 0: one thread per hardware thread", "1", "0", "2147483647", &P::Comp<unsigned>}
+		};
+	}
+	
+	//! Weighted means of the matched points and their weighted cross-covariance
+	struct WeightedMoments
+	{
+		Vector meanReading; //!< weighted mean of the reading points
+		Vector meanReference; //!< weighted mean of the reference points
+		Matrix covariance; //!< sum of w * (reference - meanReference) * (reading - meanReading)'
+		T readingVariance; //!< sum of w * |reading - meanReading|^2
+	};
+	
+	const unsigned nbThreads;
 	
-	PointToPointErrorMinimizer();
+	PointToPointErrorMinimizer(const Parameters& params = Parameters());
 	PointToPointErrorMinimizer(const std::string& className, const ParametersDoc paramsDoc, const Parameters& params);
 	virtual TransformationParameters compute(const ErrorElements& mPts);
 	TransformationParameters compute_in_place(ErrorElements& mPts);
 	virtual T getResidualError(const DataPoints& filteredReading, const DataPoints& filteredReference, const OutlierWeights& outlierWeights, const Matches& matches) const;
 	virtual T getOverlap() const;
+	virtual bool getRequiredDescriptors(StringVector& readingDescriptors, StringVector& referenceDescriptors) const;
 	
 	static T computeResidualError(const ErrorElements& mPts);
+	static WeightedMoments computeWeightedMoments(const ErrorElements& mPts, const unsigned nbThreads);
+	static TransformationParameters computeUmeyama(const WeightedMoments& moments, const bool withScale);
 };
 
 #endif //LIBPOINTMATCHER_POINTTOPOINT_H
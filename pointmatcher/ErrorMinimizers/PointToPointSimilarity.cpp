@@ -40,61 +40,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 using namespace Eigen;
 
 template<typename T>
-typename PointMatcher<T>::TransformationParameters PointToPointSimilarityErrorMinimizer<T>::compute(const ErrorElements& mPts_const)
+typename PointMatcher<T>::TransformationParameters PointToPointSimilarityErrorMinimizer<T>::compute(const ErrorElements& mPts)
 {
-	
-	// Copy error element to use as storage later
-	// TODO: check that, might worth it to only copy useful parts
-	ErrorElements mPts = mPts_const;
-	
-	// now minimize on kept points
-	const int dimCount(mPts.reading.features.rows());
-	//const int ptsCount(mPts.reading.features.cols()); //Both point clouds have now the same number of (matched) point
-	
-	
-	// Compute the (weighted) mean of each point cloud
-	//TODO: change the member weights to be a Vector
-	const Vector w = mPts.weights.row(0);
-	const T w_sum_inv = T(1.)/w.sum();
-	const Vector meanReading =
-		(mPts.reading.features.topRows(dimCount-1).array().rowwise() * w.array().transpose()).rowwise().sum() * w_sum_inv;
-	const Vector meanReference =
-		(mPts.reference.features.topRows(dimCount-1).array().rowwise() * w.array().transpose()).rowwise().sum() * w_sum_inv;
-	
-	
-	// Remove the mean from the point clouds
-	mPts.reading.features.topRows(dimCount-1).colwise() -= meanReading;
-	mPts.reference.features.topRows(dimCount-1).colwise() -= meanReference;
-	
-	const T sigma = mPts.reading.features.topRows(dimCount-1).colwise().squaredNorm().cwiseProduct(w.transpose()).sum();
-	
-	// Singular Value Decomposition
-	const Matrix m(mPts.reference.features.topRows(dimCount-1) * w.asDiagonal()
-		       * mPts.reading.features.topRows(dimCount-1).transpose());
-	const JacobiSVD<Matrix> svd(m, ComputeThinU | ComputeThinV);
-	Matrix rotMatrix(svd.matrixU() * svd.matrixV().transpose());
-	typedef typename JacobiSVD<Matrix>::SingularValuesType SingularValuesType;
-	SingularValuesType singularValues = svd.singularValues();
-	// It is possible to get a reflection instead of a rotation. In this case, we
-	// take the second best solution, guaranteed to be a rotation. For more details,
-	// read the tech report: "Least-Squares Rigid Motion Using SVD", Olga Sorkine
-	// http://igl.ethz.ch/projects/ARAP/svd_rot.pdf
-	if (rotMatrix.determinant() < 0.)
-	{
-		Matrix tmpV = svd.matrixV().transpose();
-		tmpV.row(dimCount-2) *= -1.;
-		rotMatrix = svd.matrixU() * tmpV;
-		singularValues(dimCount-2) *= -1.;
-	}
-	T scale = singularValues.sum() / sigma;
-	if (sigma < 0.0001) scale = T(1);
-	const Vector trVector(meanReference - scale * rotMatrix * meanReading);
-	
-	Matrix result(Matrix::Identity(dimCount, dimCount));
-	result.topLeftCorner(dimCount-1, dimCount-1) = scale * rotMatrix;
-	result.topRightCorner(dimCount-1, 1) = trVector;
-	
-	return result;
+	// Same weighted means and covariance as the rigid minimization, the scale following from the singular values
+	typedef PointToPointErrorMinimizer<T> PointToPoint;
+	return PointToPoint::computeUmeyama(PointToPoint::computeWeightedMoments(mPts, nbThreads), true);
 }
 
 template<typename T>
@@ -112,6 +62,14 @@ T PointToPointSimilarityErrorMinimizer<T>::getResidualError(
 	return PointToPointErrorMinimizer<T>::computeResidualError(mPts);
 }
 
+//! Only the sensor noise of the reading is used, by getOverlap()
+template<typename T>
+bool PointToPointSimilarityErrorMinimizer<T>::getRequiredDescriptors(StringVector& readingDescriptors, StringVector& referenceDescriptors) const
+{
+	readingDescriptors.push_back("simpleSensorNoise");
+	return true;
+}
+
 template<typename T>
 T PointToPointSimilarityErrorMinimizer<T>::getOverlap() const
 {
@@ -41,6 +41,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 template<typename T>
 struct PointToPointSimilarityErrorMinimizer: PointMatcher<T>::ErrorMinimizer
 {
+	typedef PointMatcherSupport::Parametrizable Parametrizable;
+	typedef PointMatcherSupport::Parametrizable P;
+	typedef Parametrizable::Parameters Parameters;
+	typedef Parametrizable::ParametersDoc ParametersDoc;
+	
 	typedef typename PointMatcher<T>::TransformationParameters TransformationParameters;
 	typedef typename PointMatcher<T>::ErrorMinimizer::ErrorElements ErrorElements;
 	typedef typename PointMatcher<T>::DataPoints DataPoints;
@@ -49,19 +54,31 @@ struct PointToPointSimilarityErrorMinimizer: PointMatcher<T>::ErrorMinimizer
 	typedef typename PointMatcher<T>::Vector Vector;
 	typedef typename PointMatcher<T>::Matrix Matrix;
 	typedef typename PointMatcher<T>::ErrorMinimizer ErrorMinimizer;
+	typedef typename ErrorMinimizer::StringVector StringVector;
 	
 	inline static const std::string description()
 	{
 		return "Point-to-point similarity error (rotation + translation + scale). The scale is the same for all coordinates. Based on SVD decomposition. Per \\cite{Umeyama1991}.";
 	}
 
-	PointToPointSimilarityErrorMinimizer(): ErrorMinimizer("PointToPointSimilarityErrorMinimizer",
-																												 PointMatcherSupport::Parametrizable::ParametersDoc(),
-																												 PointMatcherSupport::Parametrizable::Parameters()) {}
+	inline static const ParametersDoc availableParameters()
+	{
+		return {
+			{"nbThreads", "number of threads used to sum the matched points, each one processing a contiguous chunk of matches. 0: one thread per hardware thread", "1", "0", "2147483647", &P::Comp<unsigned>}
+		};
+	}
+	
+	const unsigned nbThreads;
+	
+	PointToPointSimilarityErrorMinimizer(const Parameters& params = Parameters()): ErrorMinimizer("PointToPointSimilarityErrorMinimizer",
+																												 availableParameters(),
+																												 params),
+		nbThreads(Parametrizable::get<unsigned>("nbThreads")) {}
 	//virtual TransformationParameters compute(const DataPoints& filteredReading, const DataPoints& filteredReference, const OutlierWeights& outlierWeights, const Matches& matches);
 	virtual TransformationParameters compute(const ErrorElements& mPts);
 	virtual T getResidualError(const DataPoints& filteredReading, const DataPoints& filteredReference, const OutlierWeights& outlierWeights, const Matches& matches) const;
 	virtual T getOverlap() const;
+	virtual bool getRequiredDescriptors(StringVector& readingDescriptors, StringVector& referenceDescriptors) const;
 };
 
 
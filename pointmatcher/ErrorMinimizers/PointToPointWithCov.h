@@ -64,7 +64,8 @@ struct PointToPointWithCovErrorMinimizer: public PointToPointErrorMinimizer<T>
 	inline static const ParametersDoc availableParameters()
 	{
 		return {
-			{"sensorStdDev", "sensor standard deviation", "0.01", "0.", "inf", &P::Comp<T>}
+			{"sensorStdDev", "sensor standard deviation", "0.01", "0.", "inf", &P::Comp<T>},
+			{"nbThreads", "number of threads used to sum the matched points, each one processing a contiguous chunk of matches. 0: one thread per hardware thread", "1", "0", "2147483647", &P::Comp<unsigned>}
 		};
 	}
 	
@@ -40,6 +40,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <iomanip>
 #include <limits>
 #include <algorithm>
+#include <cmath>
 #include <boost/format.hpp>
 
 namespace PointMatcherSupport
@@ -48,11 +49,20 @@ namespace PointMatcherSupport
 	
 	template<typename T>
 	Histogram<T>::Histogram(const size_t binCount, const std::string& name, const std::string& 
-		filePrefix, const bool dumpStdErrOnExit):
+		filePrefix, const bool dumpStdErrOnExit, const bool streaming, const double relativeError):
 		binCount(binCount),
 		name(name),
 		filePrefix(filePrefix),
-		dumpStdErrOnExit(dumpStdErrOnExit)
+		dumpStdErrOnExit(dumpStdErrOnExit),
+		streaming(streaming),
+		relativeError(relativeError),
+		logGamma(std::log((1 + relativeError) / (1 - relativeError))),
+		streamCount(0),
+		streamMean(0),
+		streamM2(0),
+		streamMin(0),
+		streamMax(0),
+		zeroCount(0)
 	{
 	}
 	
@@ -74,10 +84,14 @@ namespace PointMatcherSupport
 			ofs_stats << endl;
 			dumpStats(ofs_stats);
 
-			std::cerr << "writing to " << (filePrefix + name + ".csv") << std::endl;
-			std::ofstream ofs((filePrefix + name + ".csv").c_str());
-			for (size_t i = 0; i < this->size(); ++i)
-				ofs << ((*this)[i]) << "\n";
+			// samples are not kept in streaming mode
+			if (!streaming)
+			{
+				std::cerr << "writing to " << (filePrefix + name + ".csv") << std::endl;
+				std::ofstream ofs((filePrefix + name + ".csv").c_str());
+				for (size_t i = 0; i < this->size(); ++i)
+					ofs << ((*this)[i]) << "\n";
+			}
 		}
 		
 		if (dumpStdErrOnExit)
@@ -86,8 +100,8 @@ namespace PointMatcherSupport
 			std::cerr.fill(' ');
 			std::cerr.flags(std::ios::left);
 			std::cerr << "Histogram " << name << ":\n";
-			std::cerr << "  count: " << this->size() << ", mean: " << meanV << ", var: " << varV << ", median: " << medianV << ", min: " << minV << ", max: " << maxV << ", lowQt: " << lowQt << ", highQt: " << highQt << ", maxBinC: " << maxBinC << "\n";
-			if(this->size() > 1)
+			std::cerr << "  count: " << sampleCount() << ", mean: " << meanV << ", var: " << varV << ", median: " << medianV << ", min: " << minV << ", max: " << maxV << ", lowQt: " << lowQt << ", highQt: " << highQt << ", maxBinC: " << maxBinC << "\n";
+			if(sampleCount() > 1)
 			{
 				for (size_t i = 0; i < binCount; ++i)
 				{
@@ -105,12 +119,130 @@ namespace PointMatcherSupport
 		}
 	}
 	
+	template<typename T>
+	void Histogram<T>::addSample(const T v)
+	{
+		if (!streaming)
+		{
+			this->push_back(v);
+			return;
+		}
+		
+		if (streamCount == 0)
+		{
+			streamMin = v;
+			streamMax = v;
+		}
+		else
+		{
+			streamMin = std::min<T>(streamMin, v);
+			streamMax = std::max<T>(streamMax, v);
+		}
+		++streamCount;
+		const double value(v);
+		const double delta(value - streamMean);
+		streamMean += delta / double(streamCount);
+		streamM2 += delta * (value - streamMean);
+		
+		if (value == 0)
+		{
+			++zeroCount;
+			return;
+		}
+		Buckets& buckets(value > 0 ? positiveBuckets : negativeBuckets);
+		++buckets[int(std::ceil(std::log(std::fabs(value)) / logGamma))];
+		
+		// bound memory by merging the two buckets of smallest magnitude
+		if (positiveBuckets.size() + negativeBuckets.size() > maxBucketCount)
+		{
+			Buckets& smallest(positiveBuckets.size() >= 2 ? positiveBuckets : negativeBuckets);
+			const typename Buckets::iterator first(smallest.begin());
+			typename Buckets::iterator second(first);
+			++second;
+			second->second += first->second;
+			smallest.erase(first);
+		}
+	}
+	
+	template<typename T>
+	uint64_t Histogram<T>::sampleCount() const
+	{
+		return streaming ? streamCount : this->size();
+	}
+	
+	//! Return the value representing a bucket, within relativeError of all the magnitudes it holds
+	template<typename T>
+	double Histogram<T>::bucketValue(const int bucket) const
+	{
+		return 2 * std::exp(bucket * logGamma) / (1 + std::exp(logGamma));
+	}
+	
+	//! Return the value of the sample of a given rank, in ascending order, from the sketch
+	template<typename T>
+	T Histogram<T>::sketchValueAtRank(const uint64_t rank) const
+	{
+		double value(streamMax);
+		uint64_t count(0);
+		for (typename Buckets::const_reverse_iterator it = negativeBuckets.rbegin(); it != negativeBuckets.rend() && count <= rank; ++it)
+		{
+			count += it->second;
+			value = -bucketValue(it->first);
+		}
+		if (count <= rank)
+		{
+			count += zeroCount;
+			value = 0;
+		}
+		for (typename Buckets::const_iterator it = positiveBuckets.begin(); it != positiveBuckets.end() && count <= rank; ++it)
+		{
+			count += it->second;
+			value = bucketValue(it->first);
+		}
+		return T(std::min<double>(std::max<double>(value, streamMin), streamMax));
+	}
+	
 	template<typename T>
 	vector<uint64_t> Histogram<T>::computeStats(T& meanV, T& varV, T& medianV, T& lowQt, T& highQt, T& minV, T& maxV, uint64_t& maxBinC)
 	{
 		typedef typename std::vector<T>::iterator Iterator;
 		vector<uint64_t> bins(binCount, 0);
 		
+		if (streaming && streamCount > 0)
+		{
+			meanV = T(streamMean);
+			varV = T(streamM2 / double(streamCount));
+			minV = streamMin;
+			maxV = streamMax;
+			maxBinC = 0;
+			if (minV == maxV)
+			{
+				medianV = lowQt = highQt = minV;
+				return bins;
+			}
+			
+			// hist from the values of the buckets
+			const double range((double(maxV) - double(minV)) * (1+std::numeric_limits<T>::epsilon()*10));
+			const auto addToBins = [&](const double v, const uint64_t count)
+			{
+				const double clamped(std::min<double>(std::max<double>(v, minV), maxV));
+				const size_t index(std::min<size_t>(binCount - 1, size_t((clamped - double(minV)) * binCount / range)));
+				bins[index] += count;
+				maxBinC = std::max<uint64_t>(maxBinC, bins[index]);
+			};
+			for (typename Buckets::const_iterator it = negativeBuckets.begin(); it != negativeBuckets.end(); ++it)
+				addToBins(-bucketValue(it->first), it->second);
+			if (zeroCount > 0)
+				addToBins(0, zeroCount);
+			for (typename Buckets::const_iterator it = positiveBuckets.begin(); it != positiveBuckets.end(); ++it)
+				addToBins(bucketValue(it->first), it->second);
+			
+			// median
+			medianV = sketchValueAtRank(streamCount / 2);
+			lowQt = sketchValueAtRank(streamCount / 4);
+			highQt = sketchValueAtRank(3*streamCount / 4);
+			return bins;
+		}
+		
 		//assert(this->size() > 0);
 		if(this->size() > 0)
 		{
@@ -176,7 +308,7 @@ namespace PointMatcherSupport
 		T meanV, varV, medianV, lowQt, highQt, minV, maxV;
 		uint64_t maxBinC;
 		const vector<uint64_t> bins(computeStats(meanV, varV, medianV, lowQt, highQt, minV, maxV, maxBinC));
-		os << this->size() << ", " << meanV << ", " << varV << ", " << medianV << ", " << lowQt << ", " << highQt << ", " << minV << ", " << maxV << ", " << binCount << ", ";
+		os << sampleCount() << ", " << meanV << ", " << varV << ", " << medianV << ", " << lowQt << ", " << highQt << ", " << minV << ", " << maxV << ", " << binCount << ", ";
 		
 		for (size_t i = 0; i < binCount; ++i)
 			os << bins[i] << ", ";
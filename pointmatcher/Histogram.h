@@ -36,12 +36,19 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef __POINTMATCHER_HISTOGRAM_H
 #define __POINTMATCHER_HISTOGRAM_H
 
+#include <map>
 #include <vector>
 #include <string>
 #include <stdint.h>
 
 namespace PointMatcherSupport
 {
+	//! Statistics over samples, either stored or, in streaming mode, summarized in bounded memory
+	/**
+		In streaming mode, count, mean, variance, min and max are exact.
+		Median, quartiles and bins are read from a sketch of log-spaced buckets,
+		each value being known within relativeError of its magnitude.
+	*/
 	template<typename T>
 	struct Histogram: public std::vector<T>
 	{
@@ -49,17 +56,43 @@ namespace PointMatcherSupport
 		const std::string name;
 		const std::string filePrefix;
 		const bool dumpStdErrOnExit;
+		const bool streaming; //!< if true, samples are summarized instead of being stored
+		const double relativeError; //!< relative error of quantiles in streaming mode
 		
 		Histogram(const size_t binCount, const std::string& name, const std::string& 
-		filePrefix, const bool dumpStdErrOnExit);
+		filePrefix, const bool dumpStdErrOnExit, const bool streaming = false, const double relativeError = 0.01);
 		
 		virtual ~Histogram();
 		
+		//! Add a sample, stored or summarized depending on streaming
+		void addSample(const T v);
+		//! Return the number of samples added
+		uint64_t sampleCount() const;
+		
 		//! This function compute statistics and writes them into the variables passed as reference
 		std::vector<uint64_t> computeStats(T& meanV, T& varV, T& medianV, T& lowQt, T& highQt, T& minV, T& maxV, uint64_t& maxBinC);
 		
 		void dumpStats(std::ostream& os);
 		void dumpStatsHeader(std::ostream& os) const;
+		
+	protected:
+		typedef std::map<int, uint64_t> Buckets; //!< sample counts by bucket, bucket i holding magnitudes in (gamma^(i-1), gamma^i]
+		
+		//! Maximum number of sketch buckets, the ones of the smallest magnitudes being merged beyond
+		static const size_t maxBucketCount = 2048;
+		
+		double bucketValue(const int bucket) const;
+		T sketchValueAtRank(const uint64_t rank) const;
+		
+		const double logGamma; //!< log of the ratio between the bounds of a bucket
+		uint64_t streamCount;
+		double streamMean;
+		double streamM2; //!< sum of squared deviations to the mean, updated with Welford's algorithm
+		T streamMin;
+		T streamMax;
+		Buckets positiveBuckets; //!< buckets of positive samples
+		Buckets negativeBuckets; //!< buckets of the magnitudes of negative samples
+		uint64_t zeroCount;
 	};
 } // namespace PointMatcherSupport
 
@@ -130,8 +130,9 @@ void PointMatcher<T>::ICPChainBase::loadFromYaml(std::istream& in)
 
 	{
 		// NOTE: The logger needs to be initialize first to allow ouput from other contructors
-		boost::mutex::scoped_lock lock(loggerMutex);
-		usedModuleTypes.insert(createModuleFromRegistrar("logger", doc, pm.REG(Logger), logger));
+		std::shared_ptr<Logger> newLogger;
+		usedModuleTypes.insert(createModuleFromRegistrar("logger", doc, pm.REG(Logger), newLogger));
+		setLogger(newLogger);
 	}
 	usedModuleTypes.insert(createModulesFromRegistrar("readingDataPointsFilters", doc, pm.REG(DataPointsFilter), readingDataPointsFilters));
 	usedModuleTypes.insert(createModulesFromRegistrar("readingStepDataPointsFilters", doc, pm.REG(DataPointsFilter), readingStepDataPointsFilters));
@@ -239,6 +240,18 @@ template struct PointMatcher<float>::ICPChainBase;
 template struct PointMatcher<double>::ICPChainBase;
 
 
+//! Constructor, the buffers are not reused by default
+template<typename T>
+PointMatcher<T>::ICP::ICP():
+	reuseBuffers(false)
+{}
+
+//! Constructor, the reference is empty until filled by ICP::prepareReference()
+template<typename T>
+PointMatcher<T>::ICP::PreparedReference::PreparedReference():
+	referenceInPtsCount(0)
+{}
+
 //! Perform ICP and return optimised transformation matrix
 template<typename T>
 typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::operator ()(
@@ -277,6 +290,7 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::compute
 	
 	this->inspector->init();
 	
+	Trace::ScopedTimer computeScope("ICP::compute", "ICP");
 	timer t; // Print how long take the algo
 	const int dim(referenceIn.features.rows());
 	
@@ -299,7 +313,10 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::compute
 	reference.features.topRows(dim-1).colwise() -= meanReference.head(dim-1);
 	
 	// Init matcher with reference points center on its mean
-	this->matcher->init(reference);
+	{
+		Trace::ScopedTimer matcherScope(this->matcher->className, "Matcher::init");
+		this->matcher->init(reference);
+	}
 	
 	// statistics on last step
 	this->inspector->addStat("ReferencePreprocessingDuration", t.elapsed());
@@ -312,6 +329,106 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::compute
 	
 }
 
+//! Filter, center and index referenceIn once, so that many readings can be registered against it
+/**
+	The reference filters of this ICP are applied, and a new matcher of the same type and with the same parameters as this->matcher is initialized with the result.
+*/
+template<typename T>
+std::shared_ptr<typename PointMatcher<T>::ICP::PreparedReference> PointMatcher<T>::ICP::prepareReference(
+	const DataPoints& referenceIn)
+{
+	// Ensuring minimum definition of components
+	if (!this->matcher)
+		throw runtime_error("You must setup a matcher before preparing a reference");
+	
+	Trace::ScopedTimer prepareScope("ICP::prepareReference", "ICP");
+	timer t; // Print how long take the algo
+	const int dim(referenceIn.features.rows());
+	
+	std::shared_ptr<PreparedReference> prepared(new PreparedReference);
+	prepared->referenceInPtsCount = referenceIn.features.cols();
+	
+	// Apply reference filters
+	// reference is express in frame <refIn>
+	DataPoints& reference(prepared->reference);
+	reference = referenceIn;
+	this->referenceDataPointsFilters.init();
+	this->referenceDataPointsFilters.apply(reference);
+	
+	// Create intermediate frame at the center of mass of reference pts cloud
+	const int nbPtsReference = reference.features.cols();
+	const Vector meanReference = reference.features.rowwise().sum() / nbPtsReference;
+	prepared->T_refIn_refMean = Matrix::Identity(dim, dim);
+	prepared->T_refIn_refMean.block(0,dim-1, dim-1, 1) = meanReference.head(dim-1);
+	
+	// Reajust reference position: 
+	// from here reference is express in frame <refMean>
+	reference.features.topRows(dim-1).colwise() -= meanReference.head(dim-1);
+	
+	// Init a matcher of its own, as this->matcher is re-initialized by every other call to compute()
+	prepared->matcher = PointMatcher<T>::get().MatcherRegistrar.create(this->matcher->className, this->matcher->parameters);
+	{
+		Trace::ScopedTimer matcherScope(prepared->matcher->className, "Matcher::init");
+		prepared->matcher->init(reference);
+	}
+	
+	LOG_INFO_STREAM("PointMatcher::icp - reference preparation took " << t.elapsed() << " [s]");
+	
+	return prepared;
+}
+
+//! Perform ICP against a prepared reference and return optimised transformation matrix
+template<typename T>
+typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::operator ()(
+	const DataPoints& readingIn,
+	const PreparedReference& reference)
+{
+	const int dim = readingIn.features.rows();
+	const TransformationParameters identity = TransformationParameters::Identity(dim, dim);
+	return this->compute(readingIn, reference, identity);
+}
+
+//! Perform ICP against a prepared reference from initial guess and return optimised transformation matrix
+template<typename T>
+typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::operator ()(
+	const DataPoints& readingIn,
+	const PreparedReference& reference,
+	const TransformationParameters& initialTransformationParameters)
+{
+	return this->compute(readingIn, reference, initialTransformationParameters);
+}
+
+//! Perform ICP against a prepared reference from initial guess and return optimised transformation matrix
+/**
+	Neither the reference filters nor the matcher of this ICP are used, those of the ICP that prepared the reference were.
+*/
+template<typename T>
+typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::compute(
+	const DataPoints& readingIn,
+	const PreparedReference& reference,
+	const TransformationParameters& T_refIn_dataIn)
+{
+	// Ensuring minimum definition of components
+	if (!reference.matcher)
+		throw runtime_error("You must prepare the reference before running ICP against it");
+	if (!this->errorMinimizer)
+		throw runtime_error("You must setup an error minimizer before running ICP");
+	if (!this->inspector)
+		throw runtime_error("You must setup an inspector before running ICP");
+	
+	this->inspector->init();
+	
+	Trace::ScopedTimer computeScope("ICP::compute", "ICP");
+	
+	// statistics on last step, the reference was already processed
+	this->inspector->addStat("ReferencePreprocessingDuration", 0);
+	this->inspector->addStat("ReferenceInPointCount", reference.referenceInPtsCount);
+	this->inspector->addStat("ReferencePointCount", reference.reference.features.cols());
+	this->prefilteredReferencePtsCount = reference.reference.features.cols();
+	
+	return computeWithTransformedReference(readingIn, reference.reference, *reference.matcher, reference.T_refIn_refMean, T_refIn_dataIn);
+}
+
 //! Perferm ICP using an already-transformed reference and with an already-initialized matcher
 template<typename T>
 typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::computeWithTransformedReference(
@@ -319,6 +436,18 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::compute
 	const DataPoints& reference, 
 	const TransformationParameters& T_refIn_refMean,
 	const TransformationParameters& T_refIn_dataIn)
+{
+	return computeWithTransformedReference(readingIn, reference, *this->matcher, T_refIn_refMean, T_refIn_dataIn);
+}
+
+//! Perferm ICP using an already-transformed reference and matcher, already initialized with this reference
+template<typename T>
+typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::computeWithTransformedReference(
+	const DataPoints& readingIn, 
+	const DataPoints& reference, 
+	Matcher& matcher,
+	const TransformationParameters& T_refIn_refMean,
+	const TransformationParameters& T_refIn_dataIn)
 {
 	const int dim(reference.features.rows());
 
@@ -330,21 +459,35 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::compute
 											  "Where N is the number of rows in the read/reference scans.");
 	}
 
+	Trace::ScopedTimer computeScope("ICP::computeWithTransformedReference", "ICP");
 	timer t; // Print how long take the algo
 	
 	// Apply readings filters
 	// reading is express in frame <dataIn>
-	DataPoints reading(readingIn);
-	//const int nbPtsReading = reading.features.cols();
-	this->readingDataPointsFilters.init();
-	this->readingDataPointsFilters.apply(reading);
-	readingFiltered = reading;
-
-	// Reajust reading position: 
-	// from here reading is express in frame <refMean>
 	TransformationParameters 
 		T_refMean_dataIn = T_refIn_refMean.inverse() * T_refIn_dataIn;
-	this->transformations.apply(reading, T_refMean_dataIn);
+	DataPoints localReading;
+	DataPoints& reading(reuseBuffers ? readingBuffer : localReading);
+	this->readingDataPointsFilters.init();
+	if (reuseBuffers)
+	{
+		// Filter in the storage of readingFiltered, then move the result
+		// to frame <refMean> into the storage of reading
+		readingFiltered = readingIn;
+		this->readingDataPointsFilters.apply(readingFiltered);
+		this->transformations.apply(readingFiltered, T_refMean_dataIn, reading);
+	}
+	else
+	{
+		reading = readingIn;
+		//const int nbPtsReading = reading.features.cols();
+		this->readingDataPointsFilters.apply(reading);
+		readingFiltered = reading;
+
+		// Reajust reading position: 
+		// from here reading is express in frame <refMean>
+		this->transformations.apply(reading, T_refMean_dataIn);
+	}
 	
 	// Prepare reading filters used in the loop 
 	this->readingStepDataPointsFilters.init();
@@ -370,21 +513,46 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::compute
 	// iterations
 	while (iterate)
 	{
-		DataPoints stepReading(reading);
+		Trace::ScopedTimer iterationScope("Iteration", "ICP");
+		DataPoints localStepReading;
+		DataPoints& stepReading(reuseBuffers ? transformedReadingBuffer : localStepReading);
 		
-		//-----------------------------
-		// Apply step filter
-		this->readingStepDataPointsFilters.apply(stepReading);
-		
-		//-----------------------------
-		// Transform Readings
-		this->transformations.apply(stepReading, T_iter);
+		if (reuseBuffers)
+		{
+			//-----------------------------
+			// Apply step filter, if any, in its own buffer
+			const DataPoints* stepInput(&reading);
+			if (!this->readingStepDataPointsFilters.empty())
+			{
+				stepReadingBuffer = reading;
+				this->readingStepDataPointsFilters.apply(stepReadingBuffer);
+				stepInput = &stepReadingBuffer;
+			}
+			
+			//-----------------------------
+			// Transform Readings directly into the buffer
+			this->transformations.apply(*stepInput, T_iter, stepReading);
+		}
+		else
+		{
+			stepReading = reading;
+			
+			//-----------------------------
+			// Apply step filter
+			this->readingStepDataPointsFilters.apply(stepReading);
+			
+			//-----------------------------
+			// Transform Readings
+			this->transformations.apply(stepReading, T_iter);
+		}
 		
 		//-----------------------------
 		// Match to closest point in Reference
-		const Matches matches(
-			this->matcher->findClosests(stepReading)
-		);
+		Matches matches;
+		{
+			Trace::ScopedTimer matcherScope(matcher.className, "Matcher::findClosests");
+			matches = matcher.findClosests(stepReading);
+		}
 		
 		//-----------------------------
 		// Detect outliers
@@ -408,8 +576,15 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::compute
 		// Error minimization
 		// equivalent to: 
 		//   T_iter(i+1)_iter(0) = T_iter(i+1)_iter(i) * T_iter(i)_iter(0)
-		T_iter = this->errorMinimizer->compute(
-			stepReading, reference, outlierWeights, matches) * T_iter;
+		{
+			Trace::ScopedTimer minimizerScope(this->errorMinimizer->className, "ErrorMinimizer::compute");
+			if (reuseBuffers)
+				T_iter = this->errorMinimizer->computeReusingBuffers(
+					stepReading, reference, outlierWeights, matches) * T_iter;
+			else
+				T_iter = this->errorMinimizer->compute(
+					stepReading, reference, outlierWeights, matches) * T_iter;
+		}
 		
 		// Old version
 		//T_iter = T_iter * this->errorMinimizer->compute(
@@ -430,8 +605,8 @@ typename PointMatcher<T>::TransformationParameters PointMatcher<T>::ICP::compute
 	}
 	
 	this->inspector->addStat("IterationsCount", iterationCount);
-	this->inspector->addStat("PointCountTouched", this->matcher->getVisitCount());
-	this->matcher->resetVisitCount();
+	this->inspector->addStat("PointCountTouched", matcher.getVisitCount());
+	matcher.resetVisitCount();
 	this->inspector->addStat("OverlapRatio", this->errorMinimizer->getWeightedPointUsedRatio());
 	this->inspector->addStat("ConvergenceDuration", t.elapsed());
 	this->inspector->finish(iterationCount);
@@ -507,6 +682,110 @@ bool PointMatcher<T>::ICPSequence::setMap(const DataPoints& inputCloud)
 	return true;
 }
 
+//! Insert newPoints, expressed in the global frame, into the map without processing the whole map again
+/**
+	The reference filters are applied to newPoints only, and the matcher indexes them in a time proportional to their number if it supports it.
+	The map keeps its current center, so the existing points are not moved.
+	If there is no map yet, this is equivalent to setMap().
+*/
+template<typename T>
+bool PointMatcher<T>::ICPSequence::insertPoints(const DataPoints& newPoints)
+{
+	if (!hasMap())
+		return setMap(newPoints);
+	
+	// Ensuring minimum definition of components
+	if (!this->matcher)
+		throw runtime_error("You must setup a matcher before running ICP");
+	if (!this->inspector)
+		throw runtime_error("You must setup an inspector before running ICP");
+	
+	timer t; // Print how long take the algo
+	const int dim(mapPointCloud.features.rows());
+	if (newPoints.features.rows() != dim)
+		throw runtime_error("The points to insert must have the same dimension as the map");
+	
+	// Express the new points in frame <refMean>
+	DataPoints insertedPoints(newPoints);
+	const Vector meanMap(T_refIn_refMean.block(0,dim-1, dim-1, 1));
+	insertedPoints.features.topRows(dim-1).colwise() -= meanMap;
+	
+	// Apply reference filters
+	this->referenceDataPointsFilters.init();
+	this->referenceDataPointsFilters.apply(insertedPoints);
+	
+	if (insertedPoints.features.cols() == 0)
+	{
+		LOG_WARNING_STREAM("Ignoring attempt to insert an empty cloud in the map");
+		return false;
+	}
+	
+	const int firstNewPoint(mapPointCloud.features.cols());
+	mapPointCloud.concatenate(insertedPoints);
+	this->matcher->appendToReference(mapPointCloud, firstNewPoint);
+	
+	this->inspector->addStat("MapPointCount", mapPointCloud.features.cols());
+	this->inspector->addStat("InsertPointsDuration", t.elapsed());
+	
+	return true;
+}
+
+//! Remove the points of the map inside the axis-aligned box from minCorner to maxCorner, expressed in the global frame, and return how many were removed
+template<typename T>
+unsigned PointMatcher<T>::ICPSequence::removePoints(const Vector& minCorner, const Vector& maxCorner)
+{
+	if (!hasMap())
+		return 0;
+	
+	// Ensuring minimum definition of components
+	if (!this->matcher)
+		throw runtime_error("You must setup a matcher before running ICP");
+	if (!this->inspector)
+		throw runtime_error("You must setup an inspector before running ICP");
+	
+	timer t; // Print how long take the algo
+	const int dim(mapPointCloud.features.rows());
+	if (minCorner.size() != dim-1 || maxCorner.size() != dim-1)
+		throw runtime_error("The corners of the box must have the dimension of the map, without the homogeneous coordinate");
+	
+	// Express the box in frame <refMean>
+	const Vector meanMap(T_refIn_refMean.block(0,dim-1, dim-1, 1));
+	const Vector boxMin(minCorner - meanMap);
+	const Vector boxMax(maxCorner - meanMap);
+	
+	const int nbPointsIn(mapPointCloud.features.cols());
+	std::vector<bool> keptPoints(nbPointsIn);
+	int j = 0;
+	for (int i = 0; i < nbPointsIn; ++i)
+	{
+		const BOOST_AUTO(point, mapPointCloud.features.col(i).head(dim-1));
+		keptPoints[i] = !((point.array() >= boxMin.array()).all() && (point.array() <= boxMax.array()).all());
+		if (keptPoints[i])
+		{
+			mapPointCloud.setColFrom(j, mapPointCloud, i);
+			++j;
+		}
+	}
+	
+	const unsigned removedCount(nbPointsIn - j);
+	if (removedCount == 0)
+		return 0;
+	
+	if (j == 0)
+	{
+		clearMap();
+		return removedCount;
+	}
+	
+	mapPointCloud.conservativeResize(j);
+	this->matcher->removeFromReference(mapPointCloud, keptPoints);
+	
+	this->inspector->addStat("MapPointCount", mapPointCloud.features.cols());
+	this->inspector->addStat("RemovePointsDuration", t.elapsed());
+	
+	return removedCount;
+}
+
 //! Clear the map (reset to same state as after the object is created)
 template<typename T>
 void PointMatcher<T>::ICPSequence::clearMap()
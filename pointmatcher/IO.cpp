@@ -36,13 +36,19 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "IO.h"
 #include "IOFunctions.h"
 #include "InspectorsImpl.h"
+#include "Parallel.h"
 
 // For logging
 #include "PointMatcherPrivate.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <iostream>
+#include <iterator>
 #include <fstream>
 #include <stdexcept>
+#include <vector>
 #include <ctype.h>
 #include "boost/algorithm/string.hpp"
 #include "boost/filesystem.hpp"
@@ -384,8 +390,10 @@ typename PointMatcher<T>::DataPoints PointMatcher<T>::DataPoints::load(const std
 		return PointMatcherIO<T>::loadPLY(fileName);
 	else if (boost::iequals(ext, ".pcd"))
 		return PointMatcherIO<T>::loadPCD(fileName);
+	else if (boost::iequals(ext, ".pmb"))
+		return PointMatcherIO<T>::loadPMB(fileName);
 	else
-		throw runtime_error("loadAnyFormat(): Unknown extension \"" + ext + "\" for file \"" + fileName + "\", extension must be either \".vtk\" or \".csv\"");
+		throw runtime_error("loadAnyFormat(): Unknown extension \"" + ext + "\" for file \"" + fileName + "\", extension must be either \".vtk\", \".csv\", \".ply\", \".pcd\" or \".pmb\"");
 }
 
 template
@@ -396,6 +404,7 @@ PointMatcher<double>::DataPoints PointMatcher<double>::DataPoints::load(const st
 
 //! @brief Load comma separated values (csv) file
 //! @param fileName a string containing the path and the file name
+//! @param nbThreads number of threads parsing the lines, 0: one thread per hardware thread
 //! 
 //! This loader has 3 behaviors since there is no official standard for
 //! csv files. A 2D or 3D point cloud will be created automatically if:
@@ -405,13 +414,13 @@ PointMatcher<double>::DataPoints PointMatcher<double>::DataPoints::load(const st
 //! Otherwise, the user is asked to enter column id manually which might 
 //! block automatic processing.
 template<typename T>
-typename PointMatcher<T>::DataPoints PointMatcherIO<T>::loadCSV(const std::string& fileName)
+typename PointMatcher<T>::DataPoints PointMatcherIO<T>::loadCSV(const std::string& fileName, const unsigned nbThreads)
 {
 	ifstream ifs(fileName.c_str());
 	
 	validateFile(fileName);
 
-	return loadCSV(ifs);
+	return loadCSV(ifs, nbThreads);
 }
 
 template<typename T>
@@ -529,250 +538,424 @@ std::string PointMatcherIO<T>::getColLabel(const Label& label, const int row)
 }
 
 
-//! @brief Load comma separated values (csv) file
-//! @see loadCSV()
+//! Parse the first line of a CSV file, which is either a text header or
+//! the first line of data, into csvHeader and the labels of every column.
+//! Return whether the line is a text header.
 template<typename T>
-typename PointMatcher<T>::DataPoints PointMatcherIO<T>::loadCSV(std::istream& is)
+bool PointMatcherIO<T>::parseCSVHeader(const std::string& line, std::vector<GenericInputHeader>& csvHeader, LabelGenerator& featLabelGen, LabelGenerator& descLabelGen, LabelGenerator& timeLabelGen)
 {
-	vector<GenericInputHeader> csvHeader;
-	LabelGenerator featLabelGen, descLabelGen, timeLabelGen;
-	Matrix features;
-	Matrix descriptors;
-	Int64Matrix times;
-	unsigned int csvCol = 0;
-	unsigned int csvRow = 0;
-	bool hasHeader(false);
-	bool firstLine(true);
-	
-
-	//count lines in the file
-	is.unsetf(std::ios_base::skipws);
-	unsigned int line_count = std::count(
-	        std::istream_iterator<char>(is),
-			std::istream_iterator<char>(), 
-			'\n');
-	//reset the stream
-	is.clear();
-	is.seekg(0, ios::beg);
+	// Look for text header
+	const unsigned int len = strspn(line.c_str(), " ,+-.1234567890Ee");
+	const bool hasHeader(len != line.length());
+
+	// Count dimension using first line
+	const char delimiters[] = " \t,;";
+	unsigned int dim = 0;
+	std::vector<char> tmpLine(line.c_str(), line.c_str() + line.size() + 1);
+	char *brkt = 0;
+	char *token = strtok_r(tmpLine.data(), delimiters, &brkt);
 
-	char delimiters[] = " \t,;";
-	char *token;
-	string line;
-	while (safeGetLine(is, line))
+	//1- BUILD HEADER
+	while (token)
 	{
-		
-		// Skip empty lines
-		if(line.empty())
-			break;
-	
-		// Look for text header
-		unsigned int len = strspn(line.c_str(), " ,+-.1234567890Ee");
-		if(len != line.length())
+		// Load text header
+		if(hasHeader)
 		{
-			//cout << "Header detected" << endl;
-			hasHeader = true;
+			csvHeader.push_back(GenericInputHeader(string(token)));
 		}
-		else
+		dim++;
+		token = strtok_r(NULL, delimiters, &brkt);
+	}
+	
+	if (!hasHeader)
+	{
+		// Check if it is a simple file with only coordinates
+		if (!(dim == 2 || dim == 3))
 		{
-			hasHeader = false;
-		}
+			int idX=0, idY=0, idZ=0;
 
-		// Count dimension using first line
-		if(firstLine)
-		{
-			unsigned int dim = 0;
-			char tmpLine[1024]; //FIXME: might be problematic for large file
-			strcpy(tmpLine, line.c_str());
-			char *brkt = 0;
-			token = strtok_r(tmpLine, delimiters, &brkt);
+			cout << "WARNING: " << dim << " columns detected. Not obvious which columns to load for x, y or z." << endl;
+			cout << endl << "Enter column ID (starting from 0) for x: ";
+			cin >> idX;
+			cout << "Enter column ID (starting from 0) for y: ";
+			cin >> idY;
+			cout << "Enter column ID (starting from 0, -1 if 2D data) for z: ";
+			cin >> idZ;
 
-			//1- BUILD HEADER
-			while (token)
-			{
-				// Load text header
-				if(hasHeader)
-				{
-					csvHeader.push_back(GenericInputHeader(string(token)));
-				}
-				dim++;
-				token = strtok_r(NULL, delimiters, &brkt);
-			}
-			
-			if (!hasHeader)
+			// Fill with unkown column names
+			for(unsigned int i=0; i<dim; i++)
 			{
-				// Check if it is a simple file with only coordinates
-				if (!(dim == 2 || dim == 3))
-				{
-					int idX=0, idY=0, idZ=0;
-
-					cout << "WARNING: " << dim << " columns detected. Not obvious which columns to load for x, y or z." << endl;
-					cout << endl << "Enter column ID (starting from 0) for x: ";
-					cin >> idX;
-					cout << "Enter column ID (starting from 0) for y: ";
-					cin >> idY;
-					cout << "Enter column ID (starting from 0, -1 if 2D data) for z: ";
-					cin >> idZ;
-
-					// Fill with unkown column names
-					for(unsigned int i=0; i<dim; i++)
-					{
-						std::ostringstream os;
-						os << "empty" << i;
+				std::ostringstream os;
+				os << "empty" << i;
 
-						csvHeader.push_back(GenericInputHeader(os.str()));
-					}
-					
-					// Overwrite with user inputs
-					csvHeader[idX] = GenericInputHeader("x");
-					csvHeader[idY] = GenericInputHeader("y");
-					if(idZ != -1)
-						csvHeader[idZ] = GenericInputHeader("z");
-				}
-				else
-				{
-					// Assume logical order...
-					csvHeader.push_back(GenericInputHeader("x"));
-					csvHeader.push_back(GenericInputHeader("y"));
-					if(dim == 3)
-						csvHeader.push_back(GenericInputHeader("z"));
-				}
+				csvHeader.push_back(GenericInputHeader(os.str()));
 			}
-
-			//2- PROCESS HEADER
-			// Load known features, descriptors, and time
-			const SupportedLabels externalLabels = getSupportedExternalLabels();
-
-			// Counters
-			int rowIdFeatures = 0;
-			int rowIdDescriptors = 0;
-			int rowIdTime = 0;
-
 			
-			// Loop through all known external names (ordered list)
-			for(size_t i=0; i<externalLabels.size(); i++)
-			{
-				const SupportedLabel supLabel = externalLabels[i];
-
-				for(size_t j=0; j < csvHeader.size(); j++)
-				{
-					if(supLabel.externalName == csvHeader[j].name)
-					{
-						csvHeader[j].matrixType = supLabel.type;
-
-						switch (supLabel.type)
-						{
-							case FEATURE:
-								csvHeader[j].matrixRowId = rowIdFeatures;
-								featLabelGen.add(supLabel.internalName);
-								rowIdFeatures++;
-								break;
-							case DESCRIPTOR:
-								csvHeader[j].matrixRowId = rowIdDescriptors;
-								descLabelGen.add(supLabel.internalName);
-								rowIdDescriptors++;
-								break;
-							case TIME:
-								csvHeader[j].matrixRowId = rowIdTime;
-								timeLabelGen.add(supLabel.internalName);
-								rowIdTime++;
-								break;
-							default:
-								throw runtime_error(string("CSV parse error: encounter a type different from FEATURE, DESCRIPTOR and TIME. Implementation not supported. See the definition of 'enum PMPropTypes'"));
-								break;
-						}
-						
-						// we stop searching once we have a match
-						break;
-					}
-				}
-			}
-
-			// loop through the remaining UNSUPPORTED labels and assigned them to a descriptor row
-			for(unsigned int i=0; i<csvHeader.size(); i++)
-			{
-				if(csvHeader[i].matrixType == UNSUPPORTED)
-				{
-					csvHeader[i].matrixType = DESCRIPTOR; // force descriptor
-					csvHeader[i].matrixRowId = rowIdDescriptors;
-					descLabelGen.add(csvHeader[i].name); // keep original name
-					rowIdDescriptors++;
-				}
-			}
-		
-
-			//3- RESERVE MEMORY
-			if(hasHeader && line_count > 0)
-				line_count--;
+			// Overwrite with user inputs
+			csvHeader[idX] = GenericInputHeader("x");
+			csvHeader[idY] = GenericInputHeader("y");
+			if(idZ != -1)
+				csvHeader[idZ] = GenericInputHeader("z");
+		}
+		else
+		{
+			// Assume logical order...
+			csvHeader.push_back(GenericInputHeader("x"));
+			csvHeader.push_back(GenericInputHeader("y"));
+			if(dim == 3)
+				csvHeader.push_back(GenericInputHeader("z"));
+		}
+	}
 
-			const unsigned int featDim = featLabelGen.getLabels().totalDim();
-			const unsigned int descDim = descLabelGen.getLabels().totalDim();
-			const unsigned int timeDim = timeLabelGen.getLabels().totalDim();
-			const unsigned int nbPoints = line_count;
+	//2- PROCESS HEADER
+	// Load known features, descriptors, and time
+	const SupportedLabels externalLabels = getSupportedExternalLabels();
 
-			features = Matrix(featDim, nbPoints);
-			descriptors = Matrix(descDim, nbPoints);
-			times = Int64Matrix(timeDim, nbPoints);
-		}
+	// Counters
+	int rowIdFeatures = 0;
+	int rowIdDescriptors = 0;
+	int rowIdTime = 0;
 
+	
+	// Loop through all known external names (ordered list)
+	for(size_t i=0; i<externalLabels.size(); i++)
+	{
+		const SupportedLabel supLabel = externalLabels[i];
 
-		//4- LOAD DATA (this start again from the first line)
-		char* brkt = 0;
-		char line_c[1024];//FIXME: this might be a problem for large files
-		strcpy(line_c,line.c_str());
-		token = strtok_r(line_c, delimiters, &brkt);
-		
-		if(!(hasHeader && firstLine))
+		for(size_t j=0; j < csvHeader.size(); j++)
 		{
-			// Parse a line
-			csvCol = 0;
-			while (token)
+			if(supLabel.externalName == csvHeader[j].name)
 			{
-				if(csvCol > (csvHeader.size() - 1))
-				{
-					// Error check (too much data)
-					throw runtime_error(
-					(boost::format("CSV parse error: at line %1%, too many elements to parse compare to the header number of columns (col=%2%).") % csvRow % csvHeader.size()).str());
-				}
-				
-				// Alias
-				const int matrixRow = csvHeader[csvCol].matrixRowId;
-				const int matrixCol = csvRow;
-				
-				switch (csvHeader[csvCol].matrixType)
+				csvHeader[j].matrixType = supLabel.type;
+
+				switch (supLabel.type)
 				{
 					case FEATURE:
-						features(matrixRow, matrixCol) = lexical_cast_scalar_to_string<T>(string(token));
+						csvHeader[j].matrixRowId = rowIdFeatures;
+						featLabelGen.add(supLabel.internalName);
+						rowIdFeatures++;
 						break;
 					case DESCRIPTOR:
-						descriptors(matrixRow, matrixCol) = lexical_cast_scalar_to_string<T>(token);
+						csvHeader[j].matrixRowId = rowIdDescriptors;
+						descLabelGen.add(supLabel.internalName);
+						rowIdDescriptors++;
 						break;
 					case TIME:
-						times(matrixRow, matrixCol) = lexical_cast_scalar_to_string<std::int64_t>(token);
+						csvHeader[j].matrixRowId = rowIdTime;
+						timeLabelGen.add(supLabel.internalName);
+						rowIdTime++;
 						break;
 					default:
 						throw runtime_error(string("CSV parse error: encounter a type different from FEATURE, DESCRIPTOR and TIME. Implementation not supported. See the definition of 'enum PMPropTypes'"));
 						break;
-
 				}
+				
+				// we stop searching once we have a match
+				break;
+			}
+		}
+	}
+
+	// loop through the remaining UNSUPPORTED labels and assigned them to a descriptor row
+	for(unsigned int i=0; i<csvHeader.size(); i++)
+	{
+		if(csvHeader[i].matrixType == UNSUPPORTED)
+		{
+			csvHeader[i].matrixType = DESCRIPTOR; // force descriptor
+			csvHeader[i].matrixRowId = rowIdDescriptors;
+			descLabelGen.add(csvHeader[i].name); // keep original name
+			rowIdDescriptors++;
+		}
+	}
+
+	return hasHeader;
+}
+
+namespace
+{
+	//! Return whether c separates two values on a line of a CSV file
+	inline bool isCSVDelimiter(const char c)
+	{
+		return c == ' ' || c == '\t' || c == ',' || c == ';';
+	}
+
+	//! Return whether c is a decimal digit
+	inline bool isDecimalDigit(const char c)
+	{
+		return unsigned(c - '0') < 10;
+	}
+
+	//! Exact powers of ten representable as double
+	const double exactPowersOfTen[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	//! Split the decimal number in [begin, end) into sign, significant digits and power of ten
+	/**
+		Return false if the token is not a plain decimal number (inf, nan, malformed...)
+		or if it has more significant digits than mantissa can hold exactly.
+	*/
+	bool splitDecimal(const char* p, const char* end, bool& negative, std::uint64_t& mantissa, int& exponent)
+	{
+		negative = false;
+		if (p != end && (*p == '+' || *p == '-'))
+		{
+			negative = (*p == '-');
+			++p;
+		}
 
-				//fetch next element
-				token = strtok_r(NULL, delimiters, &brkt);
-				csvCol++;
+		mantissa = 0;
+		exponent = 0;
+		int digitCount = 0;
+		bool hasDigits = false;
+		for (; p != end && isDecimalDigit(*p); ++p)
+		{
+			hasDigits = true;
+			if (mantissa == 0 && *p == '0')
+				continue;
+			if (digitCount == 19)
+				return false;
+			mantissa = mantissa * 10 + (*p - '0');
+			++digitCount;
+		}
+		if (p != end && *p == '.')
+		{
+			for (++p; p != end && isDecimalDigit(*p); ++p)
+			{
+				hasDigits = true;
+				--exponent;
+				if (mantissa == 0 && *p == '0')
+					continue;
+				if (digitCount == 19)
+					return false;
+				mantissa = mantissa * 10 + (*p - '0');
+				++digitCount;
 			}
-		
-		
-			// Error check (not enough data)
-			if(csvCol != (csvHeader.size()))
+		}
+		if (!hasDigits)
+			return false;
+
+		if (p != end && (*p == 'e' || *p == 'E'))
+		{
+			++p;
+			bool negativeExponent = false;
+			if (p != end && (*p == '+' || *p == '-'))
 			{
-				throw runtime_error(
-				(boost::format("CSV parse error: at line %1%, not enough elements to parse compare to the header number of columns (col=%2%).") % csvRow % csvHeader.size()).str());
+				negativeExponent = (*p == '-');
+				++p;
+			}
+			if (p == end || !isDecimalDigit(*p))
+				return false;
+			int writtenExponent = 0;
+			for (; p != end && isDecimalDigit(*p); ++p)
+			{
+				if (writtenExponent < 100000)
+					writtenExponent = writtenExponent * 10 + (*p - '0');
 			}
+			exponent += negativeExponent ? -writtenExponent : writtenExponent;
+		}
+		return p == end;
+	}
+
+	//! Convert [begin, end) to value if it is a decimal number that can be converted exactly in one rounding, return false otherwise
+	bool parseFastDecimal(const char* begin, const char* end, double& value)
+	{
+		bool negative;
+		std::uint64_t mantissa;
+		int exponent;
+		if (!splitDecimal(begin, end, negative, mantissa, exponent))
+			return false;
+		if (mantissa > (std::uint64_t(1) << 53) || exponent < -22 || exponent > 22)
+			return false;
+
+		// Both operands are exact, so the single IEEE operation is correctly rounded
+		const double magnitude(exponent < 0 ? double(mantissa) / exactPowersOfTen[-exponent] : double(mantissa) * exactPowersOfTen[exponent]);
+		value = negative ? -magnitude : magnitude;
+		return true;
+	}
+
+	//! Convert [begin, end) to value if it is a decimal number that can be converted exactly in one rounding, return false otherwise
+	bool parseFastDecimal(const char* begin, const char* end, float& value)
+	{
+		bool negative;
+		std::uint64_t mantissa;
+		int exponent;
+		if (!splitDecimal(begin, end, negative, mantissa, exponent))
+			return false;
+		if (mantissa > (std::uint64_t(1) << 24) || exponent < -10 || exponent > 10)
+			return false;
+
+		const float power(float(exactPowersOfTen[exponent < 0 ? -exponent : exponent]));
+		const float magnitude(exponent < 0 ? float(mantissa) / power : float(mantissa) * power);
+		value = negative ? -magnitude : magnitude;
+		return true;
+	}
+
+	//! Convert [begin, end) to value if it is a plain integer of at most 18 digits, return false otherwise
+	bool parseFastDecimal(const char* p, const char* end, std::int64_t& value)
+	{
+		const bool negative(p != end && *p == '-');
+		if (negative)
+			++p;
+		if (p == end || end - p > 18)
+			return false;
 
-			csvRow++;
+		std::int64_t magnitude = 0;
+		for (; p != end; ++p)
+		{
+			if (!isDecimalDigit(*p))
+				return false;
+			magnitude = magnitude * 10 + (*p - '0');
 		}
+		value = negative ? -magnitude : magnitude;
+		return true;
+	}
+
+	//! Convert the CSV value in [begin, end), falling back to the general conversion for uncommon numbers and for errors
+	template<typename S>
+	S parseCSVValue(const char* begin, const char* end)
+	{
+		S value;
+		if (parseFastDecimal(begin, end, value))
+			return value;
+		return PointMatcherSupport::lexical_cast_scalar_to_string<S>(std::string(begin, end));
+	}
+}
+
+//! Parse a line of CSV data, in [lineBegin, lineEnd), into column matrixCol of the matrices, csvRow being the index of the line used in error messages
+template<typename T>
+void PointMatcherIO<T>::parseCSVLine(const char* lineBegin, const char* lineEnd, const std::vector<GenericInputHeader>& csvHeader, const unsigned int csvRow, const int matrixCol, Matrix& features, Matrix& descriptors, Int64Matrix& times)
+{
+	// Parse a line
+	const char* token = lineBegin;
+	unsigned int csvCol = 0;
+	while (true)
+	{
+		while (token != lineEnd && isCSVDelimiter(*token))
+			++token;
+		if (token == lineEnd)
+			break;
+		const char* tokenEnd = token;
+		while (tokenEnd != lineEnd && !isCSVDelimiter(*tokenEnd))
+			++tokenEnd;
 
-		firstLine = false;
+		if(csvCol > (csvHeader.size() - 1))
+		{
+			// Error check (too much data)
+			throw runtime_error(
+			(boost::format("CSV parse error: at line %1%, too many elements to parse compare to the header number of columns (col=%2%).") % csvRow % csvHeader.size()).str());
+		}
 		
+		// Alias
+		const int matrixRow = csvHeader[csvCol].matrixRowId;
+		
+		switch (csvHeader[csvCol].matrixType)
+		{
+			case FEATURE:
+				features(matrixRow, matrixCol) = parseCSVValue<T>(token, tokenEnd);
+				break;
+			case DESCRIPTOR:
+				descriptors(matrixRow, matrixCol) = parseCSVValue<T>(token, tokenEnd);
+				break;
+			case TIME:
+				times(matrixRow, matrixCol) = parseCSVValue<std::int64_t>(token, tokenEnd);
+				break;
+			default:
+				throw runtime_error(string("CSV parse error: encounter a type different from FEATURE, DESCRIPTOR and TIME. Implementation not supported. See the definition of 'enum PMPropTypes'"));
+				break;
+
+		}
+
+		//fetch next element
+		token = tokenEnd;
+		csvCol++;
+	}
+
+	// Error check (not enough data)
+	if(csvCol != (csvHeader.size()))
+	{
+		throw runtime_error(
+		(boost::format("CSV parse error: at line %1%, not enough elements to parse compare to the header number of columns (col=%2%).") % csvRow % csvHeader.size()).str());
+	}
+}
+
+//! @brief Load comma separated values (csv) file
+//! @see loadCSV()
+/**
+	The whole stream is read at once and its lines, up to the first empty one,
+	are parsed by nbThreads threads, each one parsing a contiguous chunk of lines.
+*/
+template<typename T>
+typename PointMatcher<T>::DataPoints PointMatcherIO<T>::loadCSV(std::istream& is, const unsigned nbThreads)
+{
+	vector<GenericInputHeader> csvHeader;
+	LabelGenerator featLabelGen, descLabelGen, timeLabelGen;
+	Matrix features;
+	Matrix descriptors;
+	Int64Matrix times;
+
+	//1- READ THE WHOLE STREAM
+	string buffer;
+	const std::streampos start(is.tellg());
+	if (start != std::streampos(-1) && is.seekg(0, ios::end))
+	{
+		const std::streampos end(is.tellg());
+		is.seekg(start);
+		buffer.resize(size_t(end - start));
+		is.read(&buffer[0], buffer.size());
+		buffer.resize(size_t(is.gcount()));
+	}
+	else
+	{
+		is.clear();
+		buffer.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+	}
+
+	//2- SPLIT LINES, ending with \n, \r or \r\n, until the first empty one
+	std::vector<size_t> lineBegins;
+	std::vector<size_t> lineEnds;
+	size_t pos(0);
+	while (pos < buffer.size())
+	{
+		size_t lineEnd(pos);
+		while (lineEnd < buffer.size() && buffer[lineEnd] != '\n' && buffer[lineEnd] != '\r')
+			++lineEnd;
+
+		// Skip empty lines
+		if (lineEnd == pos)
+			break;
+
+		lineBegins.push_back(pos);
+		lineEnds.push_back(lineEnd);
+
+		pos = lineEnd;
+		if (pos < buffer.size())
+			pos += (buffer[pos] == '\r' && pos + 1 < buffer.size() && buffer[pos + 1] == '\n') ? 2 : 1;
+	}
+
+	if (!lineBegins.empty())
+	{
+		const bool hasHeader(parseCSVHeader(buffer.substr(lineBegins[0], lineEnds[0] - lineBegins[0]), csvHeader, featLabelGen, descLabelGen, timeLabelGen));
+
+		//3- RESERVE MEMORY
+		const size_t firstDataLine(hasHeader ? 1 : 0);
+		const size_t nbPoints(lineBegins.size() - firstDataLine);
+		features = Matrix(featLabelGen.getLabels().totalDim(), nbPoints);
+		descriptors = Matrix(descLabelGen.getLabels().totalDim(), nbPoints);
+		times = Int64Matrix(timeLabelGen.getLabels().totalDim(), nbPoints);
+
+		//4- LOAD DATA (this start again from the first line)
+		const char* data(buffer.data());
+		const unsigned chunkCount(getChunkCount(nbPoints, nbThreads, 4096));
+		parallelForChunks(nbPoints, chunkCount, [&](const unsigned, const size_t begin, const size_t end)
+		{
+			for (size_t csvRow = begin; csvRow < end; ++csvRow)
+			{
+				const size_t line(csvRow + firstDataLine);
+				parseCSVLine(data + lineBegins[line], data + lineEnds[line], csvHeader, csvRow, csvRow, features, descriptors, times);
+			}
+		});
 	}
 
 	// 5- ASSEMBLE FINAL DATAPOINTS
@@ -800,9 +983,9 @@ typename PointMatcher<T>::DataPoints PointMatcherIO<T>::loadCSV(std::istream& is
 }
 
 template
-PointMatcher<float>::DataPoints PointMatcherIO<float>::loadCSV(const std::string& fileName);
+PointMatcher<float>::DataPoints PointMatcherIO<float>::loadCSV(const std::string& fileName, const unsigned nbThreads);
 template
-PointMatcher<double>::DataPoints PointMatcherIO<double>::loadCSV(const std::string& fileName);
+PointMatcher<double>::DataPoints PointMatcherIO<double>::loadCSV(const std::string& fileName, const unsigned nbThreads);
 
 //! Save a point cloud to a file, determine format from extension
 template<typename T>
@@ -813,17 +996,20 @@ void PointMatcher<T>::DataPoints::save(const std::string& fileName, bool binary)
 	if (boost::iequals(ext, ".vtk"))
 		return PointMatcherIO<T>::saveVTK(*this, fileName, binary);
 
+	if (boost::iequals(ext, ".ply"))
+		return PointMatcherIO<T>::savePLY(*this, fileName, binary);
+	if (boost::iequals(ext, ".pcd"))
+		return PointMatcherIO<T>::savePCD(*this, fileName, binary);
+	if (boost::iequals(ext, ".pmb"))
+		return PointMatcherIO<T>::savePMB(*this, fileName);
+
 	if (binary)
-		throw runtime_error("save(): Binary writing is not supported together with extension \"" + ext + "\". Currently binary writing is only supported with \".vtk\".");
+		throw runtime_error("save(): Binary writing is not supported together with extension \"" + ext + "\". Currently binary writing is only supported with \".vtk\", \".ply\", \".pcd\" and \".pmb\".");
 
 	if (boost::iequals(ext, ".csv"))
 		return PointMatcherIO<T>::saveCSV(*this, fileName);
-	else if (boost::iequals(ext, ".ply"))
-		return PointMatcherIO<T>::savePLY(*this, fileName);
-	else if (boost::iequals(ext, ".pcd"))
-		return PointMatcherIO<T>::savePCD(*this, fileName);
 	else
-		throw runtime_error("save(): Unknown extension \"" + ext + "\" for file \"" + fileName + "\", extension must be either \".vtk\", \".ply\", \".pcd\" or \".csv\"");
+		throw runtime_error("save(): Unknown extension \"" + ext + "\" for file \"" + fileName + "\", extension must be either \".vtk\", \".ply\", \".pcd\", \".pmb\" or \".csv\"");
 }
 
 template
@@ -1275,59 +1461,331 @@ void PointMatcherIO<float>::saveVTK(const PointMatcherIO<float>::DataPoints& dat
 template
 void PointMatcherIO<double>::saveVTK(const PointMatcher<double>::DataPoints& data, const std::string& fileName, bool binary);
 
-//! @brief Load polygon file format (ply) file
-//! @param fileName a string containing the path and the file name
-//!
-//! Note: that the PLY does not define a standard for point clouds
-//! Warning: Binary PLY files are not supported, only ASCII
-//! Only PLY files with elements named "vertex" are supported
-//! "vertex" should have 2 or 3 properties names "x", "y", "z" to define features.
-//!
-template<typename T>
-typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(const std::string& fileName)
-{
-	ifstream ifs(fileName.c_str());
-	if (!ifs.good())
-		throw runtime_error(string("Cannot open file ") + fileName);
-	return loadPLY(ifs);
-}
-
-template
-PointMatcherIO<float>::DataPoints PointMatcherIO<float>::loadPLY(const string& fileName);
-template
-PointMatcherIO<double>::DataPoints PointMatcherIO<double>::loadPLY(const string& fileName);
+// Binary PLY and PCD
 
-//! @brief Load polygon file format (PLY) file
-//! @see loadPLY()
-template <typename T>
-typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(std::istream& is)
+namespace
 {
-	class Elements : public vector<PLYElement*>{
-	 public:
-		~Elements(){
-			for (typename vector<PLYElement*>::const_iterator it = this->begin(); it != this->end(); it++ )
-			{
-				delete *it;
-			}
-		}
+	//! Type of a value in a binary PLY or PCD file
+	enum BinaryValueType
+	{
+		INT8, UINT8, INT16, UINT16, INT32, UINT32, INT64, UINT64, FLOAT32, FLOAT64
 	};
 
-	/*
-	Steps:
-	1- PARSE PLY HEADER
-	2- ASSIGN PLY PROPERTIES TO DATAPOINTS ROWS
-	3- Reserve memory for a DataPoints
-	4- Parse PLY vertex to appropriate DataPoints cols and rows 
-	5- Assemble final DataPoints
+	//! Return the size in bytes of a value of type
+	size_t getBinaryValueSize(const BinaryValueType type)
+	{
+		switch (type)
+		{
+			case INT8: case UINT8: return 1;
+			case INT16: case UINT16: return 2;
+			case INT32: case UINT32: case FLOAT32: return 4;
+			default: return 8;
+		}
+	}
 
-	PLY organisation:
+	//! Return the binary type of a PLY property type
+	BinaryValueType getPLYBinaryValueType(const std::string& type)
+	{
+		if (type == "char" || type == "int8") return INT8;
+		if (type == "uchar" || type == "uint8") return UINT8;
+		if (type == "short" || type == "int16") return INT16;
+		if (type == "ushort" || type == "uint16") return UINT16;
+		if (type == "int" || type == "int32") return INT32;
+		if (type == "uint" || type == "uint32") return UINT32;
+		if (type == "float" || type == "float32") return FLOAT32;
+		if (type == "double" || type == "float64") return FLOAT64;
+		throw runtime_error(string("PLY parse error: property type ") + type + string(" is invalid"));
+	}
+
+	//! Return the binary type of a PCD field of given TYPE and SIZE
+	BinaryValueType getPCDBinaryValueType(const char type, const unsigned size)
+	{
+		if (type == 'I' && size == 1) return INT8;
+		if (type == 'U' && size == 1) return UINT8;
+		if (type == 'I' && size == 2) return INT16;
+		if (type == 'U' && size == 2) return UINT16;
+		if (type == 'I' && size == 4) return INT32;
+		if (type == 'U' && size == 4) return UINT32;
+		if (type == 'I' && size == 8) return INT64;
+		if (type == 'U' && size == 8) return UINT64;
+		if (type == 'F' && size == 4) return FLOAT32;
+		if (type == 'F' && size == 8) return FLOAT64;
+		throw runtime_error((boost::format("PCD Parse Error: unsupported TYPE %1% with SIZE %2%") % type % size).str());
+	}
+
+	//! Read a value of type V at data, swapping its bytes if requested, and convert it to Out
+	template<typename V, typename Out>
+	inline Out readBinaryValue(const char* data, const bool swapBytes)
+	{
+		ConverterToAndFromBytes<V> converter;
+		std::copy(data, data + sizeof(V), converter.bytes);
+		if (swapBytes)
+			converter.swapBytes();
+		return static_cast<Out>(converter.v);
+	}
 
-	element 1 [name, size]
-		- property 1 [type, name]
-		- property 2
-		- ...
-	element 2
-		-...
+	//! Read a value of given type at data, swapping its bytes if requested, and convert it to Out
+	template<typename Out>
+	inline Out readBinaryValue(const char* data, const BinaryValueType type, const bool swapBytes)
+	{
+		switch (type)
+		{
+			case INT8: return readBinaryValue<std::int8_t, Out>(data, swapBytes);
+			case UINT8: return readBinaryValue<std::uint8_t, Out>(data, swapBytes);
+			case INT16: return readBinaryValue<std::int16_t, Out>(data, swapBytes);
+			case UINT16: return readBinaryValue<std::uint16_t, Out>(data, swapBytes);
+			case INT32: return readBinaryValue<std::int32_t, Out>(data, swapBytes);
+			case UINT32: return readBinaryValue<std::uint32_t, Out>(data, swapBytes);
+			case INT64: return readBinaryValue<std::int64_t, Out>(data, swapBytes);
+			case UINT64: return readBinaryValue<std::uint64_t, Out>(data, swapBytes);
+			case FLOAT32: return readBinaryValue<float, Out>(data, swapBytes);
+			default: return readBinaryValue<double, Out>(data, swapBytes);
+		}
+	}
+
+	//! Write value to os as a value of type V, swapping its bytes from the order of the platform if requested
+	template<typename V, typename In>
+	inline void writeBinaryValue(std::ostream& os, const In value, const bool swapBytes)
+	{
+		ConverterToAndFromBytes<V> converter(static_cast<V>(value));
+		if (swapBytes)
+			converter.swapBytes();
+		os << converter;
+	}
+
+	//! A field of the points of a binary file, and where it goes in a DataPoints
+	template<typename T>
+	struct BinaryField
+	{
+		typedef typename PointMatcherIO<T>::PMPropTypes PMPropTypes;
+
+		BinaryValueType type; //!< type of a value
+		unsigned count; //!< number of values
+		size_t offset; //!< offset of the first value in a point, in bytes
+		PMPropTypes pmType; //!< in which matrix the values go
+		int pmRowID; //!< row of the first value in that matrix
+		T divisor; //!< the values are divided by it
+
+		BinaryField(const BinaryValueType type, const unsigned count, const size_t offset, const PMPropTypes pmType, const int pmRowID, const T divisor = 1):
+			type(type), count(count), offset(offset), pmType(pmType), pmRowID(pmRowID), divisor(divisor) {}
+	};
+
+	//! Convert the values of the points [firstPoint, firstPoint + pointCount) found in data into the matrices of a DataPoints
+	/**
+		If fieldMajor is false, every point is stored contiguously, pointSize
+		bytes apart (PLY and PCD binary). Otherwise every field is stored for
+		all points, one after the other (PCD binary_compressed), and there are
+		totalPointCount points in data.
+	*/
+	template<typename T>
+	void convertBinaryPoints(const char* data, const std::vector<BinaryField<T>>& fields, const size_t pointSize, const bool fieldMajor, const size_t totalPointCount, const bool swapBytes, const size_t firstPoint, const size_t pointCount, typename PointMatcher<T>::Matrix& features, typename PointMatcher<T>::Matrix& descriptors, typename PointMatcher<T>::Int64Matrix& times)
+	{
+		typedef PointMatcherIO<T> IO;
+		for (size_t i = 0; i < pointCount; ++i)
+		{
+			const size_t col(firstPoint + i);
+			for (size_t f = 0; f < fields.size(); ++f)
+			{
+				const BinaryField<T>& field(fields[f]);
+				const size_t valueSize(getBinaryValueSize(field.type));
+				const char* value(fieldMajor ?
+					data + field.offset * totalPointCount + col * field.count * valueSize :
+					data + i * pointSize + field.offset);
+				for (unsigned j = 0; j < field.count; ++j, value += valueSize)
+				{
+					switch (field.pmType)
+					{
+						case IO::FEATURE:
+							features(field.pmRowID + j, col) = readBinaryValue<T>(value, field.type, swapBytes) / field.divisor;
+							break;
+						case IO::DESCRIPTOR:
+							descriptors(field.pmRowID + j, col) = readBinaryValue<T>(value, field.type, swapBytes) / field.divisor;
+							break;
+						case IO::TIME:
+							times(field.pmRowID + j, col) = readBinaryValue<std::int64_t>(value, field.type, swapBytes);
+							break;
+						default:
+							break;
+					}
+				}
+			}
+		}
+	}
+
+	//! Read pointCount points of pointSize bytes from is, by chunks, and convert them into the matrices of a DataPoints
+	template<typename T>
+	void readBinaryPoints(std::istream& is, const std::vector<BinaryField<T>>& fields, const size_t pointSize, const size_t pointCount, const bool swapBytes, typename PointMatcher<T>::Matrix& features, typename PointMatcher<T>::Matrix& descriptors, typename PointMatcher<T>::Int64Matrix& times)
+	{
+		// a fixed-size buffer, so that the transient memory does not depend on the size of the file
+		const size_t chunkSize(std::max<size_t>(1, (1 << 20) / std::max<size_t>(1, pointSize)));
+		std::vector<char> buffer(chunkSize * pointSize);
+		for (size_t firstPoint = 0; firstPoint < pointCount; firstPoint += chunkSize)
+		{
+			const size_t count(std::min(chunkSize, pointCount - firstPoint));
+			if (!is.read(buffer.data(), count * pointSize))
+				throw runtime_error((boost::format("Binary parse error: expected %1% points but only found %2% points.") % pointCount % (firstPoint + is.gcount() / pointSize)).str());
+			convertBinaryPoints<T>(buffer.data(), fields, pointSize, false, pointCount, swapBytes, firstPoint, count, features, descriptors, times);
+		}
+	}
+
+	//! Decompress LZF-compressed data of inputSize bytes into output of outputSize bytes, as used by PCD binary_compressed
+	void decompressLZF(const unsigned char* input, const size_t inputSize, unsigned char* output, const size_t outputSize)
+	{
+		const unsigned char* in(input);
+		const unsigned char* const inEnd(input + inputSize);
+		unsigned char* out(output);
+		unsigned char* const outEnd(output + outputSize);
+		while (in < inEnd)
+		{
+			unsigned ctrl(*in++);
+			if (ctrl < 32)
+			{
+				// literal run of ctrl + 1 bytes
+				const size_t length(ctrl + 1);
+				if (in + length > inEnd || out + length > outEnd)
+					throw runtime_error("PCD Parse Error: corrupted binary_compressed data");
+				out = std::copy(in, in + length, out);
+				in += length;
+			}
+			else
+			{
+				// back reference, possibly overlapping the output
+				size_t length(ctrl >> 5);
+				if (in >= inEnd)
+					throw runtime_error("PCD Parse Error: corrupted binary_compressed data");
+				if (length == 7)
+				{
+					length += *in++;
+					if (in >= inEnd)
+						throw runtime_error("PCD Parse Error: corrupted binary_compressed data");
+				}
+				length += 2;
+				const size_t distance(((ctrl & 0x1f) << 8) + *in++ + 1);
+				if (distance > size_t(out - output) || out + length > outEnd)
+					throw runtime_error("PCD Parse Error: corrupted binary_compressed data");
+				const unsigned char* ref(out - distance);
+				for (size_t i = 0; i < length; ++i)
+					*out++ = *ref++;
+			}
+		}
+		if (out != outEnd)
+			throw runtime_error("PCD Parse Error: binary_compressed data is shorter than announced");
+	}
+
+	//! Compress inputSize bytes with LZF into output, which must hold at least inputSize + inputSize / 32 + 2 bytes; return the compressed size
+	size_t compressLZF(const unsigned char* input, const size_t inputSize, unsigned char* output)
+	{
+		const unsigned hashLog(14);
+		std::vector<size_t> hashTable(size_t(1) << hashLog, std::numeric_limits<size_t>::max());
+		size_t in(0);
+		size_t out(1); // first byte reserved for the control byte of a literal run
+		size_t literal(0);
+		while (in < inputSize)
+		{
+			if (in + 2 < inputSize)
+			{
+				const unsigned hash((unsigned(input[in]) << 16) | (unsigned(input[in + 1]) << 8) | input[in + 2]);
+				const size_t slot(((hash * 2654435761u) >> (32 - hashLog)) & ((1u << hashLog) - 1));
+				const size_t ref(hashTable[slot]);
+				hashTable[slot] = in;
+				if (ref < in && in - ref - 1 < 8192 &&
+					input[ref] == input[in] && input[ref + 1] == input[in + 1] && input[ref + 2] == input[in + 2])
+				{
+					// back reference of 3 to 264 bytes
+					const size_t offset(in - ref - 1);
+					const size_t maxLength(std::min<size_t>(264, inputSize - in));
+					size_t length(3);
+					while (length < maxLength && input[ref + length] == input[in + length])
+						++length;
+					if (literal)
+						output[out - literal - 1] = static_cast<unsigned char>(literal - 1);
+					else
+						--out;
+					length -= 2;
+					if (length < 7)
+						output[out++] = static_cast<unsigned char>((offset >> 8) + (length << 5));
+					else
+					{
+						output[out++] = static_cast<unsigned char>((offset >> 8) + (7 << 5));
+						output[out++] = static_cast<unsigned char>(length - 7);
+					}
+					output[out++] = static_cast<unsigned char>(offset & 0xff);
+					in += length + 2;
+					literal = 0;
+					++out;
+					continue;
+				}
+			}
+			output[out++] = input[in++];
+			if (++literal == 32)
+			{
+				output[out - literal - 1] = static_cast<unsigned char>(literal - 1);
+				literal = 0;
+				++out;
+			}
+		}
+		if (literal)
+			output[out - literal - 1] = static_cast<unsigned char>(literal - 1);
+		else
+			--out;
+		return out;
+	}
+}
+
+//! @brief Load polygon file format (ply) file
+//! @param fileName a string containing the path and the file name
+//!
+//! Note: that the PLY does not define a standard for point clouds
+//! ASCII and binary (little and big endian) PLY files are supported, binary
+//! vertex data being read by chunks straight into the DataPoints matrices
+//! Only PLY files with elements named "vertex" are supported
+//! "vertex" should have 2 or 3 properties names "x", "y", "z" to define features.
+//!
+template<typename T>
+typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(const std::string& fileName)
+{
+	ifstream ifs(fileName.c_str(), std::ios::in | std::ios::binary);
+	if (!ifs.good())
+		throw runtime_error(string("Cannot open file ") + fileName);
+	return loadPLY(ifs);
+}
+
+template
+PointMatcherIO<float>::DataPoints PointMatcherIO<float>::loadPLY(const string& fileName);
+template
+PointMatcherIO<double>::DataPoints PointMatcherIO<double>::loadPLY(const string& fileName);
+
+//! @brief Load polygon file format (PLY) file
+//! @see loadPLY()
+template <typename T>
+typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(std::istream& is)
+{
+	class Elements : public vector<PLYElement*>{
+	 public:
+		~Elements(){
+			for (typename vector<PLYElement*>::const_iterator it = this->begin(); it != this->end(); it++ )
+			{
+				delete *it;
+			}
+		}
+	};
+
+	/*
+	Steps:
+	1- PARSE PLY HEADER
+	2- ASSIGN PLY PROPERTIES TO DATAPOINTS ROWS
+	3- Reserve memory for a DataPoints
+	4- Parse PLY vertex to appropriate DataPoints cols and rows 
+	5- Assemble final DataPoints
+
+	PLY organisation:
+
+	element 1 [name, size]
+		- property 1 [type, name]
+		- property 2
+		- ...
+	element 2
+		-...
 
 	*/
 
@@ -1336,6 +1794,8 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(std::istream&
 	// 1- PARSE PLY HEADER
 	bool format_defined = false;
 	bool header_processed = false;
+	bool binary = false;
+	bool bigEndian = false;
 
 	Elements elements;
 	PLYElementF element_f; // factory
@@ -1379,8 +1839,8 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(std::istream&
 			if (format_str != "ascii" && format_str != "binary_little_endian" && format_str != "binary_big_endian")
 				throw runtime_error(string("PLY parse error: format <") + format_str + string("> is not supported"));
 
-			if (format_str == "binary_little_endian" || format_str == "binary_big_endian")
-				throw runtime_error(string("PLY parse error: binary PLY files are not supported"));
+			binary = (format_str != "ascii");
+			bigEndian = (format_str == "binary_big_endian");
 			if (version_str != "1.0")
 			{
 				throw runtime_error(string("PLY parse error: version <") + version_str + string("> of ply is not supported"));
@@ -1559,6 +2019,11 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(std::istream&
 	///////////////////////////
 	// 3- RESERVE DATAPOINTS MEMORY
 
+	// Ensure homogeous coordinates, the row of pad being allocated with the others
+	const bool padMissing = !featLabelGen.getLabels().contains("pad");
+	if (padMissing)
+		featLabelGen.add("pad");
+
 	const unsigned int featDim = featLabelGen.getLabels().totalDim();
 	const unsigned int descDim = descLabelGen.getLabels().totalDim();
 	const unsigned int timeDim = timeLabelGen.getLabels().totalDim();
@@ -1567,55 +2032,78 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(std::istream&
 	Matrix features = Matrix(featDim, nbPoints);
 	Matrix descriptors = Matrix(descDim, nbPoints);
 	Int64Matrix times = Int64Matrix(timeDim, nbPoints);
+	if (padMissing)
+		features.row(featDim - 1).setOnes();
 
 
 	///////////////////////////
 	// 4- PARSE PLY DATA (vertex)
-	const int nbProp = vertex->total_props;
-	const int nbValues = nbPoints*nbProp;
-	int propID = 0;
-	int col = 0;
-	for(int i=0; i<nbValues; i++)
+	if (binary)
 	{
-		T value;
-		if(!(is >> value))
-		{
-			throw runtime_error(
-			(boost::format("PLY parse error: expected %1% values (%2% points with %3% properties) but only found %4% values.") % nbValues % nbPoints % nbProp % i).str());
-		}
-		else
+		// Values are read in chunks and converted in place
+		vector<BinaryField<T> > fields;
+		size_t pointSize = 0;
+		for(it_PLYProp it=vertex->properties.begin(); it!=vertex->properties.end(); ++it)
 		{
-			const int row = vertex->properties[propID].pmRowID;
-			const PMPropTypes type = vertex->properties[propID].pmType;
-			
-			// rescale color from [0,254] to [0, 1[
-			// FIXME: do we need that?
-			if (vertex->properties[propID].name == "red" || vertex->properties[propID].name == "green" || vertex->properties[propID].name == "blue" || vertex->properties[propID].name == "alpha") {
-				value /= 255.0;
-			}
+			if (it->is_list)
+				throw runtime_error(string("PLY parse error: list property ") + it->name + string(" is not supported in binary vertex elements"));
 
-			switch (type)
+			// rescale color from [0,254] to [0, 1[
+			const bool isColor = it->name == "red" || it->name == "green" || it->name == "blue" || it->name == "alpha";
+			const BinaryValueType type = getPLYBinaryValueType(it->type);
+			fields.push_back(BinaryField<T>(type, 1, pointSize, it->pmType, it->pmRowID, isColor ? T(255) : T(1)));
+			pointSize += getBinaryValueSize(type);
+		}
+		readBinaryPoints<T>(is, fields, pointSize, nbPoints, bigEndian != isBigEndian, features, descriptors, times);
+	}
+	else
+	{
+		const int nbProp = vertex->total_props;
+		const int nbValues = nbPoints*nbProp;
+		int propID = 0;
+		int col = 0;
+		for(int i=0; i<nbValues; i++)
+		{
+			T value;
+			if(!(is >> value))
 			{
-				case FEATURE:
-					features(row, col) = value;
-					break;
-				case DESCRIPTOR:
-					descriptors(row, col) = value;
-					break;
-				case TIME:
-					times(row, col) = value;
-					break;
-				case UNSUPPORTED:
-					throw runtime_error("Implementation error in loadPLY(). This should not throw.");
-					break;
+				throw runtime_error(
+				(boost::format("PLY parse error: expected %1% values (%2% points with %3% properties) but only found %4% values.") % nbValues % nbPoints % nbProp % i).str());
 			}
+			else
+			{
+				const int row = vertex->properties[propID].pmRowID;
+				const PMPropTypes type = vertex->properties[propID].pmType;
+			
+				// rescale color from [0,254] to [0, 1[
+				// FIXME: do we need that?
+				if (vertex->properties[propID].name == "red" || vertex->properties[propID].name == "green" || vertex->properties[propID].name == "blue" || vertex->properties[propID].name == "alpha") {
+					value /= 255.0;
+				}
+
+				switch (type)
+				{
+					case FEATURE:
+						features(row, col) = value;
+						break;
+					case DESCRIPTOR:
+						descriptors(row, col) = value;
+						break;
+					case TIME:
+						times(row, col) = value;
+						break;
+					case UNSUPPORTED:
+						throw runtime_error("Implementation error in loadPLY(). This should not throw.");
+						break;
+				}
 
-			++propID;
+				++propID;
 
-			if(propID >= nbProp)
-			{
-				propID = 0;
-				++col;
+				if(propID >= nbProp)
+				{
+					propID = 0;
+					++col;
+				}
 			}
 		}
 	}
@@ -1625,37 +2113,34 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPLY(std::istream&
 	///////////////////////////
 	// 5- ASSEMBLE FINAL DATAPOINTS
 	
-	DataPoints loadedPoints(features, featLabelGen.getLabels());
+	// the matrices are moved, not copied
+	DataPoints loadedPoints;
+	loadedPoints.features.swap(features);
+	loadedPoints.featureLabels = featLabelGen.getLabels();
 
 	if (descriptors.rows() > 0)
 	{
-		loadedPoints.descriptors = descriptors;
+		loadedPoints.descriptors.swap(descriptors);
 		loadedPoints.descriptorLabels = descLabelGen.getLabels();
 	}
 
 	if(times.rows() > 0)
 	{
-		loadedPoints.times = times;
+		loadedPoints.times.swap(times);
 		loadedPoints.timeLabels = timeLabelGen.getLabels();	
 	}
 
-	// Ensure homogeous coordinates
-	if(!loadedPoints.featureExists("pad"))
-	{
-		loadedPoints.addFeature("pad", Matrix::Ones(1,features.cols()));
-	}
-
 	return loadedPoints;
 
 }
 
 template<typename T>
 void PointMatcherIO<T>::savePLY(const DataPoints& data,
-		const std::string& fileName)
+		const std::string& fileName, bool binary)
 {
 	//typedef typename DataPoints::Labels Labels;
 
-	ofstream ofs(fileName.c_str());
+	ofstream ofs(fileName.c_str(), binary ? std::ios::out | std::ios::binary : std::ios::out);
 	if (!ofs.good())
 		throw runtime_error(string("Cannot open file ") + fileName);
 
@@ -1670,11 +2155,15 @@ void PointMatcherIO<T>::savePLY(const DataPoints& data,
 		return;
 	}
 
-	ofs << "ply\n" <<"format ascii 1.0\n";
+	// binary files are written in the byte order of the platform, with the precision of T
+	const string format(binary ? (isBigEndian ? "binary_big_endian" : "binary_little_endian") : "ascii");
+	const string valueType(binary && sizeof(T) == sizeof(double) ? "double" : "float");
+
+	ofs << "ply\n" <<"format " << format << " 1.0\n";
 	ofs << "element vertex " << pointCount << "\n";
 	for (int f=0; f <(featCount-1); f++)
 	{
-		ofs << "property float " << data.featureLabels[f].text << "\n";
+		ofs << "property " << valueType << " " << data.featureLabels[f].text << "\n";
 	}
 
 	for (size_t i = 0; i < data.descriptorLabels.size(); i++)
@@ -1683,12 +2172,33 @@ void PointMatcherIO<T>::savePLY(const DataPoints& data,
 		for (size_t s = 0; s < lab.span; s++)
 
 		{
-			ofs << "property float " << getColLabel(lab,s) << "\n";
+			ofs << "property " << valueType << " " << getColLabel(lab,s) << "\n";
 		}
 	}
 
 	ofs << "end_header\n";
 
+	if (binary)
+	{
+		const bool datawithColor = data.descriptorExists("color");
+		const int colorStartingRow = data.getDescriptorStartingRow("color");
+		const int colorEndRow = colorStartingRow + data.getDescriptorDimension("color");
+		for (int p = 0; p < pointCount; ++p)
+		{
+			for (int f = 0; f < featCount - 1; ++f)
+				writeBinaryValue<T>(ofs, data.features(f, p), false);
+			for (int d = 0; d < descRows; ++d)
+			{
+				if (datawithColor && d >= colorStartingRow && d < colorEndRow)
+					writeBinaryValue<T>(ofs, data.descriptors(d, p) * T(255), false);
+				else
+					writeBinaryValue<T>(ofs, data.descriptors(d, p), false);
+			}
+		}
+		ofs.close();
+		return;
+	}
+
 	// write points
 	for (int p = 0; p < pointCount; ++p)
 	{
@@ -1719,9 +2229,9 @@ void PointMatcherIO<T>::savePLY(const DataPoints& data,
 }
 
 template
-void PointMatcherIO<float>::savePLY(const DataPoints& data, const std::string& fileName);
+void PointMatcherIO<float>::savePLY(const DataPoints& data, const std::string& fileName, bool binary);
 template
-void PointMatcherIO<double>::savePLY(const DataPoints& data, const std::string& fileName);
+void PointMatcherIO<double>::savePLY(const DataPoints& data, const std::string& fileName, bool binary);
 
 //! @(brief) Regular PLY property constructor
 template<typename T>
@@ -1823,7 +2333,10 @@ template<typename T>
 bool PointMatcherIO<T>::plyPropTypeValid(const std::string& type) {
 	return (type == "char" || type == "uchar" || type == "short"
 			|| type == "ushort" || type == "int" || type == "uint"
-			|| type == "float" || type == "double");
+			|| type == "float" || type == "double"
+			|| type == "int8" || type == "uint8" || type == "int16"
+			|| type == "uint16" || type == "int32" || type == "uint32"
+			|| type == "float32" || type == "float64");
 }
 
 
@@ -1845,7 +2358,7 @@ bool PointMatcherIO<T>::PLYProperty::operator==(const PLYProperty& rhs) const
 //! @param fileName a string containing the path and the file name
 template<typename T>
 typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPCD(const string& fileName) {
-	ifstream ifs(fileName.c_str());
+	ifstream ifs(fileName.c_str(), std::ios::in | std::ios::binary);
 	if (!ifs.good())
 		throw runtime_error(string("Cannot open file ") + fileName);
 	return loadPCD(ifs);
@@ -2047,14 +2560,15 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPCD(std::istream&
 				// DATA is the last element of the header, we exit the loop
 				break;
 			}
-			else if(header.dataType == "binary")
+			else if(header.dataType == "binary" || header.dataType == "binary_compressed")
 			{
-				throw runtime_error("PCD Implementation Error: the option for DATA binary is not implemented yet");
+				// DATA is the last element of the header, binary data follows
+				break;
 			}
 			else
 			{
 				stringstream ss;
-				ss << "PCD Parse Error: the value in the element DATA (" << tokens[1] << ") must be ascii or binary";
+				ss << "PCD Parse Error: the value in the element DATA (" << tokens[1] << ") must be ascii, binary or binary_compressed";
 				throw runtime_error(ss.str());
 			}
 
@@ -2150,22 +2664,70 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPCD(std::istream&
 	///////////////////////////
 	// 3- RESERVE DATAPOINTS MEMORY
 
+	// Ensure homogeous coordinates, the row of pad being allocated with the others
+	const bool padMissing = !featLabelGen.getLabels().contains("pad");
+	if (padMissing)
+		featLabelGen.add("pad");
+
 	const unsigned int featDim = featLabelGen.getLabels().totalDim();
 	const unsigned int descDim = descLabelGen.getLabels().totalDim();
 	const unsigned int timeDim = timeLabelGen.getLabels().totalDim();
-	const unsigned int totalDim = featDim + descDim + timeDim;
+	const unsigned int totalDim = featDim - (padMissing ? 1 : 0) + descDim + timeDim;
 	const unsigned int nbPoints = header.nbPoints;
 
 	Matrix features = Matrix(featDim, nbPoints);
 	Matrix descriptors = Matrix(descDim, nbPoints);
 	Int64Matrix times = Int64Matrix(timeDim, nbPoints);
+	if (padMissing)
+		features.row(featDim - 1).setOnes();
 
 
 	///////////////////////////
 	// 4- PARSE PCD DATA
 
 	size_t col = 0; // point count
-	while (safeGetLine(is, line))
+	if (header.dataType == "binary" || header.dataType == "binary_compressed")
+	{
+		// PCD binary data is little endian, every point being stored contiguously
+		// in binary and every field for all points in binary_compressed
+		vector<BinaryField<T> > fields;
+		size_t pointSize = 0;
+		for(size_t i=0; i<header.properties.size(); i++)
+		{
+			const PCDproperty& prop = header.properties[i];
+			fields.push_back(BinaryField<T>(getPCDBinaryValueType(prop.type, prop.size), prop.count, pointSize, prop.pmType, prop.pmRowID));
+			pointSize += prop.size * prop.count;
+		}
+
+		if (header.dataType == "binary")
+		{
+			readBinaryPoints<T>(is, fields, pointSize, nbPoints, isBigEndian, features, descriptors, times);
+		}
+		else
+		{
+			ConverterToAndFromBytes<std::uint32_t> compressedSize, uncompressedSize;
+			if (!(is >> compressedSize >> uncompressedSize))
+				throw runtime_error("PCD Parse Error: missing sizes of binary_compressed data");
+			if (isBigEndian)
+			{
+				compressedSize.swapBytes();
+				uncompressedSize.swapBytes();
+			}
+			if (uncompressedSize.v != pointSize * nbPoints)
+				throw runtime_error("PCD Parse Error: the size of binary_compressed data does not match the number of points");
+
+			vector<unsigned char> compressed(compressedSize.v);
+			if (!is.read(reinterpret_cast<char*>(compressed.data()), compressed.size()))
+				throw runtime_error("PCD Parse Error: binary_compressed data is shorter than announced");
+			vector<unsigned char> uncompressed(uncompressedSize.v);
+			decompressLZF(compressed.data(), compressed.size(), uncompressed.data(), uncompressed.size());
+			vector<unsigned char>().swap(compressed);
+
+			convertBinaryPoints<T>(reinterpret_cast<const char*>(uncompressed.data()), fields, pointSize, true, nbPoints, isBigEndian, 0, nbPoints, features, descriptors, times);
+		}
+		col = nbPoints;
+	}
+	while (col < nbPoints && safeGetLine(is, line))
 	{
 
 		// get rid of white spaces before/after
@@ -2230,33 +2792,30 @@ typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPCD(std::istream&
 	///////////////////////////
 	// 5- ASSEMBLE FINAL DATAPOINTS
 	
-	DataPoints loadedPoints(features, featLabelGen.getLabels());
+	// the matrices are moved, not copied
+	DataPoints loadedPoints;
+	loadedPoints.features.swap(features);
+	loadedPoints.featureLabels = featLabelGen.getLabels();
 
 	if (descriptors.rows() > 0)
 	{
-		loadedPoints.descriptors = descriptors;
+		loadedPoints.descriptors.swap(descriptors);
 		loadedPoints.descriptorLabels = descLabelGen.getLabels();
 	}
 
 	if(times.rows() > 0)
 	{
-		loadedPoints.times = times;
+		loadedPoints.times.swap(times);
 		loadedPoints.timeLabels = timeLabelGen.getLabels();	
 	}
 
-	// Ensure homogeous coordinates
-	if(!loadedPoints.featureExists("pad"))
-	{
-		loadedPoints.addFeature("pad", Matrix::Ones(1,features.cols()));
-	}
-
 	return loadedPoints;
 }
 
 template<typename T>
 void PointMatcherIO<T>::savePCD(const DataPoints& data,
-		const std::string& fileName) {
-	ofstream ofs(fileName.c_str());
+		const std::string& fileName, bool binary) {
+	ofstream ofs(fileName.c_str(), binary ? std::ios::out | std::ios::binary : std::ios::out);
 	if (!ofs.good())
 		throw runtime_error(string("Cannot open file ") + fileName);
 
@@ -2290,10 +2849,12 @@ void PointMatcherIO<T>::savePCD(const DataPoints& data,
 		ofs << "\n";
 	}
 
+	// binary files are written with the precision of T
+	const int valueSize(binary ? sizeof(T) : 4);
 	ofs << "SIZE";
 	for (int i =0; i < featCount - 1 + descCount; i++)
 	{
-		ofs << " 4"; // for float
+		ofs << " " << valueSize;
 	}
 	ofs << "\n";
 
@@ -2321,7 +2882,21 @@ void PointMatcherIO<T>::savePCD(const DataPoints& data,
 	ofs << "WIDTH " << pointCount << "\n";
 	ofs << "HEIGHT 1\n";
 	ofs << "POINTS " << pointCount << "\n";
-	ofs << "DATA ascii\n";
+	ofs << "DATA " << (binary ? "binary" : "ascii") << "\n";
+
+	if (binary)
+	{
+		// PCD binary data is little endian, every point being stored contiguously
+		for (int p = 0; p < pointCount; ++p)
+		{
+			for (int f = 0; f < featCount - 1; ++f)
+				writeBinaryValue<T>(ofs, data.features(f, p), isBigEndian);
+			for (int d = 0; d < descRows; ++d)
+				writeBinaryValue<T>(ofs, data.descriptors(d, p), isBigEndian);
+		}
+		ofs.close();
+		return;
+	}
 
 	// write points
 	for (int p = 0; p < pointCount; ++p)
@@ -2345,9 +2920,943 @@ void PointMatcherIO<T>::savePCD(const DataPoints& data,
 }
 
 template
-void PointMatcherIO<float>::savePCD(const DataPoints& data, const std::string& fileName);
+void PointMatcherIO<float>::savePCD(const DataPoints& data, const std::string& fileName, bool binary);
 template
-void PointMatcherIO<double>::savePCD(const DataPoints& data, const std::string& fileName);
+void PointMatcherIO<double>::savePCD(const DataPoints& data, const std::string& fileName, bool binary);
+
+
+
+// PMB, the native binary format
+
+namespace
+{
+	//! Magic number starting a PMB file
+	const char pmbMagic[4] = {'P', 'M', 'D', 'P'};
+	//! Marker written in the byte order of the writer, used to detect files written on a machine of the other endianness
+	const uint32_t pmbByteOrderMark(0x01020304);
+	//! Version of the PMB format written by this library
+	const uint32_t pmbVersion(1);
+
+	//! Encoding of a PMB channel block
+	enum PMBCompression
+	{
+		PMB_RAW = 0, //!< values stored as in memory
+		PMB_SHUFFLED_LZF = 1 //!< bytes grouped by significance then compressed with LZF
+	};
+
+	//! Location and encoding of the block of a channel in a PMB file
+	struct PMBBlock
+	{
+		uint8_t compression; //!< a PMBCompression
+		uint64_t offset; //!< offset of the block from the end of the header
+		uint64_t storedSize; //!< size of the block in the file
+		std::vector<unsigned char> compressed; //!< compressed content, only used when writing
+	};
+
+	//! A descriptor or time channel of a PMB file
+	struct PMBChannel
+	{
+		std::string name; //!< label of the channel
+		uint32_t span; //!< number of rows of the channel
+		PMBBlock block; //!< where the channel is stored
+	};
+
+	//! Write a value in host byte order
+	template<typename V>
+	void writePMBValue(std::ostream& os, const V value)
+	{
+		os.write(reinterpret_cast<const char*>(&value), sizeof(V));
+	}
+
+	//! Write a string prefixed by its length
+	void writePMBString(std::ostream& os, const std::string& text)
+	{
+		writePMBValue<uint32_t>(os, text.size());
+		os.write(text.data(), text.size());
+	}
+
+	//! Write the location and encoding of a block
+	void writePMBBlock(std::ostream& os, const PMBBlock& block)
+	{
+		writePMBValue<uint8_t>(os, block.compression);
+		writePMBValue<uint64_t>(os, block.offset);
+		writePMBValue<uint64_t>(os, block.storedSize);
+	}
+
+	//! Read a value, swapping its bytes if the file was written with the other endianness
+	template<typename V>
+	V readPMBValue(std::istream& is, const bool swapBytes)
+	{
+		ConverterToAndFromBytes<V> converter;
+		if (!is.read(converter.bytes, sizeof(V)))
+			throw runtime_error("PMB Parse Error: unexpected end of file in header");
+		if (swapBytes)
+			converter.swapBytes();
+		return converter.v;
+	}
 
+	//! Read a string prefixed by its length
+	std::string readPMBString(std::istream& is, const bool swapBytes)
+	{
+		const uint32_t length(readPMBValue<uint32_t>(is, swapBytes));
+		std::string text(length, '\0');
+		if (length && !is.read(&text[0], length))
+			throw runtime_error("PMB Parse Error: unexpected end of file in header");
+		return text;
+	}
+
+	//! Read the location and encoding of a block
+	PMBBlock readPMBBlock(std::istream& is, const bool swapBytes)
+	{
+		PMBBlock block;
+		block.compression = readPMBValue<uint8_t>(is, swapBytes);
+		block.offset = readPMBValue<uint64_t>(is, swapBytes);
+		block.storedSize = readPMBValue<uint64_t>(is, swapBytes);
+		if (block.compression != PMB_RAW && block.compression != PMB_SHUFFLED_LZF)
+			throw runtime_error((boost::format("PMB Parse Error: unknown compression %1%") % unsigned(block.compression)).str());
+		return block;
+	}
+
+	//! Compress size bytes of values of valueSize bytes into block if requested and worth it, otherwise mark block as raw
+	void encodePMBBlock(const unsigned char* data, const size_t size, const size_t valueSize, const bool compress, PMBBlock& block)
+	{
+		block.compression = PMB_RAW;
+		block.storedSize = size;
+		if (!compress || size == 0)
+			return;
+
+		// group the bytes of same significance, which makes slowly varying values much more compressible
+		const size_t count(size / valueSize);
+		std::vector<unsigned char> shuffled(size);
+		for (size_t i = 0; i < count; ++i)
+			for (size_t b = 0; b < valueSize; ++b)
+				shuffled[b * count + i] = data[i * valueSize + b];
+
+		block.compressed.resize(size + size / 32 + 16);
+		const size_t compressedSize(compressLZF(shuffled.data(), size, block.compressed.data()));
+		if (compressedSize < size)
+		{
+			block.compression = PMB_SHUFFLED_LZF;
+			block.storedSize = compressedSize;
+			block.compressed.resize(compressedSize);
+		}
+		else
+			block.compressed.clear();
+	}
+
+	//! Return a pointer to the span rows of matrix starting at row, copying them to buffer if they are not contiguous
+	template<typename M>
+	const unsigned char* getPMBChannelData(const M& matrix, const size_t row, const size_t span, M& buffer)
+	{
+		if (row == 0 && span == size_t(matrix.rows()))
+			return reinterpret_cast<const unsigned char*>(matrix.data());
+		buffer = matrix.middleRows(row, span);
+		return reinterpret_cast<const unsigned char*>(buffer.data());
+	}
+
+	//! Write the content of a block
+	void writePMBBlockData(std::ostream& os, const unsigned char* data, const PMBBlock& block)
+	{
+		if (block.compression == PMB_RAW)
+			os.write(reinterpret_cast<const char*>(data), block.storedSize);
+		else
+			os.write(reinterpret_cast<const char*>(block.compressed.data()), block.storedSize);
+	}
+
+	//! Reverse the bytes of each of the size / valueSize values of data
+	void swapPMBValues(unsigned char* data, const size_t size, const size_t valueSize)
+	{
+		for (unsigned char* value = data; value < data + size; value += valueSize)
+			std::reverse(value, value + valueSize);
+	}
+
+	//! Move is forward to offset, tracking the current position relative to the end of the header
+	void skipPMBTo(std::istream& is, const uint64_t offset, uint64_t& position)
+	{
+		if (offset < position)
+			throw runtime_error("PMB Parse Error: channel blocks are not in header order");
+		if (offset > position)
+		{
+			// seek when possible, so that skipped channels are never read
+			if (!is.seekg(offset - position, std::ios::cur))
+			{
+				is.clear();
+				is.ignore(offset - position);
+			}
+			position = offset;
+		}
+	}
+
+	//! Load a block of span rows, stored with values of valueSize bytes, into matrix starting at row
+	template<typename M>
+	void loadPMBBlock(std::istream& is, const PMBBlock& block, const bool swapBytes, const size_t valueSize, M& matrix, const size_t row, const size_t span, uint64_t& position)
+	{
+		typedef typename M::Scalar Scalar;
+		const size_t count(span * matrix.cols());
+		const size_t size(count * valueSize);
+		skipPMBTo(is, block.offset, position);
+
+		if (block.compression == PMB_RAW && block.storedSize != size)
+			throw runtime_error("PMB Parse Error: channel block has an unexpected size");
+
+		// fast path, read the values straight into the matrix
+		if (block.compression == PMB_RAW && valueSize == sizeof(Scalar) && row == 0 && span == size_t(matrix.rows()))
+		{
+			unsigned char* data(reinterpret_cast<unsigned char*>(matrix.data()));
+			if (!is.read(reinterpret_cast<char*>(data), size))
+				throw runtime_error("PMB Parse Error: unexpected end of file in channel data");
+			position += size;
+			if (swapBytes)
+				swapPMBValues(data, size, valueSize);
+			return;
+		}
+
+		std::vector<unsigned char> stored(block.storedSize);
+		if (!is.read(reinterpret_cast<char*>(stored.data()), block.storedSize))
+			throw runtime_error("PMB Parse Error: unexpected end of file in channel data");
+		position += block.storedSize;
+
+		std::vector<unsigned char> values;
+		if (block.compression == PMB_RAW)
+			values.swap(stored);
+		else
+		{
+			std::vector<unsigned char> shuffled(size);
+			decompressLZF(stored.data(), stored.size(), shuffled.data(), size);
+			values.resize(size);
+			for (size_t i = 0; i < count; ++i)
+				for (size_t b = 0; b < valueSize; ++b)
+					values[i * valueSize + b] = shuffled[b * count + i];
+		}
+		if (swapBytes)
+			swapPMBValues(values.data(), size, valueSize);
 
+		if (valueSize == sizeof(Scalar))
+			matrix.middleRows(row, span) = Eigen::Map<const Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> >(reinterpret_cast<const Scalar*>(values.data()), span, matrix.cols());
+		else if (valueSize == sizeof(float))
+			matrix.middleRows(row, span) = Eigen::Map<const Eigen::MatrixXf>(reinterpret_cast<const float*>(values.data()), span, matrix.cols()).template cast<Scalar>();
+		else
+			matrix.middleRows(row, span) = Eigen::Map<const Eigen::MatrixXd>(reinterpret_cast<const double*>(values.data()), span, matrix.cols()).template cast<Scalar>();
+	}
+
+	//! Load a PMB file, restricting descriptors and times to channels if not null
+	template<typename T>
+	typename PointMatcher<T>::DataPoints loadPMBChannels(std::istream& is, const std::vector<std::string>* channels)
+	{
+		typedef typename PointMatcher<T>::DataPoints DataPoints;
+		typedef typename DataPoints::Label Label;
+		typedef typename DataPoints::Labels Labels;
+
+		char magic[4];
+		if (!is.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), pmbMagic))
+			throw runtime_error("PMB Parse Error: not a libpointmatcher binary file");
+
+		const uint32_t byteOrderMark(readPMBValue<uint32_t>(is, false));
+		bool swapBytes(false);
+		if (byteOrderMark != pmbByteOrderMark)
+		{
+			ConverterToAndFromBytes<uint32_t> converter(byteOrderMark);
+			converter.swapBytes();
+			if (converter.v != pmbByteOrderMark)
+				throw runtime_error("PMB Parse Error: invalid byte order mark");
+			swapBytes = true;
+		}
+
+		const uint32_t version(readPMBValue<uint32_t>(is, swapBytes));
+		if (version != pmbVersion)
+			throw runtime_error((boost::format("PMB Parse Error: unsupported version %1%") % version).str());
+		const uint32_t scalarSize(readPMBValue<uint32_t>(is, swapBytes));
+		if (scalarSize != sizeof(float) && scalarSize != sizeof(double))
+			throw runtime_error((boost::format("PMB Parse Error: unsupported scalar size %1%") % scalarSize).str());
+		const uint64_t pointCount(readPMBValue<uint64_t>(is, swapBytes));
+
+		Labels featureLabels;
+		const uint32_t featureLabelCount(readPMBValue<uint32_t>(is, swapBytes));
+		for (uint32_t i = 0; i < featureLabelCount; ++i)
+		{
+			const std::string name(readPMBString(is, swapBytes));
+			featureLabels.push_back(Label(name, readPMBValue<uint32_t>(is, swapBytes)));
+		}
+		const PMBBlock featureBlock(readPMBBlock(is, swapBytes));
+
+		std::vector<PMBChannel> channelsInFile[2];
+		for (int kind = 0; kind < 2; ++kind)
+		{
+			const uint32_t channelCount(readPMBValue<uint32_t>(is, swapBytes));
+			for (uint32_t i = 0; i < channelCount; ++i)
+			{
+				PMBChannel channel;
+				channel.name = readPMBString(is, swapBytes);
+				channel.span = readPMBValue<uint32_t>(is, swapBytes);
+				channel.block = readPMBBlock(is, swapBytes);
+				channelsInFile[kind].push_back(channel);
+			}
+		}
+		std::vector<PMBChannel>& descriptorChannels(channelsInFile[0]);
+		std::vector<PMBChannel>& timeChannels(channelsInFile[1]);
+
+		// select requested channels, keeping the file order
+		std::vector<bool> selected[2];
+		for (int kind = 0; kind < 2; ++kind)
+			selected[kind].resize(channelsInFile[kind].size(), channels == nullptr);
+		if (channels)
+		{
+			for (const std::string& name: *channels)
+			{
+				bool found(false);
+				for (int kind = 0; kind < 2; ++kind)
+					for (size_t i = 0; i < channelsInFile[kind].size(); ++i)
+						if (channelsInFile[kind][i].name == name)
+						{
+							selected[kind][i] = true;
+							found = true;
+						}
+				if (!found)
+					throw runtime_error("PMB Parse Error: no channel named \"" + name + "\" in file");
+			}
+		}
+
+		Labels descriptorLabels;
+		for (size_t i = 0; i < descriptorChannels.size(); ++i)
+			if (selected[0][i])
+				descriptorLabels.push_back(Label(descriptorChannels[i].name, descriptorChannels[i].span));
+		Labels timeLabels;
+		for (size_t i = 0; i < timeChannels.size(); ++i)
+			if (selected[1][i])
+				timeLabels.push_back(Label(timeChannels[i].name, timeChannels[i].span));
+
+		DataPoints cloud(featureLabels, descriptorLabels, timeLabels, pointCount);
+
+		uint64_t position(0);
+		loadPMBBlock(is, featureBlock, swapBytes, scalarSize, cloud.features, 0, cloud.features.rows(), position);
+		size_t row(0);
+		for (size_t i = 0; i < descriptorChannels.size(); ++i)
+		{
+			if (!selected[0][i])
+				continue;
+			loadPMBBlock(is, descriptorChannels[i].block, swapBytes, scalarSize, cloud.descriptors, row, descriptorChannels[i].span, position);
+			row += descriptorChannels[i].span;
+		}
+		row = 0;
+		for (size_t i = 0; i < timeChannels.size(); ++i)
+		{
+			if (!selected[1][i])
+				continue;
+			loadPMBBlock(is, timeChannels[i].block, swapBytes, sizeof(int64_t), cloud.times, row, timeChannels[i].span, position);
+			row += timeChannels[i].span;
+		}
+
+		return cloud;
+	}
+}
+
+//! @brief Load a point cloud in the native libpointmatcher binary format (pmb)
+//! @param fileName a string containing the path and the file name
+//!
+//! The file holds the complete label schema in its header followed by one
+//! column-major block per channel: all the features, then each descriptor and
+//! each time label. Files written on a machine of the other endianness or with
+//! another scalar type are converted while loading.
+template<typename T>
+typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPMB(const std::string& fileName)
+{
+	ifstream ifs(fileName.c_str(), std::ios::in | std::ios::binary);
+	if (!ifs.good())
+		throw runtime_error(string("Cannot open file ") + fileName);
+	return loadPMB(ifs);
+}
+
+template
+PointMatcherIO<float>::DataPoints PointMatcherIO<float>::loadPMB(const string& fileName);
+template
+PointMatcherIO<double>::DataPoints PointMatcherIO<double>::loadPMB(const string& fileName);
+
+//! @brief Load the features and the named descriptor and time channels of a pmb file
+//! @param fileName a string containing the path and the file name
+//! @param channels names of the descriptors and times to load, the blocks of the other channels are skipped without being read
+template<typename T>
+typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPMB(const std::string& fileName, const std::vector<std::string>& channels)
+{
+	ifstream ifs(fileName.c_str(), std::ios::in | std::ios::binary);
+	if (!ifs.good())
+		throw runtime_error(string("Cannot open file ") + fileName);
+	return loadPMB(ifs, channels);
+}
+
+template
+PointMatcherIO<float>::DataPoints PointMatcherIO<float>::loadPMB(const string& fileName, const std::vector<std::string>& channels);
+template
+PointMatcherIO<double>::DataPoints PointMatcherIO<double>::loadPMB(const string& fileName, const std::vector<std::string>& channels);
+
+template<typename T>
+typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPMB(std::istream& is)
+{
+	return loadPMBChannels<T>(is, nullptr);
+}
+
+template
+PointMatcherIO<float>::DataPoints PointMatcherIO<float>::loadPMB(std::istream& is);
+template
+PointMatcherIO<double>::DataPoints PointMatcherIO<double>::loadPMB(std::istream& is);
+
+template<typename T>
+typename PointMatcherIO<T>::DataPoints PointMatcherIO<T>::loadPMB(std::istream& is, const std::vector<std::string>& channels)
+{
+	return loadPMBChannels<T>(is, &channels);
+}
+
+template
+PointMatcherIO<float>::DataPoints PointMatcherIO<float>::loadPMB(std::istream& is, const std::vector<std::string>& channels);
+template
+PointMatcherIO<double>::DataPoints PointMatcherIO<double>::loadPMB(std::istream& is, const std::vector<std::string>& channels);
+
+//! Save a point cloud in the native libpointmatcher binary format, optionally compressing each channel
+template<typename T>
+void PointMatcherIO<T>::savePMB(const DataPoints& data, const std::string& fileName, bool compress)
+{
+	ofstream ofs(fileName.c_str(), std::ios::out | std::ios::binary);
+	if (!ofs.good())
+		throw runtime_error(string("Cannot open file ") + fileName);
+	savePMB(data, ofs, compress);
+	ofs.close();
+}
+
+template
+void PointMatcherIO<float>::savePMB(const DataPoints& data, const std::string& fileName, bool compress);
+template
+void PointMatcherIO<double>::savePMB(const DataPoints& data, const std::string& fileName, bool compress);
+
+template<typename T>
+void PointMatcherIO<T>::savePMB(const DataPoints& data, std::ostream& os, bool compress)
+{
+	const size_t pointCount(data.features.cols());
+	Matrix matrixBuffer;
+	Int64Matrix int64Buffer;
+
+	// compressed blocks must be known before writing the header, as it holds their offsets
+	PMBBlock featureBlock;
+	encodePMBBlock(reinterpret_cast<const unsigned char*>(data.features.data()), data.features.size() * sizeof(T), sizeof(T), compress, featureBlock);
+	uint64_t offset(featureBlock.storedSize);
+	featureBlock.offset = 0;
+
+	std::vector<PMBChannel> descriptorChannels;
+	size_t row(0);
+	for (const Label& label: data.descriptorLabels)
+	{
+		PMBChannel channel;
+		channel.name = label.text;
+		channel.span = label.span;
+		encodePMBBlock(getPMBChannelData(data.descriptors, row, label.span, matrixBuffer), label.span * pointCount * sizeof(T), sizeof(T), compress, channel.block);
+		channel.block.offset = offset;
+		offset += channel.block.storedSize;
+		row += label.span;
+		descriptorChannels.push_back(channel);
+	}
+
+	std::vector<PMBChannel> timeChannels;
+	row = 0;
+	for (const Label& label: data.timeLabels)
+	{
+		PMBChannel channel;
+		channel.name = label.text;
+		channel.span = label.span;
+		encodePMBBlock(getPMBChannelData(data.times, row, label.span, int64Buffer), label.span * pointCount * sizeof(int64_t), sizeof(int64_t), compress, channel.block);
+		channel.block.offset = offset;
+		offset += channel.block.storedSize;
+		row += label.span;
+		timeChannels.push_back(channel);
+	}
+
+	// header
+	os.write(pmbMagic, sizeof(pmbMagic));
+	writePMBValue<uint32_t>(os, pmbByteOrderMark);
+	writePMBValue<uint32_t>(os, pmbVersion);
+	writePMBValue<uint32_t>(os, sizeof(T));
+	writePMBValue<uint64_t>(os, pointCount);
+	writePMBValue<uint32_t>(os, data.featureLabels.size());
+	for (const Label& label: data.featureLabels)
+	{
+		writePMBString(os, label.text);
+		writePMBValue<uint32_t>(os, label.span);
+	}
+	writePMBBlock(os, featureBlock);
+	for (const std::vector<PMBChannel>* channels: {&descriptorChannels, &timeChannels})
+	{
+		writePMBValue<uint32_t>(os, channels->size());
+		for (const PMBChannel& channel: *channels)
+		{
+			writePMBString(os, channel.name);
+			writePMBValue<uint32_t>(os, channel.span);
+			writePMBBlock(os, channel.block);
+		}
+	}
+
+	// channel blocks, raw ones being written straight from the matrices
+	writePMBBlockData(os, reinterpret_cast<const unsigned char*>(data.features.data()), featureBlock);
+	row = 0;
+	for (const PMBChannel& channel: descriptorChannels)
+	{
+		writePMBBlockData(os, channel.block.compression == PMB_RAW ? getPMBChannelData(data.descriptors, row, channel.span, matrixBuffer) : nullptr, channel.block);
+		row += channel.span;
+	}
+	row = 0;
+	for (const PMBChannel& channel: timeChannels)
+	{
+		writePMBBlockData(os, channel.block.compression == PMB_RAW ? getPMBChannelData(data.times, row, channel.span, int64Buffer) : nullptr, channel.block);
+		row += channel.span;
+	}
+
+	if (!os.good())
+		throw runtime_error("PMB Write Error: cannot write point cloud");
+}
+
+template
+void PointMatcherIO<float>::savePMB(const DataPoints& data, std::ostream& os, bool compress);
+template
+void PointMatcherIO<double>::savePMB(const DataPoints& data, std::ostream& os, bool compress);
+
+// Chunked reading
+
+template<typename T>
+PointMatcherIO<T>::CSVChunkReader::CSVChunkReader(const std::string& fileName, const size_t chunkSize):
+	file(fileName.c_str()),
+	is(file),
+	chunkSize(chunkSize),
+	addedPad(false),
+	csvRow(0),
+	ended(false)
+{
+	validateFile(fileName);
+	readHeader();
+}
+
+template<typename T>
+PointMatcherIO<T>::CSVChunkReader::CSVChunkReader(std::istream& is, const size_t chunkSize):
+	is(is),
+	chunkSize(chunkSize),
+	addedPad(false),
+	csvRow(0),
+	ended(false)
+{
+	readHeader();
+}
+
+//! Read the first line, building the labels shared by all chunks
+template<typename T>
+void PointMatcherIO<T>::CSVChunkReader::readHeader()
+{
+	if (chunkSize == 0)
+		throw runtime_error("CSVChunkReader: chunks must hold at least one point");
+
+	string line;
+	if (!safeGetLine(is, line) || line.empty())
+	{
+		ended = true;
+		return;
+	}
+
+	LabelGenerator featLabelGen, descLabelGen, timeLabelGen;
+	if (!parseCSVHeader(line, csvHeader, featLabelGen, descLabelGen, timeLabelGen))
+		pendingLine = line;
+
+	featureLabels = featLabelGen.getLabels();
+	descriptorLabels = descLabelGen.getLabels();
+	timeLabels = timeLabelGen.getLabels();
+
+	// Ensure homogeous coordinates
+	if (!featureLabels.contains("pad"))
+	{
+		featureLabels.push_back(Label("pad", 1));
+		addedPad = true;
+	}
+}
+
+template<typename T>
+bool PointMatcherIO<T>::CSVChunkReader::read(DataPoints& chunk)
+{
+	if (ended && pendingLine.empty())
+		return false;
+
+	Matrix features(featureLabels.totalDim(), chunkSize);
+	Matrix descriptors(descriptorLabels.totalDim(), chunkSize);
+	Int64Matrix times(timeLabels.totalDim(), chunkSize);
+
+	size_t count(0);
+	if (!pendingLine.empty())
+	{
+		parseCSVLine(pendingLine.data(), pendingLine.data() + pendingLine.size(), csvHeader, csvRow++, count++, features, descriptors, times);
+		pendingLine.clear();
+	}
+
+	string line;
+	while (!ended && count < chunkSize)
+	{
+		// Stop at the first empty line, as loadCSV() does
+		if (!safeGetLine(is, line) || line.empty())
+			ended = true;
+		else
+			parseCSVLine(line.data(), line.data() + line.size(), csvHeader, csvRow++, count++, features, descriptors, times);
+	}
+	if (count == 0)
+		return false;
+
+	if (addedPad)
+		features.bottomRows(1).setOnes();
+	features.conservativeResize(Eigen::NoChange, count);
+	chunk = DataPoints(features, featureLabels);
+	if (descriptors.rows() > 0)
+	{
+		chunk.descriptors = descriptors.leftCols(count);
+		chunk.descriptorLabels = descriptorLabels;
+	}
+	if (times.rows() > 0)
+	{
+		chunk.times = times.leftCols(count);
+		chunk.timeLabels = timeLabels;
+	}
+	return true;
+}
+
+template class PointMatcherIO<float>::CSVChunkReader;
+template class PointMatcherIO<double>::CSVChunkReader;
+
+template<typename T>
+PointMatcherIO<T>::VTKChunkReader::VTKChunkReader(const std::string& fileName, const size_t chunkSize):
+	file(fileName.c_str(), std::ios::in | std::ios::binary),
+	is(file),
+	chunkSize(chunkSize),
+	isBinary(false),
+	pointCount(0),
+	nextPoint(0)
+{
+	if (!file.good())
+		throw runtime_error(string("Cannot open file ") + fileName);
+	scan();
+}
+
+template<typename T>
+PointMatcherIO<T>::VTKChunkReader::VTKChunkReader(std::istream& is, const size_t chunkSize):
+	is(is),
+	chunkSize(chunkSize),
+	isBinary(false),
+	pointCount(0),
+	nextPoint(0)
+{
+	scan();
+}
+
+//! Skip count values of binarySize bytes if the file is binary, or count ASCII values otherwise
+template<typename T>
+void PointMatcherIO<T>::VTKChunkReader::skipValues(const size_t count, const size_t binarySize)
+{
+	if (isBinary)
+		is.seekg(count * binarySize, std::ios_base::cur);
+	else
+	{
+		string value;
+		for (size_t i = 0; i < count; ++i)
+			is >> value;
+	}
+	if (!is)
+		throw runtime_error("VTK parse error: unexpected end of file");
+}
+
+//! Go through the header and data of the file to locate the attributes and build the labels of the chunks, as loadVTK() does
+template<typename T>
+void PointMatcherIO<T>::VTKChunkReader::scan()
+{
+	if (chunkSize == 0)
+		throw runtime_error("VTKChunkReader: chunks must hold at least one point");
+
+	// parse header
+	string line;
+	safeGetLine(is, line);
+	if (line.find("# vtk DataFile Version") != 0)
+		throw runtime_error(string("Wrong magic header, found ") + line);
+	safeGetLine(is, line);
+	safeGetLine(is, line);
+
+	isBinary = (line == "BINARY");
+	if (line != "ASCII" && !isBinary)
+		throw runtime_error(string("Wrong file type, expecting ASCII or BINARY, found ") + line);
+	safeGetLine(is, line);
+
+	SupportedVTKDataTypes dataType;
+	if (line == "DATASET POLYDATA")
+		dataType = POLYDATA;
+	else if (line == "DATASET UNSTRUCTURED_GRID")
+		dataType = UNSTRUCTURED_GRID;
+	else
+		throw runtime_error(string("Wrong data type, expecting DATASET POLYDATA, found ") + line);
+
+	// locate points, descriptors and time
+	std::map<std::string, std::pair<bool, bool> > splitTimes; // whether high and low 32 bits were found
+	std::vector<std::string> timeNames; // name of the time of every time section
+	string fieldName;
+	string name;
+	string type;
+	int dim = 0;
+
+	while (is >> fieldName)
+	{
+		if (fieldName == "POINTS")
+		{
+			is >> pointCount;
+			is >> type;
+			safeGetLine(is, line); // remove line end after parameters!
+
+			if (!(type == "float" || type == "double"))
+				throw runtime_error(string("Field POINTS can only be of type double or float"));
+
+			const Section section = {POINTS, type, 3, 0, is.tellg()};
+			sections.push_back(section);
+			skipValues(3 * pointCount, type == "double" ? 8 : 4);
+		}
+		else if ((dataType == POLYDATA && (fieldName == "VERTICES" || fieldName == "LINES" || fieldName == "POLYGONS" || fieldName == "TRIANGLE_STRIPS")) ||
+			(dataType == UNSTRUCTURED_GRID && fieldName == "CELLS"))
+		{
+			skipBlock(isBinary, 4, is);
+		}
+		else if (dataType == UNSTRUCTURED_GRID && fieldName == "CELL_TYPES")
+		{
+			skipBlock(isBinary, 4, is, false);
+		}
+		else if (fieldName == "POINT_DATA")
+		{
+			size_t descriptorCount;
+			is >> descriptorCount;
+			if (pointCount != descriptorCount)
+				throw runtime_error(string("The size of POINTS is different than POINT_DATA"));
+		}
+		else if (fieldName == "FIELD")
+		{
+			string fieldDataName;
+			int fieldDataCount;
+			is >> fieldDataName >> fieldDataCount;
+
+			for (int f = 0; f < fieldDataCount; f++)
+			{
+				int numTuples;
+				is >> name >> dim >> numTuples >> type;
+				if (isBinary)
+					safeGetLine(is, line);
+
+				if (type == "vtkIdType") // skip that type
+				{
+					skipValues(dim * numTuples, 4);
+					continue;
+				}
+				else if (!(type == "float" || type == "double"))
+					throw runtime_error(string("Field " + fieldName + " is " + type + " but can only be of type double or float"));
+
+				const Section section = {DESCRIPTOR_DATA, type, dim, int(descriptorLabels.totalDim()), is.tellg()};
+				sections.push_back(section);
+				descriptorLabels.push_back(Label(name, dim));
+				skipValues(dim * pointCount, type == "double" ? 8 : 4);
+			}
+		}
+		else if (fieldName == "METADATA") // Skip METADATA block
+		{
+			safeGetLine(is, line);
+			safeGetLine(is, line);
+			while (!line.empty())
+				safeGetLine(is, line);
+		}
+		else // Locate descriptors or time
+		{
+			is >> name;
+
+			bool isTimeSec = false;
+			bool isTimeNsec = false;
+			if (boost::algorithm::ends_with(name, "_splitTime_high32"))
+			{
+				isTimeSec = true;
+				boost::algorithm::erase_last(name, "_splitTime_high32");
+			}
+			if (boost::algorithm::ends_with(name, "_splitTime_low32"))
+			{
+				isTimeNsec = true;
+				boost::algorithm::erase_last(name, "_splitTime_low32");
+			}
+
+			bool skipLookupTable = false;
+			bool isColorScalars = false;
+			if (fieldName == "SCALARS")
+			{
+				dim = 1;
+				is >> type;
+				skipLookupTable = true;
+			}
+			else if (fieldName == "VECTORS" || fieldName == "NORMALS")
+			{
+				dim = 3;
+				is >> type;
+			}
+			else if (fieldName == "TENSORS")
+			{
+				dim = 9;
+				is >> type;
+			}
+			else if (fieldName == "COLOR_SCALARS")
+			{
+				is >> dim;
+				type = "float";
+				isColorScalars = true;
+			}
+			else
+				throw runtime_error(string("Unknown field name " + fieldName + ", expecting SCALARS, VECTORS, TENSORS, NORMALS or COLOR_SCALARS."));
+
+			safeGetLine(is, line); // remove rest of the parameter line including its line end;
+
+			if (isTimeSec || isTimeNsec)
+			{
+				if (skipLookupTable)
+					safeGetLine(is, line);
+
+				std::pair<bool, bool>& found(splitTimes[name]);
+				(isTimeSec ? found.first : found.second) = true;
+				const Section section = {isTimeSec ? TIME_HIGH32 : TIME_LOW32, type, dim, 0, is.tellg()};
+				sections.push_back(section);
+				timeNames.push_back(name);
+				skipValues(dim * pointCount, type == "double" ? 8 : 4);
+			}
+			else if (isColorScalars && isBinary)
+			{
+				const Section section = {COLOR_DATA, type, dim, int(descriptorLabels.totalDim()), is.tellg()};
+				sections.push_back(section);
+				descriptorLabels.push_back(Label(name, dim));
+				skipValues(dim * pointCount, 1);
+			}
+			else
+			{
+				if (!(type == "float" || type == "double"))
+					throw runtime_error(string("Field " + fieldName + " is " + type + " but can only be of type double or float."));
+
+				if (skipLookupTable)
+					safeGetLine(is, line);
+
+				const Section section = {DESCRIPTOR_DATA, type, dim, int(descriptorLabels.totalDim()), is.tellg()};
+				sections.push_back(section);
+				descriptorLabels.push_back(Label(name, dim));
+				skipValues(dim * pointCount, type == "double" ? 8 : 4);
+			}
+		}
+	}
+
+	// Times are added in the order of their names, as loadVTK() does
+	std::map<std::string, int> timeRows;
+	for (typename std::map<std::string, std::pair<bool, bool> >::const_iterator it = splitTimes.begin(); it != splitTimes.end(); ++it)
+	{
+		if (!it->second.first)
+			throw runtime_error(string("Missing time field representing the higher 32 bits. Expecting SCALARS with name " + it->first + "_splitTime_high32 in the VTK file."));
+		if (!it->second.second)
+			throw runtime_error(string("Missing time field representing the lower 32 bits. Expecting SCALARS with name " + it->first + "_splitTime_low32 in the VTK file."));
+		timeRows[it->first] = timeLabels.size();
+		timeLabels.push_back(Label(it->first, 1));
+	}
+	size_t timeSection(0);
+	for (Section& section: sections)
+	{
+		if (section.sectionType == TIME_HIGH32 || section.sectionType == TIME_LOW32)
+			section.row = timeRows[timeNames[timeSection++]];
+	}
+
+	is.clear();
+}
+
+template<typename T>
+bool PointMatcherIO<T>::VTKChunkReader::read(DataPoints& chunk)
+{
+	if (nextPoint >= pointCount)
+		return false;
+
+	typedef Eigen::Matrix<unsigned int, Eigen::Dynamic, Eigen::Dynamic> UIntMatrix;
+
+	const size_t count(std::min(chunkSize, pointCount - nextPoint));
+	Matrix features(4, count);
+	features.row(3).setOnes();
+	Matrix descriptors(descriptorLabels.totalDim(), count);
+	std::vector<UIntMatrix> high32(timeLabels.size());
+	std::vector<UIntMatrix> low32(timeLabels.size());
+
+	// read the next points of every attribute
+	for (Section& section: sections)
+	{
+		is.clear();
+		is.seekg(section.position);
+		switch (section.sectionType)
+		{
+			case POINTS:
+				readVtkData(section.type, isBinary, features.topRows(3).transpose(), is);
+				break;
+			case DESCRIPTOR_DATA:
+				readVtkData(section.type, isBinary, descriptors.middleRows(section.row, section.dim).transpose(), is);
+				break;
+			case COLOR_DATA:
+			{
+				std::vector<unsigned char> buffer(section.dim * count);
+				is.read(reinterpret_cast<char *>(buffer.data()), buffer.size());
+				for (size_t i = 0; i < count; ++i)
+					for (int r = 0; r < section.dim; ++r)
+						descriptors(section.row + r, i) = buffer[i * section.dim + r] / static_cast<T>(255.0);
+				break;
+			}
+			case TIME_HIGH32:
+			case TIME_LOW32:
+			{
+				UIntMatrix& values(section.sectionType == TIME_HIGH32 ? high32[section.row] : low32[section.row]);
+				values.resize(section.dim, count);
+				readVtkData(section.type, isBinary, values.transpose(), is);
+				break;
+			}
+		}
+		if (!is)
+			throw runtime_error("VTK parse error: unexpected end of file");
+		section.position = is.tellg();
+	}
+	nextPoint += count;
+
+	Labels featureLabels;
+	featureLabels.push_back(Label("x", 1));
+	featureLabels.push_back(Label("y", 1));
+	featureLabels.push_back(Label("z", 1));
+	featureLabels.push_back(Label("pad", 1));
+	chunk = DataPoints(features, featureLabels);
+	if (descriptors.rows() > 0)
+	{
+		chunk.descriptors.swap(descriptors);
+		chunk.descriptorLabels = descriptorLabels;
+	}
+	if (!timeLabels.empty())
+	{
+		chunk.times.resize(timeLabels.size(), count);
+		for (size_t t = 0; t < timeLabels.size(); ++t)
+			for (size_t i = 0; i < count; ++i)
+				chunk.times(t, i) = (((std::int64_t) high32[t](0, i)) << 32) | ((std::int64_t) low32[t](0, i));
+		chunk.timeLabels = timeLabels;
+	}
+	return true;
+}
+
+template class PointMatcherIO<float>::VTKChunkReader;
+template class PointMatcherIO<double>::VTKChunkReader;
+
+//! Open fileName for reading by chunks, determining its format from its extension, which must be ".csv" or ".vtk"
+template<typename T>
+std::shared_ptr<typename PointMatcherIO<T>::ChunkReader> PointMatcherIO<T>::openChunkReader(const std::string& fileName, const size_t chunkSize)
+{
+	const boost::filesystem::path path(fileName);
+	const string& ext(boost::filesystem::extension(path));
+	if (boost::iequals(ext, ".csv"))
+		return std::make_shared<CSVChunkReader>(fileName, chunkSize);
+	else if (boost::iequals(ext, ".vtk"))
+		return std::make_shared<VTKChunkReader>(fileName, chunkSize);
+	else
+		throw runtime_error("openChunkReader(): Unknown extension \"" + ext + "\" for file \"" + fileName + "\", extension must be either \".vtk\" or \".csv\"");
+}
+
+template
+std::shared_ptr<PointMatcherIO<float>::ChunkReader> PointMatcherIO<float>::openChunkReader(const std::string& fileName, const size_t chunkSize);
+template
+std::shared_ptr<PointMatcherIO<double>::ChunkReader> PointMatcherIO<double>::openChunkReader(const std::string& fileName, const size_t chunkSize);
 
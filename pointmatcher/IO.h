@@ -38,6 +38,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "PointMatcher.h"
 
+#include <fstream>
+
 //! IO Functions and classes that are dependant on scalar type are defined in this templatized class
 template<typename T>
 struct PointMatcherIO
@@ -180,12 +182,17 @@ struct PointMatcherIO
 	//static PMPropTypes getPMType(const std::string& externalName); //! Return the type of information specific to a DataPoints based on a sulabel name
 
 	// CSV
-	static DataPoints loadCSV(const std::string& fileName);
-	static DataPoints loadCSV(std::istream& is);
+	static DataPoints loadCSV(const std::string& fileName, const unsigned nbThreads = 1);
+	static DataPoints loadCSV(std::istream& is, const unsigned nbThreads = 1);
 
 	static void saveCSV(const DataPoints& data, const std::string& fileName);
 	static void saveCSV(const DataPoints& data, std::ostream& os);
 
+	//! Parse the first line of a CSV file into csvHeader and the labels of the columns, return whether it is a text header
+	static bool parseCSVHeader(const std::string& line, std::vector<GenericInputHeader>& csvHeader, LabelGenerator& featLabelGen, LabelGenerator& descLabelGen, LabelGenerator& timeLabelGen);
+	//! Parse a line of CSV data, in [lineBegin, lineEnd), into column matrixCol of the matrices
+	static void parseCSVLine(const char* lineBegin, const char* lineEnd, const std::vector<GenericInputHeader>& csvHeader, const unsigned int csvRow, const int matrixCol, Matrix& features, Matrix& descriptors, Int64Matrix& times);
+
 	// VTK
 	//! Enumeration of legacy VTK data types that can be parsed
 	enum SupportedVTKDataTypes
@@ -218,13 +225,105 @@ struct PointMatcherIO
 	static DataPoints loadPLY(const std::string& fileName);
 	static DataPoints loadPLY(std::istream& is);
 
-	static void savePLY(const DataPoints& data, const std::string& fileName); //!< save datapoints to PLY point cloud format
+	static void savePLY(const DataPoints& data, const std::string& fileName, bool binary = false); //!< save datapoints to PLY point cloud format, ASCII or binary
 
 	// PCD
 	static DataPoints loadPCD(const std::string& fileName);
 	static DataPoints loadPCD(std::istream& is);
 
-	static void savePCD(const DataPoints& data, const std::string& fileName); //!< save datapoints to PCD point cloud format
+	static void savePCD(const DataPoints& data, const std::string& fileName, bool binary = false); //!< save datapoints to PCD point cloud format, ASCII or binary
+
+	// PMB, native binary format
+	static DataPoints loadPMB(const std::string& fileName);
+	static DataPoints loadPMB(const std::string& fileName, const std::vector<std::string>& channels); //!< load features and only the named descriptor and time channels
+	static DataPoints loadPMB(std::istream& is);
+	static DataPoints loadPMB(std::istream& is, const std::vector<std::string>& channels);
+
+	static void savePMB(const DataPoints& data, const std::string& fileName, bool compress = false); //!< save datapoints losslessly to the native binary format, optionally compressing each channel
+	static void savePMB(const DataPoints& data, std::ostream& os, bool compress = false);
+
+	// Chunked reading
+	//! Read a point cloud by chunks of at most a given number of points, all chunks having the same labels, so that clouds larger than memory can be processed
+	class ChunkReader
+	{
+	public:
+		virtual ~ChunkReader() {}
+		//! Replace chunk with the next points of the cloud, return false if there were none left
+		virtual bool read(DataPoints& chunk) = 0;
+	};
+
+	//! Read a CSV file by chunks, detecting its header as loadCSV() does
+	class CSVChunkReader: public ChunkReader
+	{
+	public:
+		CSVChunkReader(const std::string& fileName, const size_t chunkSize);
+		CSVChunkReader(std::istream& is, const size_t chunkSize);
+		virtual bool read(DataPoints& chunk);
+
+	private:
+		void readHeader();
+
+		std::ifstream file; //!< opened file, if constructed from a file name
+		std::istream& is; //!< stream the points are read from
+		const size_t chunkSize; //!< maximum number of points in a chunk
+		std::vector<GenericInputHeader> csvHeader; //!< description of the columns
+		Labels featureLabels; //!< labels of the features of every chunk
+		Labels descriptorLabels; //!< labels of the descriptors of every chunk
+		Labels timeLabels; //!< labels of the times of every chunk
+		bool addedPad; //!< whether the file has no pad column, one being added
+		std::string pendingLine; //!< first line of data, if the file has no header
+		unsigned int csvRow; //!< number of lines of data read so far
+		bool ended; //!< whether the end of the data was reached
+	};
+
+	//! Read a VTK file by chunks, loading the same information as loadVTK().
+	//! As VTK stores every attribute of all points one after the other, the reader first goes
+	//! through the file to locate the attributes, then reads the next points of each of them at every chunk.
+	//! The stream must therefore support seeking.
+	class VTKChunkReader: public ChunkReader
+	{
+	public:
+		VTKChunkReader(const std::string& fileName, const size_t chunkSize);
+		VTKChunkReader(std::istream& is, const size_t chunkSize);
+		virtual bool read(DataPoints& chunk);
+
+	private:
+		//! What an attribute of the file holds
+		enum SectionType
+		{
+			POINTS, //!< coordinates of the points
+			DESCRIPTOR_DATA, //!< a descriptor
+			COLOR_DATA, //!< a binary COLOR_SCALARS descriptor, stored as bytes
+			TIME_HIGH32, //!< higher 32 bits of a time
+			TIME_LOW32 //!< lower 32 bits of a time
+		};
+
+		//! Location of an attribute in the file
+		struct Section
+		{
+			SectionType sectionType; //!< what the attribute holds
+			std::string type; //!< VTK type of the values
+			int dim; //!< number of values per point
+			int row; //!< first row of the attribute in the descriptors or times of a chunk
+			std::streampos position; //!< where the values of the next point are
+		};
+
+		void scan();
+		void skipValues(const size_t count, const size_t binarySize);
+
+		std::ifstream file; //!< opened file, if constructed from a file name
+		std::istream& is; //!< stream the points are read from
+		const size_t chunkSize; //!< maximum number of points in a chunk
+		bool isBinary; //!< whether the file is binary
+		size_t pointCount; //!< number of points in the file
+		size_t nextPoint; //!< index of the first point of the next chunk
+		std::vector<Section> sections; //!< all attributes of the file, in the order in which they are stored
+		Labels descriptorLabels; //!< labels of the descriptors of every chunk
+		Labels timeLabels; //!< labels of the times of every chunk
+	};
+
+	//! Open a point cloud file for reading by chunks of chunkSize points, determining its format from its extension
+	static std::shared_ptr<ChunkReader> openChunkReader(const std::string& fileName, const size_t chunkSize);
 
 	//! Information to exploit a reading from a file using this library. Fields might be left blank if unused.
 	struct FileInfo
@@ -393,7 +492,7 @@ struct PointMatcherIO
 		unsigned int height; //!< height of sensor matrix
 		Eigen::Matrix<T, 7, 1> viewPoint;  //!< not used
 		unsigned int nbPoints; //!< number of points, same as width*height
-		std::string dataType; //!< ascii or binary
+		std::string dataType; //!< ascii, binary or binary_compressed
 
 		PCDheader()
 		{
@@ -53,7 +53,8 @@ InspectorsImpl<T>::PerformanceInspector::PerformanceInspector(const std::string&
 	Inspector(className,paramsDoc,params),
 	baseFileName(Parametrizable::get<string>("baseFileName")),
 	bDumpPerfOnExit(Parametrizable::get<bool>("dumpPerfOnExit")),
-	bDumpStats(Parametrizable::get<bool>("dumpStats"))
+	bDumpStats(Parametrizable::get<bool>("dumpStats")),
+	bStreamingStats(Parametrizable::get<bool>("streamingStats"))
 
 {//FIXME: do we need that constructor?
 }
@@ -63,7 +64,8 @@ InspectorsImpl<T>::PerformanceInspector::PerformanceInspector(const Parameters&
 	Inspector("PerformanceInspector", PerformanceInspector::availableParameters(), params),
 	baseFileName(Parametrizable::get<string>("baseFileName")),
 	bDumpPerfOnExit(Parametrizable::get<bool>("dumpPerfOnExit")),
-	bDumpStats(Parametrizable::get<bool>("dumpStats"))
+	bDumpStats(Parametrizable::get<bool>("dumpStats")),
+	bStreamingStats(Parametrizable::get<bool>("streamingStats"))
 {}
 
 template<typename T>
@@ -74,9 +76,9 @@ void InspectorsImpl<T>::PerformanceInspector::addStat(const std::string& name, d
 	HistogramMap::iterator it(stats.find(name));
 	if (it == stats.end()) {
 		LOG_INFO_STREAM("Adding new stat: " << name);
-		it = stats.insert(HistogramMap::value_type(name, Histogram(16, name, baseFileName, bDumpPerfOnExit))).first;
+		it = stats.insert(HistogramMap::value_type(name, Histogram(16, name, baseFileName, bDumpPerfOnExit, bStreamingStats))).first;
 	}
-	it->second.push_back(data);
+	it->second.addSample(data);
 }
 
 template<typename T>
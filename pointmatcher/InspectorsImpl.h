@@ -80,7 +80,8 @@ struct InspectorsImpl
 			return {
 				{"baseFileName", "base file name for the statistics files (if empty, disabled)", ""},
 				{"dumpPerfOnExit", "dump performance statistics to stderr on exit", "0"},
-				{"dumpStats", "dump the statistics on first and last step", "0"}
+				{"dumpStats", "dump the statistics on first and last step", "0"},
+				{"streamingStats", "keep statistics in constant memory instead of storing every value; median, quartiles and bins are then approximated within 1% and values are not written to files", "0"}
 			};
 		}
 
@@ -89,6 +90,7 @@ struct InspectorsImpl
 		// with similarly named functions.
 		const bool bDumpPerfOnExit;
 		const bool bDumpStats;
+		const bool bStreamingStats;
 		
 	protected:
 		typedef PointMatcherSupport::Histogram<double> Histogram;
@@ -167,6 +169,7 @@ struct InspectorsImpl
 				{"baseFileName", "base file name for the VTK files ", "point-matcher-output"},
 				{"dumpPerfOnExit", "dump performance statistics to stderr on exit", "0"},
 				{"dumpStats", "dump the statistics on first and last step", "0"},
+				{"streamingStats", "keep statistics in constant memory instead of storing every value; median, quartiles and bins are then approximated within 1% and values are not written to files", "0"},
 				{"dumpIterationInfo", "dump iteration info", "0"},
 				{"dumpDataLinks", "dump data links at each iteration", "0" },
 				{"dumpReading", "dump the reading cloud at each iteration", "0"},
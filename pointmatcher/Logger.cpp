@@ -94,10 +94,27 @@ namespace PointMatcherSupport
 	void Logger::finishWarningEntry(const char *file, unsigned line, const char *func)
 	{}
 	
+	//! Return whether complete entries can be written from several threads at once through writeInfoEntry() and writeWarningEntry(), without holding loggerMutex
+	bool Logger::hasConcurrentEntries() const
+	{
+		return false;
+	}
+	
+	//! Write a complete entry into the info channel, only called if hasConcurrentEntries() returns true
+	void Logger::writeInfoEntry(const char *file, unsigned line, const char *func, const std::string& message)
+	{}
+	
+	//! Write a complete entry into the warning channel, only called if hasConcurrentEntries() returns true
+	void Logger::writeWarningEntry(const char *file, unsigned line, const char *func, const std::string& message)
+	{}
+	
 	//! Set a new logger, protected by a mutex
+	/**
+		The pointer is swapped atomically, so that loggers with concurrent entries are reached without loggerMutex.
+	*/
 	void setLogger(std::shared_ptr<Logger> newLogger)
 	{
 		boost::mutex::scoped_lock lock(loggerMutex);
-		logger = newLogger;
+		std::atomic_store(&logger, newLogger);
 	}
 }
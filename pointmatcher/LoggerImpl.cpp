@@ -35,6 +35,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "LoggerImpl.h"
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <fstream>
 
@@ -122,4 +124,238 @@ namespace PointMatcherSupport
 		else
 			_warningStream << endl;
 	}
+	
+	AsyncFileLogger::RingBuffer::RingBuffer(const unsigned loggerId, const size_t size):
+		loggerId(loggerId),
+		entries(size),
+		head(0),
+		tail(0),
+		abandoned(false),
+		closed(false)
+	{
+	}
+	
+	AsyncFileLogger::ThreadBuffers::~ThreadBuffers()
+	{
+		for (size_t i = 0; i < buffers.size(); ++i)
+			buffers[i]->abandoned.store(true, std::memory_order_release);
+	}
+	
+	AsyncFileLogger::AsyncFileLogger(const Parameters& params):
+		Logger("AsyncFileLogger", AsyncFileLogger::availableParameters(), params),
+		infoFileName(Parametrizable::get<std::string>("infoFileName")),
+		warningFileName(Parametrizable::get<std::string>("warningFileName")),
+		displayLocation(Parametrizable::get<bool>("displayLocation")),
+		bufferSize(Parametrizable::get<unsigned>("bufferSize")),
+		id([]() { static std::atomic<unsigned> nextId(1); return nextId++; }()),
+		_infoFileStream(infoFileName.c_str()),
+		_warningFileStream(warningFileName.c_str()),
+		_infoStream(nullptr),
+		_warningStream(nullptr),
+		stopping(false),
+		writerWaiting(false)
+	{
+		if (infoFileName.empty())
+		{
+			_infoStream.rdbuf(std::cout.rdbuf());
+		}
+		else
+		{
+			if (!_infoFileStream.good())
+			{
+				throw runtime_error(string("AsyncFileLogger::Cannot open info stream to file ") + infoFileName);
+			}
+			_infoStream.rdbuf(_infoFileStream.rdbuf());
+		}
+
+		if (warningFileName.empty())
+		{
+			_warningStream.rdbuf(std::cerr.rdbuf());
+		}
+		else
+		{
+			if (!_warningFileStream.good())
+			{
+				throw runtime_error(string("AsyncFileLogger::Cannot open warning stream to file ") + warningFileName);
+			}
+			_warningStream.rdbuf(_warningFileStream.rdbuf());
+		}
+
+		writer = std::thread(&AsyncFileLogger::writeInBackground, this);
+	}
+	
+	//! Write every queued entry before returning
+	AsyncFileLogger::~AsyncFileLogger()
+	{
+		stopping.store(true, std::memory_order_release);
+		writerCondition.notify_one();
+		writer.join();
+
+		std::lock_guard<std::mutex> lock(buffersMutex);
+		for (size_t i = 0; i < buffers.size(); ++i)
+			buffers[i]->closed.store(true, std::memory_order_release);
+	}
+	
+	bool AsyncFileLogger::hasInfoChannel() const
+	{
+		return true;
+	}
+	
+	void AsyncFileLogger::beginInfoEntry(const char *file, unsigned line, const char *func)
+	{
+	}
+	
+	std::ostream* AsyncFileLogger::infoStream()
+	{
+		return &_infoEntry;
+	}
+	
+	void AsyncFileLogger::finishInfoEntry(const char *file, unsigned line, const char *func)
+	{
+		push(false, formatEntry(file, line, func, _infoEntry.str()));
+		_infoEntry.str("");
+	}
+	
+	bool AsyncFileLogger::hasWarningChannel() const
+	{
+		return true;
+	}
+	
+	void AsyncFileLogger::beginWarningEntry(const char *file, unsigned line, const char *func)
+	{
+	}
+	
+	std::ostream* AsyncFileLogger::warningStream()
+	{
+		return &_warningEntry;
+	}
+	
+	void AsyncFileLogger::finishWarningEntry(const char *file, unsigned line, const char *func)
+	{
+		push(true, formatEntry(file, line, func, _warningEntry.str()));
+		_warningEntry.str("");
+	}
+	
+	bool AsyncFileLogger::hasConcurrentEntries() const
+	{
+		return true;
+	}
+	
+	void AsyncFileLogger::writeInfoEntry(const char *file, unsigned line, const char *func, const std::string& message)
+	{
+		push(false, formatEntry(file, line, func, message));
+	}
+	
+	void AsyncFileLogger::writeWarningEntry(const char *file, unsigned line, const char *func, const std::string& message)
+	{
+		push(true, formatEntry(file, line, func, message));
+	}
+	
+	//! Return the buffer of the current thread for this logger, creating it on the first entry
+	AsyncFileLogger::RingBuffer& AsyncFileLogger::getThreadBuffer()
+	{
+		static thread_local ThreadBuffers threadBuffers;
+		for (size_t i = 0; i < threadBuffers.buffers.size(); ++i)
+		{
+			if (threadBuffers.buffers[i]->loggerId == id)
+				return *threadBuffers.buffers[i];
+		}
+
+		// forget the buffers of destroyed loggers
+		threadBuffers.buffers.erase(
+			std::remove_if(threadBuffers.buffers.begin(), threadBuffers.buffers.end(),
+				[](const std::shared_ptr<RingBuffer>& buffer) { return buffer->closed.load(std::memory_order_acquire); }),
+			threadBuffers.buffers.end());
+
+		const std::shared_ptr<RingBuffer> buffer(std::make_shared<RingBuffer>(id, bufferSize));
+		{
+			std::lock_guard<std::mutex> lock(buffersMutex);
+			buffers.push_back(buffer);
+		}
+		threadBuffers.buffers.push_back(buffer);
+		return *buffer;
+	}
+	
+	std::string AsyncFileLogger::formatEntry(const char *file, unsigned line, const char *func, const std::string& message) const
+	{
+		if (!displayLocation)
+			return message + '\n';
+		std::ostringstream entry;
+		entry << message << " (at " << file << ":" << line << " in " << func << " )\n";
+		return entry.str();
+	}
+	
+	//! Queue an entry in the buffer of the current thread, waiting only if this buffer is full
+	void AsyncFileLogger::push(const bool isWarning, std::string text)
+	{
+		RingBuffer& buffer(getThreadBuffer());
+		const size_t tail(buffer.tail.load(std::memory_order_relaxed));
+		while (tail - buffer.head.load(std::memory_order_acquire) >= buffer.entries.size())
+		{
+			writerCondition.notify_one();
+			std::this_thread::yield();
+		}
+
+		Entry& entry(buffer.entries[tail % buffer.entries.size()]);
+		entry.isWarning = isWarning;
+		entry.text.swap(text);
+		buffer.tail.store(tail + 1, std::memory_order_release);
+
+		if (writerWaiting.load(std::memory_order_relaxed))
+			writerCondition.notify_one();
+	}
+	
+	//! Write the entries queued in every buffer, return whether there was any
+	bool AsyncFileLogger::writeQueuedEntries()
+	{
+		bool wrote(false);
+		std::lock_guard<std::mutex> lock(buffersMutex);
+		for (auto it = buffers.begin(); it != buffers.end();)
+		{
+			RingBuffer& buffer(**it);
+			// read first, an abandoned buffer being complete
+			const bool abandoned(buffer.abandoned.load(std::memory_order_acquire));
+			size_t head(buffer.head.load(std::memory_order_relaxed));
+			const size_t tail(buffer.tail.load(std::memory_order_acquire));
+			for (; head != tail; ++head)
+			{
+				Entry& entry(buffer.entries[head % buffer.entries.size()]);
+				(entry.isWarning ? _warningStream : _infoStream) << entry.text;
+				std::string().swap(entry.text);
+				wrote = true;
+			}
+			buffer.head.store(head, std::memory_order_release);
+
+			if (abandoned)
+				it = buffers.erase(it);
+			else
+				++it;
+		}
+
+		if (wrote)
+		{
+			_infoStream.flush();
+			_warningStream.flush();
+		}
+		return wrote;
+	}
+	
+	//! Loop of the background writer, waking up when entries are queued or at least every 10 ms
+	void AsyncFileLogger::writeInBackground()
+	{
+		while (true)
+		{
+			// read before writing, so that every entry queued before destruction is written
+			const bool stop(stopping.load(std::memory_order_acquire));
+			if (writeQueuedEntries())
+				continue;
+			if (stop)
+				break;
+
+			std::unique_lock<std::mutex> lock(writerMutex);
+			writerWaiting.store(true, std::memory_order_relaxed);
+			writerCondition.wait_for(lock, std::chrono::milliseconds(10));
+			writerWaiting.store(false, std::memory_order_relaxed);
+		}
+	}
 } //PointMatcherSupport
@@ -37,7 +37,13 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define __POINTMATCHER_LOGGER_H
 
 #include "PointMatcher.h"
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 namespace PointMatcherSupport
 {
@@ -88,6 +94,93 @@ namespace PointMatcherSupport
 		std::ostream _infoStream;
 		std::ostream _warningStream;
 	};
+
+	struct AsyncFileLogger: public Logger
+	{
+		inline static const std::string description()
+		{
+			return "Log using std::stream from a background thread. Each logging thread formats its entries and queues them in its own lock-free ring buffer, so that logging neither takes the global logger lock nor waits for the output, unless this buffer is full. Entries of a thread keep their order, but entries of different threads may be interleaved differently than they were logged.";
+		}
+		inline static const ParametersDoc availableParameters()
+		{
+			return {
+				{"infoFileName", "name of the file to output infos to, or an empty string to output infos to the standard output stream", ""},
+				{"warningFileName", "name of the file to output warnings to, or an empty string to output warnings to the standard error stream", ""},
+				{"displayLocation", "display the location of message in source code", "0"},
+				{"bufferSize", "number of entries each logging thread can queue before waiting for the background writer", "1024", "1", "1048576", &Comp<unsigned>}
+			};
+		};
+		
+		const std::string infoFileName;
+		const std::string warningFileName;
+		const bool displayLocation;
+		const unsigned bufferSize;
+		
+		AsyncFileLogger(const Parameters& params = Parameters());
+		virtual ~AsyncFileLogger();
+		
+		virtual bool hasInfoChannel() const;
+		virtual void beginInfoEntry(const char *file, unsigned line, const char *func);
+		virtual std::ostream* infoStream();
+		virtual void finishInfoEntry(const char *file, unsigned line, const char *func);
+		virtual bool hasWarningChannel() const;
+		virtual void beginWarningEntry(const char *file, unsigned line, const char *func);
+		virtual std::ostream* warningStream();
+		virtual void finishWarningEntry(const char *file, unsigned line, const char *func);
+		virtual bool hasConcurrentEntries() const;
+		virtual void writeInfoEntry(const char *file, unsigned line, const char *func, const std::string& message);
+		virtual void writeWarningEntry(const char *file, unsigned line, const char *func, const std::string& message);
+		
+	protected:
+		//! A formatted entry waiting to be written
+		struct Entry
+		{
+			bool isWarning;
+			std::string text;
+		};
+		
+		//! Entries of one logging thread, with a single producer and a single consumer
+		struct RingBuffer
+		{
+			RingBuffer(const unsigned loggerId, const size_t size);
+			
+			const unsigned loggerId; //!< id of the logger owning this buffer
+			std::vector<Entry> entries; //!< circular storage
+			std::atomic<size_t> head; //!< count of entries written, only increased by the background writer
+			std::atomic<size_t> tail; //!< count of entries queued, only increased by the logging thread
+			std::atomic<bool> abandoned; //!< set when the logging thread exits
+			std::atomic<bool> closed; //!< set when the logger is destroyed
+		};
+		
+		//! Buffers of the current thread, one per logger it has used
+		struct ThreadBuffers
+		{
+			~ThreadBuffers();
+			std::vector<std::shared_ptr<RingBuffer>> buffers;
+		};
+		
+		RingBuffer& getThreadBuffer();
+		std::string formatEntry(const char *file, unsigned line, const char *func, const std::string& message) const;
+		void push(const bool isWarning, std::string text);
+		bool writeQueuedEntries();
+		void writeInBackground();
+		
+		const unsigned id; //!< unique id, never reused by another logger
+		std::ofstream _infoFileStream;
+		std::ofstream _warningFileStream;
+		std::ostream _infoStream;
+		std::ostream _warningStream;
+		std::ostringstream _infoEntry; //!< entry built through infoStream()
+		std::ostringstream _warningEntry; //!< entry built through warningStream()
+		
+		std::mutex buffersMutex; //!< protects buffers, taken once per new logging thread and by the background writer
+		std::vector<std::shared_ptr<RingBuffer>> buffers;
+		std::atomic<bool> stopping;
+		std::atomic<bool> writerWaiting;
+		std::mutex writerMutex;
+		std::condition_variable writerCondition;
+		std::thread writer;
+	};
 } //PointMatcherSupport
 
 #endif // __POINTMATCHER_LOGGER_H
@@ -72,5 +72,19 @@ unsigned long PointMatcher<T>::Matcher::getVisitCount() const
 	return visitCounter;
 }
 
+//! If not redefined by child class, init again with the whole reference
+template<typename T>
+void PointMatcher<T>::Matcher::appendToReference(const DataPoints& filteredReference, const int firstNewPoint)
+{
+	init(filteredReference);
+}
+
+//! If not redefined by child class, init again with the whole reference
+template<typename T>
+void PointMatcher<T>::Matcher::removeFromReference(const DataPoints& filteredReference, const std::vector<bool>& keptPoints)
+{
+	init(filteredReference);
+}
+
 template struct PointMatcher<float>::Matcher;
 template struct PointMatcher<double>::Matcher;
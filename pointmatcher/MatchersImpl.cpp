@@ -35,6 +35,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "MatchersImpl.h"
 #include "PointMatcherPrivate.h"
+#include "Parallel.h"
+
+#include <algorithm>
 
 // NullMatcher
 template<typename T>
@@ -63,9 +66,10 @@ MatchersImpl<T>::KDTreeMatcher::KDTreeMatcher(const Parameters& params):
 	knn(Parametrizable::get<int>("knn")),
 	epsilon(Parametrizable::get<T>("epsilon")),
 	searchType(NNSearchType(Parametrizable::get<int>("searchType"))),
-	maxDist(Parametrizable::get<T>("maxDist"))
+	maxDist(Parametrizable::get<T>("maxDist")),
+	nbThreads(Parametrizable::get<unsigned>("nbThreads"))
 {
-	LOG_INFO_STREAM("* KDTreeMatcher: initialized with knn=" << knn << ", epsilon=" << epsilon << ", searchType=" << searchType << " and maxDist=" << maxDist);
+	LOG_INFO_STREAM("* KDTreeMatcher: initialized with knn=" << knn << ", epsilon=" << epsilon << ", searchType=" << searchType << ", maxDist=" << maxDist << " and nbThreads=" << nbThreads);
 }
 
 template<typename T>
@@ -79,7 +83,156 @@ void MatchersImpl<T>::KDTreeMatcher::init(
 	const DataPoints& filteredReference)
 {
 	// build and populate NNS
-	featureNNS.reset( NNS::create(filteredReference.features, filteredReference.features.rows() - 1, searchType, NNS::TOUCH_STATISTICS));
+	featureForest.assign(1, SubTree());
+	featureForest[0].offset = 0;
+	featureForest[0].size = filteredReference.features.cols();
+	featureForest[0].nns.reset( NNS::create(filteredReference.features, filteredReference.features.rows() - 1, searchType, NNS::TOUCH_STATISTICS));
+}
+
+//! Index the appended points in a new tree, then merge the last trees as long as they have similar sizes
+/**
+	This is the logarithmic method: every point takes part in O(log n) rebuilds and queries visit O(log n) trees.
+	As the reference passed to init() might have been reallocated, the tree indexing it is first rebuilt on a copy of its features.
+*/
+template<typename T>
+void MatchersImpl<T>::KDTreeMatcher::appendToReference(
+	const DataPoints& filteredReference,
+	const int firstNewPoint)
+{
+	const Matrix& features(filteredReference.features);
+	if (featureForest.empty() || firstNewPoint == 0)
+	{
+		init(filteredReference);
+		return;
+	}
+	
+	for (size_t i = 0; i < featureForest.size(); ++i)
+	{
+		if (!featureForest[i].features)
+			buildSubTree(featureForest[i], features, featureForest[i].offset, featureForest[i].size);
+	}
+	
+	const int newPointCount(features.cols() - firstNewPoint);
+	if (newPointCount <= 0)
+		return;
+	
+	featureForest.push_back(SubTree());
+	buildSubTree(featureForest.back(), features, firstNewPoint, newPointCount);
+	mergeSubTrees(features);
+}
+
+//! Rebuild the trees which lost points, and only shift the others
+template<typename T>
+void MatchersImpl<T>::KDTreeMatcher::removeFromReference(
+	const DataPoints& filteredReference,
+	const std::vector<bool>& keptPoints)
+{
+	const Matrix& features(filteredReference.features);
+	if (featureForest.empty() || features.cols() == 0)
+	{
+		init(filteredReference);
+		return;
+	}
+	
+	std::vector<SubTree> forest;
+	int removedCount(0);
+	for (size_t i = 0; i < featureForest.size(); ++i)
+	{
+		const SubTree& tree(featureForest[i]);
+		const int keptCount(std::count(keptPoints.begin() + tree.offset, keptPoints.begin() + tree.offset + tree.size, true));
+		const int offset(tree.offset - removedCount);
+		removedCount += tree.size - keptCount;
+		
+		if (keptCount == 0)
+			continue;
+		
+		forest.push_back(tree);
+		if (keptCount == tree.size && tree.features)
+			forest.back().offset = offset;
+		else
+			buildSubTree(forest.back(), features, offset, keptCount);
+	}
+	featureForest.swap(forest);
+	mergeSubTrees(features);
+}
+
+//! Build tree on a copy of the size columns of features starting at offset
+template<typename T>
+void MatchersImpl<T>::KDTreeMatcher::buildSubTree(
+	SubTree& tree,
+	const Matrix& features,
+	const int offset,
+	const int size) const
+{
+	// the tree keeps a reference to its features, which must be released after it
+	std::shared_ptr<Matrix> treeFeatures(new Matrix(features.middleCols(offset, size)));
+	std::shared_ptr<NNS> nns(NNS::create(*treeFeatures, treeFeatures->rows() - 1, searchType, NNS::TOUCH_STATISTICS));
+	tree.offset = offset;
+	tree.size = size;
+	tree.nns = nns;
+	tree.features = treeFeatures;
+}
+
+//! Merge the last two trees while the previous one is at most twice as large as the last one
+template<typename T>
+void MatchersImpl<T>::KDTreeMatcher::mergeSubTrees(
+	const Matrix& features)
+{
+	while (featureForest.size() >= 2)
+	{
+		const SubTree& last(featureForest.back());
+		SubTree& previous(featureForest[featureForest.size() - 2]);
+		if (previous.size > 2 * last.size)
+			break;
+		
+		buildSubTree(previous, features, previous.offset, previous.size + last.size);
+		featureForest.pop_back();
+	}
+}
+
+//! Search the neighbors of query in all trees, keeping the closest ones sorted by distance when there are several trees
+template<typename T>
+unsigned long MatchersImpl<T>::KDTreeMatcher::searchForest(
+	const Matrix& query,
+	typename Matches::Ids& ids,
+	typename Matches::Dists& dists) const
+{
+	// trees cover the reference from its first point on
+	if (featureForest.size() == 1)
+		return featureForest[0].nns->knn(query, ids, dists, knn, epsilon, NNS::ALLOW_SELF_MATCH, maxDist);
+	
+	ids.setConstant(Matches::InvalidId);
+	dists.setConstant(Matches::InvalidDist);
+	
+	unsigned long visitCount(0);
+	typename Matches::Ids treeIds(ids.rows(), ids.cols());
+	typename Matches::Dists treeDists(dists.rows(), dists.cols());
+	for (size_t i = 0; i < featureForest.size(); ++i)
+	{
+		const SubTree& tree(featureForest[i]);
+		visitCount += tree.nns->knn(query, treeIds, treeDists, knn, epsilon, NNS::ALLOW_SELF_MATCH, maxDist);
+		
+		for (int col = 0; col < query.cols(); ++col)
+		{
+			for (int k = 0; k < knn; ++k)
+			{
+				const T dist(treeDists(k, col));
+				if (treeIds(k, col) == Matches::InvalidId || !(dist < dists(knn - 1, col)))
+					continue;
+				
+				// insertion in the sorted column
+				int j(knn - 1);
+				for (; j > 0 && dists(j - 1, col) > dist; --j)
+				{
+					dists(j, col) = dists(j - 1, col);
+					ids(j, col) = ids(j - 1, col);
+				}
+				dists(j, col) = dist;
+				ids(j, col) = treeIds(k, col) + tree.offset;
+			}
+		}
+	}
+	return visitCount;
 }
 
 template<typename T>
@@ -95,7 +248,33 @@ typename PointMatcher<T>::Matches MatchersImpl<T>::KDTreeMatcher::findClosests(
 	
 	static_assert(NNS::InvalidIndex == Matches::InvalidId, "");
 	static_assert(NNS::InvalidValue == Matches::InvalidDist, "");
-	this->visitCounter += featureNNS->knn(filteredReading.features, matches.ids, matches.dists, knn, epsilon, NNS::ALLOW_SELF_MATCH, maxDist);
+
+	// below this number of points per thread, the threading overhead dominates
+	const size_t minChunkSize(1024);
+	const unsigned chunkCount(PointMatcherSupport::getChunkCount(pointsCount, nbThreads, minChunkSize));
+	if (chunkCount <= 1)
+	{
+		this->visitCounter += searchForest(filteredReading.features, matches.ids, matches.dists);
+		return matches;
+	}
+
+	// every chunk of reading points is searched by its own thread, which writes its own columns of matches
+	std::vector<unsigned long> visitCounts(chunkCount, 0);
+	PointMatcherSupport::parallelForChunks(pointsCount, chunkCount,
+		[&](const unsigned chunk, const size_t begin, const size_t end)
+		{
+			const int chunkSize(end - begin);
+			const Matrix query(filteredReading.features.middleCols(begin, chunkSize));
+			typename Matches::Dists dists(knn, chunkSize);
+			typename Matches::Ids ids(knn, chunkSize);
+			visitCounts[chunk] = searchForest(query, ids, dists);
+			matches.dists.middleCols(begin, chunkSize) = dists;
+			matches.ids.middleCols(begin, chunkSize) = ids;
+		}
+	);
+
+	for (unsigned chunk = 0; chunk < chunkCount; ++chunk)
+		this->visitCounter += visitCounts[chunk];
 
 	return matches;
 }
@@ -55,6 +55,7 @@ struct MatchersImpl
 	typedef typename Nabo::NearestNeighbourSearch<T> NNS;
 	typedef typename NNS::SearchType NNSearchType;
 	
+	typedef typename PointMatcher<T>::Matrix Matrix;
 	typedef typename PointMatcher<T>::DataPoints DataPoints;
 	typedef typename PointMatcher<T>::Matcher Matcher;
 	typedef typename PointMatcher<T>::Matches Matches;
@@ -83,7 +84,8 @@ struct MatchersImpl
 				{"knn", "number of nearest neighbors to consider it the reference", "1", "1", "2147483647", &P::Comp<unsigned>},
 				{"epsilon", "approximation to use for the nearest-neighbor search", "0", "0", "inf", &P::Comp<T>},
 				{"searchType", "Nabo search type. 0: brute force, check distance to every point in the data (very slow), 1: kd-tree with linear heap, good for small knn (~up to 30) and 2: kd-tree with tree heap, good for large knn (~from 30)", "1", "0", "2", &P::Comp<unsigned>},
-				{"maxDist", "maximum distance to consider for neighbors", "inf", "0", "inf", &P::Comp<T>}
+				{"maxDist", "maximum distance to consider for neighbors", "inf", "0", "inf", &P::Comp<T>},
+				{"nbThreads", "number of threads used to search the neighbors of the reading points, which are split in contiguous chunks. 0: one thread per hardware thread", "1", "0", "2147483647", &P::Comp<unsigned>}
 			};
 		}
 		
@@ -91,14 +93,31 @@ struct MatchersImpl
 		const T epsilon;
 		const NNSearchType searchType;
 		const T maxDist;
+		const unsigned nbThreads;
 
 	protected:
-		std::shared_ptr<NNS> featureNNS;
+		//! A kd-tree indexing a contiguous range of points of the reference
+		struct SubTree
+		{
+			int offset; //!< index in the reference of the first point of the range
+			int size; //!< number of points in the range
+			std::shared_ptr<Matrix> features; //!< copy of the features of the range, null if the tree indexes the reference passed to init() directly
+			std::shared_ptr<NNS> nns; //!< the tree
+		};
+		
+		//! Trees covering the reference in the order of its points, with decreasing sizes so that appending points only rebuilds the small ones
+		std::vector<SubTree> featureForest;
+
+		void buildSubTree(SubTree& tree, const Matrix& features, const int offset, const int size) const;
+		void mergeSubTrees(const Matrix& features);
+		unsigned long searchForest(const Matrix& query, typename Matches::Ids& ids, typename Matches::Dists& dists) const;
 
 	public:
 		KDTreeMatcher(const Parameters& params = Parameters());
 		virtual ~KDTreeMatcher();
 		virtual void init(const DataPoints& filteredReference);
+		virtual void appendToReference(const DataPoints& filteredReference, const int firstNewPoint);
+		virtual void removeFromReference(const DataPoints& filteredReference, const std::vector<bool>& keptPoints);
 		virtual Matches findClosests(const DataPoints& filteredReading);
 	};
 
@@ -36,6 +36,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "PointMatcher.h"
 #include "PointMatcherPrivate.h"
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 using namespace std;
 
 //! Construct empty matches
@@ -56,23 +60,35 @@ PointMatcher<T>::Matches::Matches(const int knn, const int pointsCount):
 	ids(Ids(knn, pointsCount))
 {}
 
-//! Get the distance at the T-ratio closest point
-template<typename T>
-T PointMatcher<T>::Matches::getDistsQuantile(const T quantile) const
+namespace
 {
-	// build array
-	vector<T> values;
-	values.reserve(dists.rows() * dists.cols());
-	for (int x = 0; x < dists.cols(); ++x)
+	//! Copy the finite distances into a per-thread buffer, reused from one call to the next to avoid allocating at every ICP iteration
+	template<typename T>
+	std::vector<T>& gatherFiniteDists(const typename PointMatcher<T>::Matches::Dists& dists)
 	{
-		for (int y = 0; y < dists.rows(); ++y)
+		static thread_local std::vector<T> values;
+		values.clear();
+		values.reserve(dists.size());
+		const T* const begin(dists.data());
+		const T* const end(begin + dists.size());
+		for (const T* it = begin; it != end; ++it)
 		{
-			if (dists(y, x) != numeric_limits<T>::infinity())
-			{
-				values.push_back(dists(y, x));
-			}
+			if (*it != numeric_limits<T>::infinity())
+				values.push_back(*it);
 		}
+		return values;
 	}
+}
+
+//! Get the distance at the T-ratio closest point
+/**
+	The distance is found by selection in linear time, without sorting.
+*/
+template<typename T>
+T PointMatcher<T>::Matches::getDistsQuantile(const T quantile) const
+{
+	// build array
+	vector<T>& values(gatherFiniteDists<T>(dists));
 	if (values.size() == 0)
 		throw ConvergenceError("no outlier to filter");
 
@@ -90,20 +106,7 @@ T PointMatcher<T>::Matches::getDistsQuantile(const T quantile) const
 template<typename T>
 T PointMatcher<T>::Matches::getMedianAbsDeviation() const
 {
-	vector<T> values;
-	values.reserve(dists.rows() * dists.cols());
-	const long cols = dists.cols();
-	const long rows = dists.rows();
-	for (int x = 0; x < cols; ++x)
-	{
-		for (int y = 0; y < rows; ++y)
-		{
-			if (dists(y, x) != numeric_limits<T>::infinity())
-			{
-				values.push_back(dists(y, x));
-			}
-		}
-	}
+	vector<T>& values(gatherFiniteDists<T>(dists));
 	if (values.size() == 0)
 		throw ConvergenceError("no outlier to filter");
 
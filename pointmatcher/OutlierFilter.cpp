@@ -35,6 +35,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "PointMatcher.h"
 #include "PointMatcherPrivate.h"
+#include "Parallel.h"
+#include "Timer.h"
 #include <limits>
 
 using namespace std;
@@ -55,6 +57,63 @@ template<typename T>
 PointMatcher<T>::OutlierFilter::~OutlierFilter()
 {}
 
+//! Default to compute(), for filters that do not use point-to-plane distances
+template<typename T>
+typename PointMatcher<T>::OutlierWeights PointMatcher<T>::OutlierFilter::computeWithPointToPlaneDistances(
+	const DataPoints& filteredReading,
+	const DataPoints& filteredReference,
+	const Matches& input,
+	const Matrix& pointToPlaneDistances)
+{
+	return compute(filteredReading, filteredReference, input);
+}
+
+//! By default filters do not use point-to-plane distances
+template<typename T>
+bool PointMatcher<T>::OutlierFilter::usesPointToPlaneDistances(unsigned& nbThreads) const
+{
+	return false;
+}
+
+//! Compute dot(n, p-q)² / |n|² for every match in a single pass, each thread processing a contiguous chunk of reading points
+template<typename T>
+typename PointMatcher<T>::Matrix PointMatcher<T>::OutlierFilter::computePointToPlaneDistances(
+	const DataPoints& filteredReading,
+	const DataPoints& filteredReference,
+	const Matches& input,
+	const unsigned nbThreads)
+{
+	typedef typename DataPoints::ConstView ConstView;
+
+	const ConstView normals(filteredReference.getDescriptorViewByName("normals"));
+	const int dim(normals.rows());
+	const int knn(input.ids.rows());
+	const int readPtsCount(input.ids.cols());
+
+	Matrix dists(Matrix::Zero(knn, readPtsCount));
+	const unsigned chunkCount(PointMatcherSupport::getChunkCount(readPtsCount, nbThreads, 1024));
+	PointMatcherSupport::parallelForChunks(readPtsCount, chunkCount, [&](const unsigned, const size_t begin, const size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			for (int j = 0; j < knn; ++j)
+			{
+				const int referenceId(input.ids(j, i));
+				if (referenceId == Matches::InvalidId)
+					continue;
+
+				const T normalSquaredNorm(normals.col(referenceId).squaredNorm());
+				if (normalSquaredNorm == T(0))
+					continue;
+				const T projection(normals.col(referenceId).dot(filteredReading.features.col(i).head(dim) - filteredReference.features.col(referenceId).head(dim)));
+				dists(j, i) = projection * projection / normalSquaredNorm;
+			}
+		}
+	});
+
+	return dists;
+}
+
 template struct PointMatcher<float>::OutlierFilter;
 template struct PointMatcher<double>::OutlierFilter;
 
@@ -66,6 +125,8 @@ typename PointMatcher<T>::OutlierWeights PointMatcher<T>::OutlierFilters::comput
 	const DataPoints& filteredReference,
 	const Matches& input)
 {
+	PointMatcherSupport::Trace::ScopedTimer scope("OutlierFilters", "OutlierFilters::compute");
+	
 	//FIXME: Why we filter infinit distance only when no filter?
 	if (this->empty())
 	{
@@ -85,15 +146,39 @@ typename PointMatcher<T>::OutlierWeights PointMatcher<T>::OutlierFilters::comput
 	}
 	else
 	{
+		// compute point-to-plane distances once for all the filters using them
+		bool usePointToPlaneDistances(false);
+		unsigned nbThreads(1);
+		for (OutlierFiltersConstIt it = this->begin(); it != this->end(); ++it)
+		{
+			unsigned filterNbThreads(1);
+			if ((*it)->usesPointToPlaneDistances(filterNbThreads))
+			{
+				usePointToPlaneDistances = true;
+				nbThreads = std::max(nbThreads, PointMatcherSupport::getThreadCount(filterNbThreads));
+			}
+		}
+		Matrix pointToPlaneDistances;
+		if (usePointToPlaneDistances)
+		{
+			PointMatcherSupport::Trace::ScopedTimer distancesScope("PointToPlaneDistances", "OutlierFilter::computePointToPlaneDistances");
+			pointToPlaneDistances = OutlierFilter::computePointToPlaneDistances(filteredReading, filteredReference, input, nbThreads);
+		}
+
 		// apply filters, they should take care of infinite distances
 		//LOG_INFO_STREAM("Applying " << this->size() << " Outlier filters" );
-		OutlierWeights w = (*this->begin())->compute(filteredReading, filteredReference, input);
+		OutlierWeights w;
+		{
+			PointMatcherSupport::Trace::ScopedTimer filterScope((*this->begin())->className, "OutlierFilter::compute");
+			w = (*this->begin())->computeWithPointToPlaneDistances(filteredReading, filteredReference, input, pointToPlaneDistances);
+		}
 		//LOG_INFO_STREAM("* " << (*this->begin())->className );
 		if (this->size() > 1)
 		{
 			for (OutlierFiltersConstIt it = (this->begin() + 1); it != this->end(); ++it)
 			{
-				w = w.array() * (*it)->compute(filteredReading, filteredReference, input).array();
+				PointMatcherSupport::Trace::ScopedTimer filterScope((*it)->className, "OutlierFilter::compute");
+				w.array() *= (*it)->computeWithPointToPlaneDistances(filteredReading, filteredReference, input, pointToPlaneDistances).array();
 				//LOG_INFO_STREAM("* " << (*it)->className );
 			}
 		}
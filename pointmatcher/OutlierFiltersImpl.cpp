@@ -169,52 +169,76 @@ typename PointMatcher<T>::OutlierWeights OutlierFiltersImpl<T>::VarTrimmedDistOu
 	const DataPoints& filteredReference,
 	const Matches& input)
 {
-	const T tunedRatio = optimizeInlierRatio(input);
+	T limit;
+	const T tunedRatio = optimizeInlierRatio(input, limit);
 	LOG_INFO_STREAM("Optimized ratio: " << tunedRatio);
 
-	const T limit = input.getDistsQuantile(tunedRatio);
 	return OutlierWeights((input.dists.array() <= limit).template cast<T>());
 }
 
+//! Find the ratio minimizing the fractional RMSD, sorting the distances only once
+/**
+	limit is set to input.getDistsQuantile(ratio), read from the same sorted distances.
+*/
 template<typename T>
-T OutlierFiltersImpl<T>::VarTrimmedDistOutlierFilter::optimizeInlierRatio(const Matches& matches)
+T OutlierFiltersImpl<T>::VarTrimmedDistOutlierFilter::optimizeInlierRatio(const Matches& matches, T& limit)
 {
 	typedef typename PointMatcher<T>::ConvergenceError ConvergenceError;
-	typedef typename Eigen::Array<T, Eigen::Dynamic, 1> LineArray;
 	
 	const int points_nbr = matches.dists.rows() * matches.dists.cols();
 	
-	// vector containing the squared distances of the matches
-	std::vector<T> tmpSortedDist;
-	tmpSortedDist.reserve(points_nbr);
-	for (int x = 0; x < matches.dists.cols(); ++x)
-		for (int y = 0; y < matches.dists.rows(); ++y)
-			if ((matches.dists(y, x) != numeric_limits<T>::infinity()) && (matches.dists(y, x) > 0))
-				tmpSortedDist.push_back(matches.dists(y, x));
-	if (tmpSortedDist.size() == 0)
+	// positive squared distances of the matches, the other finite ones being counted apart
+	sortedDists.clear();
+	sortedDists.reserve(points_nbr);
+	size_t nonPositiveCount = 0;
+	const T* const distsEnd(matches.dists.data() + points_nbr);
+	for (const T* dist = matches.dists.data(); dist != distsEnd; ++dist)
+	{
+		if (*dist == numeric_limits<T>::infinity())
+			continue;
+		if (*dist > 0)
+			sortedDists.push_back(*dist);
+		else
+			++nonPositiveCount;
+	}
+	if (sortedDists.size() == 0)
 		throw ConvergenceError("no outlier to filter");
 			
-	std::sort(tmpSortedDist.begin(), tmpSortedDist.end());
-	std::vector<T> tmpCumSumSortedDist;
-	tmpCumSumSortedDist.reserve(points_nbr);
-	std::partial_sum(tmpSortedDist.begin(), tmpSortedDist.end(), tmpCumSumSortedDist.begin());
+	std::sort(sortedDists.begin(), sortedDists.end());
 
 	const int minEl = floor(this->minRatio*points_nbr);
-	const int maxEl = floor(this->maxRatio*points_nbr);
-
-	// Return std::vector to an eigen::vector
-	Eigen::Map<LineArray> sortedDist(&tmpCumSumSortedDist[0], points_nbr);
-
-	const LineArray trunkSortedDist = sortedDist.segment(minEl, maxEl-minEl);
+	const int maxEl = std::min<int>(floor(this->maxRatio*points_nbr), sortedDists.size());
+
+	// frms = cumSumDists[minEl:maxEl] / id / (f^λ)², with f = id / points_nbr
+	T cumSumDist(0);
+	for (int i = 0; i < minEl && i < maxEl; ++i)
+		cumSumDist += sortedDists[i];
+	int minIndex(minEl);
+	T minFRMS(numeric_limits<T>::infinity());
+	for (int i = minEl; i < maxEl; ++i)
+	{
+		cumSumDist += sortedDists[i];
+		const T id(i + 1);
+		const T deno(pow(id / points_nbr, this->lambda)); // f^λ
+		const T invDeno(T(1) / deno);
+		const T frms(cumSumDist * (T(1) / id) * (invDeno * invDeno));
+		if (frms < minFRMS)
+		{
+			minFRMS = frms;
+			minIndex = i;
+		}
+	}
+	const T optRatio = (float)(minIndex)/ (float)points_nbr;
 
-	const LineArray ids = LineArray::LinSpaced(trunkSortedDist.rows(), minEl+1, maxEl);
-	const LineArray ratio = ids / points_nbr; // ratio for each of element between minEl and maxEl
-	const LineArray deno = ratio.pow(this->lambda); // f^λ
-	// frms = cumSumDists[minEl:maxEl] / id / (f^λ)²
-	const LineArray FRMS = trunkSortedDist * ids.inverse() * deno.inverse().square() ;
-	int minIndex(0);// = FRMS.minCoeff();
-	FRMS.minCoeff(&minIndex);
-	const T optRatio = (float)(minIndex + minEl)/ (float)points_nbr;
+	// distance quantile at the optimized ratio, counting the non-positive distances first
+	const size_t finiteCount(sortedDists.size() + nonPositiveCount);
+	if (optRatio == 1.0)
+		limit = sortedDists.back();
+	else
+	{
+		const size_t limitId(finiteCount * optRatio);
+		limit = limitId < nonPositiveCount ? T(0) : sortedDists[limitId - nonPositiveCount];
+	}
 	
 	return optRatio;
 }
@@ -401,6 +425,7 @@ OutlierFiltersImpl<T>::RobustOutlierFilter::RobustOutlierFilter(const std::strin
 	scaleEstimator(Parametrizable::get<string>("scaleEstimator")),
 	nbIterationForScale(Parametrizable::get<int>("nbIterationForScale")),
 	distanceType(Parametrizable::get<string>("distanceType")),
+	nbThreads(Parametrizable::get<unsigned>("nbThreads")),
 	robustFctId(-1),
 	iteration(1),
 	scale(0.0),
@@ -456,10 +481,26 @@ typename PointMatcher<T>::OutlierWeights OutlierFiltersImpl<T>::RobustOutlierFil
 		const DataPoints& filteredReference,
 		const Matches& input)
 {
-	return this->robustFiltering(filteredReading, filteredReference, input);
+	const bool usePointToPlane(distanceType == "point2plane");
+	return this->robustFiltering(input, usePointToPlane ? computePointToPlaneDistance(filteredReading, filteredReference, input) : Matrix());
 }
 
+template<typename T>
+typename PointMatcher<T>::OutlierWeights OutlierFiltersImpl<T>::RobustOutlierFilter::computeWithPointToPlaneDistances(
+		const DataPoints& filteredReading,
+		const DataPoints& filteredReference,
+		const Matches& input,
+		const Matrix& pointToPlaneDistances)
+{
+	return this->robustFiltering(input, pointToPlaneDistances);
+}
 
+template<typename T>
+bool OutlierFiltersImpl<T>::RobustOutlierFilter::usesPointToPlaneDistances(unsigned& pointToPlaneThreads) const
+{
+	pointToPlaneThreads = nbThreads;
+	return distanceType == "point2plane";
+}
 
 template<typename T>
 typename PointMatcher<T>::Matrix
@@ -468,41 +509,13 @@ OutlierFiltersImpl<T>::RobustOutlierFilter::computePointToPlaneDistance(
 		const DataPoints& reference,
 		const Matches& input) {
 
-	int nbr_read_point = input.dists.cols();
-	int nbr_match = input.dists.rows();
-
-	Matrix normals = reference.getDescriptorViewByName("normals");
-
-	Vector reading_point(Vector::Zero(3));
-	Vector reference_point(Vector::Zero(3));
-	Vector normal(3);
-
-	Matrix dists(Matrix::Zero(nbr_match, nbr_read_point));
-
-	for(int i = 0; i < nbr_read_point; ++i)
-	{
-		reading_point = reading.features.block(0, i, 3, 1);
-		for(int j = 0; j < nbr_match; ++j)
-		{
-			const int reference_idx = input.ids(j, i);
-			if (reference_idx != Matches::InvalidId) {
-				reference_point = reference.features.block(0, reference_idx, 3, 1);
-
-				normal = normals.col(reference_idx).normalized();
-				// distance_point_to_plan = dot(n, p-q)²
-				dists(j, i) = pow(normal.dot(reading_point-reference_point), 2);
-			}
-		}
-	}
-
-	return dists;
+	return OutlierFilter::computePointToPlaneDistances(reading, reference, input, nbThreads);
 }
 
 template<typename T>
 typename PointMatcher<T>::OutlierWeights OutlierFiltersImpl<T>::RobustOutlierFilter::robustFiltering(
-		const DataPoints& filteredReading,
-		const DataPoints& filteredReference,
-		const Matches& input) {
+		const Matches& input,
+		const Matrix& pointToPlaneDistances) {
 
 	if (scaleEstimator == "mad")
 	{
@@ -539,7 +552,7 @@ typename PointMatcher<T>::OutlierWeights OutlierFiltersImpl<T>::RobustOutlierFil
 	}
 	iteration++;
 
-	Matrix dists = distanceType == "point2point" ? input.dists : computePointToPlaneDistance(filteredReading, filteredReference, input);
+	const Matrix& dists = distanceType == "point2point" ? input.dists : pointToPlaneDistances;
 
 	// e² = scaled squared distance
 	Array e2 = dists.array() / (scale * scale);
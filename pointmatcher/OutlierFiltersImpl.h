@@ -167,8 +167,10 @@ struct OutlierFiltersImpl
 		virtual OutlierWeights compute(const DataPoints& filteredReading, const DataPoints& filteredReference, const Matches& input);
 		
 	private:
-		// return the optimized ratio
-		T optimizeInlierRatio(const Matches& matches);
+		// return the optimized ratio, and in limit the distance quantile at this ratio
+		T optimizeInlierRatio(const Matches& matches, T& limit);
+
+		std::vector<T> sortedDists; //!< positive finite distances, reused across calls
 	};
 	
 	
@@ -240,12 +242,15 @@ struct OutlierFiltersImpl
 				  "'berg': an iterative exponentially decreasing estimator", "mad"},
 				{"nbIterationForScale", "For how many iteration the 'scaleEstimator' is recalculated. After 'nbIterationForScale' iteration the previous scale is kept. A nbIterationForScale==0 means that the estiamtor is recalculated at each iteration.", "0", "0", "100", &P::Comp<int>},
 				{"distanceType", "Type of error distance used, either point to point ('point2point') or point to plane('point2plane'). Point to point gives better result normally.", "point2point"},
-				{"approximation", "If the matched distance is larger than this threshold, its weight will be forced to zero. This can save computation as zero values are not minimized. If set to inf (default value), no approximation is done. The unit of this parameter is the same as the distance used, typically meters.", "inf", "0.0", "inf", &P::Comp<T>}
+				{"approximation", "If the matched distance is larger than this threshold, its weight will be forced to zero. This can save computation as zero values are not minimized. If set to inf (default value), no approximation is done. The unit of this parameter is the same as the distance used, typically meters.", "inf", "0.0", "inf", &P::Comp<T>},
+				{"nbThreads", "number of threads used to compute point-to-plane distances, each one processing a contiguous chunk of reading points. 0: one thread per hardware thread", "1", "0", "2147483647", &P::Comp<unsigned>}
 			};
 		}
 
 		Matrix computePointToPlaneDistance(const DataPoints& filteredReading, const DataPoints& filteredReference, const Matches& input);
 		virtual OutlierWeights compute(const DataPoints& filteredReading, const DataPoints& filteredReference, const Matches& input);
+		virtual OutlierWeights computeWithPointToPlaneDistances(const DataPoints& filteredReading, const DataPoints& filteredReference, const Matches& input, const Matrix& pointToPlaneDistances);
+		virtual bool usesPointToPlaneDistances(unsigned& nbThreads) const;
 		RobustOutlierFilter(const std::string& className, const ParametersDoc paramsDoc, const Parameters& params);
 		RobustOutlierFilter(const Parameters& params = Parameters());
 		protected:
@@ -267,6 +272,7 @@ struct OutlierFiltersImpl
 		const std::string scaleEstimator;
 		const int nbIterationForScale;
 		const std::string distanceType;
+		const unsigned nbThreads;
 		int robustFctId;
 		int iteration;
 		T scale;
@@ -274,7 +280,7 @@ struct OutlierFiltersImpl
 
 
 		virtual void resolveEstimatorName();
-		virtual OutlierWeights robustFiltering(const DataPoints& filteredReading, const DataPoints& filteredReference, const Matches& input);
+		virtual OutlierWeights robustFiltering(const Matches& input, const Matrix& pointToPlaneDistances);
 	};
 
 }; // OutlierFiltersImpl
@@ -0,0 +1,99 @@
+// kate: replace-tabs off; indent-width 4; indent-mode normal
+// vim: ts=4:sw=4:noexpandtab
+/*
+
+Copyright (c) 2010--2012,
+François Pomerleau and Stephane Magnenat, ASL, ETHZ, Switzerland
+You can contact the authors at <f dot pomerleau at gmail dot com> and
+<stephane at magnenat dot net>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ETH-ASL BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef __POINTMATCHER_PARALLEL_H
+#define __POINTMATCHER_PARALLEL_H
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace PointMatcherSupport
+{
+	//! Return the number of threads to use for a given nbThreads parameter, 0 meaning one per hardware thread
+	inline unsigned getThreadCount(const unsigned nbThreads)
+	{
+		if (nbThreads != 0)
+			return nbThreads;
+		const unsigned hardwareThreads(std::thread::hardware_concurrency());
+		return hardwareThreads == 0 ? 1 : hardwareThreads;
+	}
+
+	//! Return in how many chunks count elements should be split for nbThreads threads, while keeping at least minChunkSize elements per chunk
+	inline unsigned getChunkCount(const size_t count, const unsigned nbThreads, const size_t minChunkSize = 1)
+	{
+		const size_t maxChunkCount(std::max<size_t>(1, count / std::max<size_t>(1, minChunkSize)));
+		return unsigned(std::min<size_t>(getThreadCount(nbThreads), maxChunkCount));
+	}
+
+	//! Return the first element of a given chunk when splitting count elements in chunkCount contiguous chunks
+	inline size_t getChunkBegin(const size_t count, const unsigned chunkCount, const unsigned chunk)
+	{
+		return (count * chunk) / chunkCount;
+	}
+
+	//! Call f(chunk, begin, end) on every contiguous chunk of [0, count), each chunk running on its own thread
+	/**
+		The partition only depends on count and chunkCount, so that per-chunk
+		results reduced in chunk order are deterministic.
+		The first chunk is processed by the calling thread.
+		An exception thrown by f is rethrown in the calling thread.
+	*/
+	template<typename F>
+	void parallelForChunks(const size_t count, const unsigned chunkCount, F f)
+	{
+		if (chunkCount <= 1)
+		{
+			f(0u, size_t(0), count);
+			return;
+		}
+
+		std::vector<std::future<void>> futures;
+		futures.reserve(chunkCount - 1);
+		for (unsigned chunk = 1; chunk < chunkCount; ++chunk)
+		{
+			const size_t begin(getChunkBegin(count, chunkCount, chunk));
+			const size_t end(getChunkBegin(count, chunkCount, chunk + 1));
+			futures.push_back(std::async(std::launch::async, [&f, chunk, begin, end]() { f(chunk, begin, end); }));
+		}
+		f(0u, size_t(0), getChunkBegin(count, chunkCount, 1));
+
+		for (auto& future: futures)
+			future.get();
+	}
+
+} // PointMatcherSupport
+
+#endif // __POINTMATCHER_PARALLEL_H
@@ -56,6 +56,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <iostream>
 #include <ostream>
 #include <memory>
+#include <functional>
 //#include <cstdint>
 #include <boost/cstdint.hpp>
 
@@ -115,6 +116,9 @@ namespace PointMatcherSupport
 		virtual void beginWarningEntry(const char *file, unsigned line, const char *func);
 		virtual std::ostream* warningStream();
 		virtual void finishWarningEntry(const char *file, unsigned line, const char *func);
+		virtual bool hasConcurrentEntries() const;
+		virtual void writeInfoEntry(const char *file, unsigned line, const char *func, const std::string& message);
+		virtual void writeWarningEntry(const char *file, unsigned line, const char *func, const std::string& message);
 	};
 	
 	void setLogger(std::shared_ptr<Logger> newLogger);
@@ -410,6 +414,9 @@ struct PointMatcher
 		//! Transform input using the transformation matrix
 		virtual DataPoints compute(const DataPoints& input, const TransformationParameters& parameters) const = 0; 
 
+		//! Transform input into output using the transformation matrix, reusing the storage of output when possible
+		virtual void compute(const DataPoints& input, const TransformationParameters& parameters, DataPoints& output) const;
+
 		//! Return whether the given parameters respect the expected constraints
 		virtual bool checkParameters(const TransformationParameters& parameters) const = 0;
 
@@ -422,6 +429,7 @@ struct PointMatcher
 	struct Transformations: public std::vector<std::shared_ptr<Transformation> >
 	{
 		void apply(DataPoints& cloud, const TransformationParameters& parameters) const;
+		void apply(const DataPoints& input, const TransformationParameters& parameters, DataPoints& output) const;
 	};
 	typedef typename Transformations::iterator TransformationsIt; //!< alias
 	typedef typename Transformations::const_iterator TransformationsConstIt; //!< alias
@@ -446,6 +454,13 @@ struct PointMatcher
 
 		//! Apply these filters to a point cloud without copying.
 		virtual void inPlaceFilter(DataPoints& cloud) = 0;
+
+		//! Return whether this filter can process a cloud chunk by chunk in DataPointsFilters::applyStreaming()
+		virtual bool isStreamable() const;
+		//! Filter the next chunk of a streamed cloud in place. By default filter it on its own, filters aggregating points over chunks keep what they need and empty it.
+		virtual void inPlaceFilterChunk(DataPoints& chunk);
+		//! Once all chunks were seen, move the points held back by this filter to cloud and get ready for a new stream. Return false if there are none, which is the default.
+		virtual bool finishStream(DataPoints& cloud);
 	};
 	
 	//! A chain of DataPointsFilter
@@ -455,6 +470,7 @@ struct PointMatcher
 		DataPointsFilters(std::istream& in);
 		void init();
 		void apply(DataPoints& cloud);
+		void applyStreaming(const std::function<bool(DataPoints&)>& source, const std::function<void(const DataPoints&)>& sink);
 	};
 	typedef typename DataPointsFilters::iterator DataPointsFiltersIt; //!< alias
 	typedef typename DataPointsFilters::const_iterator DataPointsFiltersConstIt; //!< alias
@@ -480,6 +496,10 @@ struct PointMatcher
 		
 		//! Init this matcher to find nearest neighbor in filteredReference
 		virtual void init(const DataPoints& filteredReference) = 0;
+		//! Update this matcher after points were appended to the reference, filteredReference being the whole reference and its new points starting at column firstNewPoint
+		virtual void appendToReference(const DataPoints& filteredReference, const int firstNewPoint);
+		//! Update this matcher after points were removed from the reference, filteredReference being what remains and keptPoints telling which points of the previous reference are left
+		virtual void removeFromReference(const DataPoints& filteredReference, const std::vector<bool>& keptPoints);
 		//! Find the closest neighbors of filteredReading in filteredReference passed to init()
 		virtual Matches findClosests(const DataPoints& filteredReading) = 0;
 	};
@@ -502,6 +522,12 @@ struct PointMatcher
 		
 		//! Detect outliers using features
 		virtual OutlierWeights compute(const DataPoints& filteredReading, const DataPoints& filteredReference, const Matches& input) = 0;
+		//! Detect outliers using the squared point-to-plane distances of the matches, which a chain computes once for all its filters; default to compute()
+		virtual OutlierWeights computeWithPointToPlaneDistances(const DataPoints& filteredReading, const DataPoints& filteredReference, const Matches& input, const Matrix& pointToPlaneDistances);
+		//! Return whether the filter uses the squared point-to-plane distances of the matches, and if so set how many threads should compute them
+		virtual bool usesPointToPlaneDistances(unsigned& nbThreads) const;
+		//! Return the squared distances of the reading points to the planes of their matched reference points, laid out as input.dists
+		static Matrix computePointToPlaneDistances(const DataPoints& filteredReading, const DataPoints& filteredReference, const Matches& input, const unsigned nbThreads = 1);
 	};
 	
 	
@@ -509,6 +535,7 @@ struct PointMatcher
 	struct OutlierFilters: public std::vector<std::shared_ptr<OutlierFilter> >
 	{
 		
+		//! Apply every filter and multiply their weights, sharing the point-to-plane distances between the filters that use them
 		OutlierWeights compute(const DataPoints& filteredReading, const DataPoints& filteredReference, const Matches& input);
 		
 	};
@@ -526,6 +553,8 @@ struct PointMatcher
 	*/
 	struct ErrorMinimizer: public Parametrizable
 	{
+		typedef std::vector<std::string> StringVector; //!< a vector of strings
+
 		//! A structure holding data ready for minimization. The data are "normalized", for instance there are no points with 0 weight, etc.
 		struct ErrorElements
 		{
@@ -540,6 +569,13 @@ struct PointMatcher
 
 			ErrorElements();
 			ErrorElements(const DataPoints& requestedPts, const DataPoints& sourcePts, const OutlierWeights& outlierWeights, const Matches& matches);
+			void gather(const DataPoints& requestedPts, const DataPoints& sourcePts, const OutlierWeights& outlierWeights, const Matches& matches, const StringVector* requestedDescriptors, const StringVector* sourceDescriptors);
+
+		private:
+			typedef typename DataPoints::Label Label;
+			typedef typename DataPoints::Labels Labels;
+			static void selectDescriptors(const DataPoints& cloud, const StringVector* names, Labels& labels, std::vector<std::pair<int, int> >& blocks);
+			static void gatherDescriptors(const DataPoints& cloud, const std::vector<std::pair<int, int> >& blocks, const int srcCol, Matrix& dst, const int dstCol);
 		};
 		
 		ErrorMinimizer();
@@ -557,6 +593,10 @@ struct PointMatcher
 		virtual TransformationParameters compute(const DataPoints& filteredReading, const DataPoints& filteredReference, const OutlierWeights& outlierWeights, const Matches& matches);
 		//! Find the transformation that minimizes the error given matched pair of points. This function most be defined for all new instances of ErrorMinimizer.
 		virtual TransformationParameters compute(const ErrorElements& matchedPoints) = 0;
+		//! Find the transformation that minimizes the error, gathering only the required descriptors into the storage of the last error elements
+		TransformationParameters computeReusingBuffers(const DataPoints& filteredReading, const DataPoints& filteredReference, const OutlierWeights& outlierWeights, const Matches& matches);
+		//! Get the names of the reading and reference descriptors used by this minimizer, return false if it might use any of them
+		virtual bool getRequiredDescriptors(StringVector& readingDescriptors, StringVector& referenceDescriptors) const;
 		
 		// helper functions
 		static Matrix crossProduct(const Matrix& A, const Matrix& B);//TODO: this might go in pointmatcher_support namespace
@@ -698,6 +738,27 @@ struct PointMatcher
 	//! ICP algorithm
 	struct ICP: ICPChainBase
 	{
+		//! A reference point cloud filtered, centered on its mean and indexed once, against which many readings can be registered
+		/**
+			The matcher holds a reference to the features of the reference cloud, so this object can neither be copied nor moved.
+			It can be shared by several ICP objects, as long as they do not use it concurrently.
+		*/
+		struct PreparedReference
+		{
+			DataPoints reference; //!< reference after the filters were applied, expressed in frame <refMean>
+			TransformationParameters T_refIn_refMean; //!< offset of the center of mass of the filtered reference
+			unsigned referenceInPtsCount; //!< number of points of the reference before filtering
+			std::shared_ptr<Matcher> matcher; //!< matcher initialized with reference
+
+			PreparedReference();
+
+		private:
+			PreparedReference(const PreparedReference&);
+			PreparedReference& operator=(const PreparedReference&);
+		};
+
+		ICP();
+
 		TransformationParameters operator()(
 			const DataPoints& readingIn,
 			const DataPoints& referenceIn);
@@ -706,15 +767,36 @@ struct PointMatcher
 			const DataPoints& readingIn,
 			const DataPoints& referenceIn,
 			const TransformationParameters& initialTransformationParameters);
-		
+
 		TransformationParameters compute(
 			const DataPoints& readingIn,
 			const DataPoints& referenceIn,
 			const TransformationParameters& initialTransformationParameters);
 
+		std::shared_ptr<PreparedReference> prepareReference(const DataPoints& referenceIn);
+
+		TransformationParameters operator()(
+			const DataPoints& readingIn,
+			const PreparedReference& reference);
+
+		TransformationParameters operator()(
+			const DataPoints& readingIn,
+			const PreparedReference& reference,
+			const TransformationParameters& initialTransformationParameters);
+
+		TransformationParameters compute(
+			const DataPoints& readingIn,
+			const PreparedReference& reference,
+			const TransformationParameters& initialTransformationParameters);
+
 		//! Return the filtered point cloud reading used in the ICP chain
 		const DataPoints& getReadingFiltered() const { return readingFiltered; }
 
+		//! Enable or disable reusing persistent buffers across iterations and calls, instead of copying the reading at every iteration
+		void setReuseBuffers(const bool reuse) { reuseBuffers = reuse; }
+		//! Return whether persistent buffers are reused across iterations and calls
+		bool getReuseBuffers() const { return reuseBuffers; }
+
 	protected:
 		TransformationParameters computeWithTransformedReference(
 			const DataPoints& readingIn, 
@@ -722,7 +804,19 @@ struct PointMatcher
 			const TransformationParameters& T_refIn_refMean,
 			const TransformationParameters& initialTransformationParameters);
 
+		TransformationParameters computeWithTransformedReference(
+			const DataPoints& readingIn,
+			const DataPoints& reference,
+			Matcher& matcher,
+			const TransformationParameters& T_refIn_refMean,
+			const TransformationParameters& initialTransformationParameters);
+
 		DataPoints readingFiltered; //!< reading point cloud after the filters were applied
+
+		bool reuseBuffers; //!< if true, the iterations work in the buffers below instead of allocating new point clouds
+		DataPoints readingBuffer; //!< filtered reading expressed in the reference mean frame
+		DataPoints stepReadingBuffer; //!< reading after the step filters
+		DataPoints transformedReadingBuffer; //!< reading moved by the current iteration transformation
 	};
 	
 	//! ICP alogrithm, taking a sequence of clouds and using a map
@@ -740,6 +834,8 @@ struct PointMatcher
 		
 		bool hasMap() const;
 		bool setMap(const DataPoints& map);
+		bool insertPoints(const DataPoints& newPoints);
+		unsigned removePoints(const Vector& minCorner, const Vector& maxCorner);
 		void clearMap();
 		virtual void setDefault();
 		virtual void loadFromYaml(std::istream& in);
@@ -36,6 +36,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef __POINTMATCHER_PRIVATE_H
 #define __POINTMATCHER_PRIVATE_H
 
+#include <memory>
+#include <sstream>
+
 namespace PointMatcherSupport
 {
 	//! Mutex to protect creation and deletion of logger
@@ -53,24 +56,39 @@ namespace PointMatcherSupport
 	#endif
 	
 	// macros for logging
+	// Loggers with concurrent entries receive messages formatted by the calling thread, others are written under loggerMutex
 	#define LOG_INFO_STREAM(args) \
 	{ \
-		boost::mutex::scoped_lock lock(PointMatcherSupport::loggerMutex); \
-		if (PointMatcherSupport::logger.get() && \
-			PointMatcherSupport::logger->hasInfoChannel()) { \
-			PointMatcherSupport::logger->beginInfoEntry(__FILE__, __LINE__, __POINTMATCHER_FUNCTION__); \
-			(*PointMatcherSupport::logger->infoStream()) << args; \
-			PointMatcherSupport::logger->finishInfoEntry(__FILE__, __LINE__, __POINTMATCHER_FUNCTION__); \
+		const std::shared_ptr<PointMatcherSupport::Logger> currentLogger(std::atomic_load(&PointMatcherSupport::logger)); \
+		if (currentLogger.get() && \
+			currentLogger->hasInfoChannel()) { \
+			if (currentLogger->hasConcurrentEntries()) { \
+				std::ostringstream message; \
+				message << args; \
+				currentLogger->writeInfoEntry(__FILE__, __LINE__, __POINTMATCHER_FUNCTION__, message.str()); \
+			} else { \
+				boost::mutex::scoped_lock lock(PointMatcherSupport::loggerMutex); \
+				currentLogger->beginInfoEntry(__FILE__, __LINE__, __POINTMATCHER_FUNCTION__); \
+				(*currentLogger->infoStream()) << args; \
+				currentLogger->finishInfoEntry(__FILE__, __LINE__, __POINTMATCHER_FUNCTION__); \
+			} \
 		} \
 	}
 	#define LOG_WARNING_STREAM(args) \
 	{ \
-		boost::mutex::scoped_lock lock(PointMatcherSupport::loggerMutex); \
-		if (PointMatcherSupport::logger.get() && \
-			PointMatcherSupport::logger->hasWarningChannel()) { \
-			PointMatcherSupport::logger->beginWarningEntry(__FILE__, __LINE__, __POINTMATCHER_FUNCTION__); \
-			(*PointMatcherSupport::logger->warningStream()) << args; \
-			PointMatcherSupport::logger->finishWarningEntry(__FILE__, __LINE__, __POINTMATCHER_FUNCTION__); \
+		const std::shared_ptr<PointMatcherSupport::Logger> currentLogger(std::atomic_load(&PointMatcherSupport::logger)); \
+		if (currentLogger.get() && \
+			currentLogger->hasWarningChannel()) { \
+			if (currentLogger->hasConcurrentEntries()) { \
+				std::ostringstream message; \
+				message << args; \
+				currentLogger->writeWarningEntry(__FILE__, __LINE__, __POINTMATCHER_FUNCTION__, message.str()); \
+			} else { \
+				boost::mutex::scoped_lock lock(PointMatcherSupport::loggerMutex); \
+				currentLogger->beginWarningEntry(__FILE__, __LINE__, __POINTMATCHER_FUNCTION__); \
+				(*currentLogger->warningStream()) << args; \
+				currentLogger->finishWarningEntry(__FILE__, __LINE__, __POINTMATCHER_FUNCTION__); \
+			} \
 		} \
 	}
 
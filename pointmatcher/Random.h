@@ -0,0 +1,91 @@
+// kate: replace-tabs off; indent-width 4; indent-mode normal
+// vim: ts=4:sw=4:noexpandtab
+/*
+
+Copyright (c) 2010--2012,
+François Pomerleau and Stephane Magnenat, ASL, ETHZ, Switzerland
+You can contact the authors at <f dot pomerleau at gmail dot com> and
+<stephane at magnenat dot net>
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the <organization> nor the
+      names of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL ETH-ASL BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef __POINTMATCHER_RANDOM_H
+#define __POINTMATCHER_RANDOM_H
+
+#include <cstdint>
+
+namespace PointMatcherSupport
+{
+	//! Counter-based random number generator
+	/**
+		The number drawn for an index only depends on the seed, the stream and
+		that index, so that numbers can be drawn in any order, by any thread,
+		with the same results. The generator has no state to share or to race on.
+		
+		The numbers of a stream are the ones of a SplitMix64 generator,
+		whose state is derived from the seed and the stream.
+	*/
+	class CounterRandom
+	{
+	public:
+		//! Create the generator of a given stream for seed, different streams giving independent numbers
+		explicit CounterRandom(const std::uint64_t seed, const std::uint64_t stream = 0):
+			key(mix(mix(seed) + stream))
+		{
+		}
+		
+		//! Return 64 random bits for index
+		std::uint64_t bits(const std::uint64_t index) const
+		{
+			return mix(key + (index + 1) * 0x9e3779b97f4a7c15ULL);
+		}
+		
+		//! Return a number uniformly distributed in [0, 1) for index
+		double uniform(const std::uint64_t index) const
+		{
+			return double(bits(index) >> 11) * (1. / 9007199254740992.);
+		}
+		
+		//! Return an integer uniformly distributed in [0, n) for index, n being at most 2^32
+		std::uint64_t uniformInt(const std::uint64_t index, const std::uint64_t n) const
+		{
+			return ((bits(index) >> 32) * n) >> 32;
+		}
+		
+	private:
+		//! Finalizer of SplitMix64
+		static std::uint64_t mix(std::uint64_t z)
+		{
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			return z ^ (z >> 31);
+		}
+		
+		const std::uint64_t key; //!< state of the SplitMix64 generator before its first number
+	};
+} // PointMatcherSupport
+
+#endif // __POINTMATCHER_RANDOM_H
@@ -35,6 +35,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "Timer.h"
 
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+
 #ifdef __MACH__
 #include <mach/clock.h>
 #include <mach/mach.h>
@@ -79,3 +84,124 @@ namespace PointMatcherSupport
 } // namespace PointMatcherSupport
 #endif // _POSIX_TIMERS
 
+namespace PointMatcherSupport
+{
+	thread_local Trace* activeTrace(0);
+	
+	Trace::Activation::Activation(Trace& trace):
+		previous(activeTrace)
+	{
+		activeTrace = &trace;
+	}
+	
+	Trace::Activation::~Activation()
+	{
+		activeTrace = previous;
+	}
+	
+	Trace::Trace():
+		origin(std::chrono::steady_clock::now()),
+		current(-1)
+	{
+	}
+	
+	void Trace::clear()
+	{
+		scopes.clear();
+		origin = std::chrono::steady_clock::now();
+		current = -1;
+	}
+	
+	double Trace::totalDuration(const std::string& name) const
+	{
+		double total(0);
+		for (Scopes::const_iterator it = scopes.begin(); it != scopes.end(); ++it)
+			if (it->name == name && it->duration >= 0)
+				total += it->duration;
+		return total;
+	}
+	
+	void Trace::dumpTree(std::ostream& os) const
+	{
+		std::ostringstream oss;
+		oss << std::fixed << std::setprecision(3);
+		for (Scopes::const_iterator it = scopes.begin(); it != scopes.end(); ++it)
+		{
+			oss << std::string(2 * it->depth, ' ') << it->name << " [" << it->category << "] ";
+			if (it->duration >= 0)
+				oss << it->duration * 1e3 << " ms\n";
+			else
+				oss << "open\n";
+		}
+		os << oss.str();
+	}
+	
+	//! Write str to os as a JSON string
+	static void writeJSONString(std::ostream& os, const std::string& str)
+	{
+		os << '"';
+		for (std::string::const_iterator it = str.begin(); it != str.end(); ++it)
+		{
+			const unsigned char c(*it);
+			if (c == '"' || c == '\\')
+				os << '\\' << char(c);
+			else if (c < 0x20)
+				os << "\\u" << std::hex << std::setw(4) << std::setfill('0') << unsigned(c) << std::dec << std::setfill(' ');
+			else
+				os << char(c);
+		}
+		os << '"';
+	}
+	
+	void Trace::saveChromeTrace(std::ostream& os) const
+	{
+		// complete events ("ph":"X") with times in microseconds,
+		// viewers rebuild the tree from the nesting of the time intervals
+		std::ostringstream oss;
+		oss << std::fixed << std::setprecision(3);
+		oss << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+		bool first(true);
+		for (Scopes::const_iterator it = scopes.begin(); it != scopes.end(); ++it)
+		{
+			if (it->duration < 0)
+				continue;
+			oss << (first ? "\n" : ",\n") << "{\"name\":";
+			writeJSONString(oss, it->name);
+			oss << ",\"cat\":";
+			writeJSONString(oss, it->category);
+			oss << ",\"ph\":\"X\",\"ts\":" << it->start * 1e6 << ",\"dur\":" << it->duration * 1e6;
+			oss << ",\"pid\":0,\"tid\":0,\"args\":{\"depth\":" << it->depth << "}}";
+			first = false;
+		}
+		oss << "\n]}\n";
+		os << oss.str();
+	}
+	
+	void Trace::saveChromeTrace(const std::string& fileName) const
+	{
+		std::ofstream ofs(fileName.c_str());
+		if (!ofs.good())
+			throw std::runtime_error("Cannot open file " + fileName + " to save the trace");
+		saveChromeTrace(ofs);
+	}
+	
+	size_t Trace::open(const std::string& name, const char* category)
+	{
+		const Scope scope = { name, category, elapsed(), -1, current, current < 0 ? 0 : scopes[current].depth + 1 };
+		scopes.push_back(scope);
+		current = int(scopes.size()) - 1;
+		return scopes.size() - 1;
+	}
+	
+	void Trace::close(size_t index)
+	{
+		Scope& scope(scopes[index]);
+		scope.duration = elapsed() - scope.start;
+		current = scope.parent;
+	}
+	
+	double Trace::elapsed() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - origin).count();
+	}
+} // namespace PointMatcherSupport
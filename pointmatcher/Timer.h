@@ -37,6 +37,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define __POINTMATCHER_TIMER_H
 
 #include <time.h>
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include <chrono>
 #ifndef WIN32
 #include <unistd.h>
 #endif // WIN32
@@ -81,4 +85,112 @@ namespace PointMatcherSupport
 }
 #endif // _POSIX_TIMERS
 
+namespace PointMatcherSupport
+{
+	struct Trace;
+	
+	//! Trace recording the timed scopes of the current thread, 0 if none
+	extern thread_local Trace* activeTrace;
+	
+	/**
+		Tree of nested timed scopes, to profile the stages of a pipeline
+		
+		Scopes are only recorded in a thread in which the trace is active,
+		see Trace::Activation. Elsewhere, a ScopedTimer costs a thread-local
+		load and a branch. A trace must only be active in one thread at a time.
+		
+		Times are wall-clock times from std::chrono::steady_clock, relative to
+		the creation of the trace. Unlike the CPU time of timer, they do not
+		sum the work of the threads of a parallel stage.
+	*/
+	struct Trace
+	{
+		//! A timed scope
+		struct Scope
+		{
+			std::string name; //!< name of the timed module or stage
+			const char* category; //!< kind of stage, a string literal
+			double start; //!< start time in seconds, since the creation of the trace
+			double duration; //!< duration in seconds, negative while the scope is open
+			int parent; //!< index of the enclosing scope, -1 for a root scope
+			unsigned depth; //!< number of enclosing scopes
+		};
+		typedef std::vector<Scope> Scopes;
+		
+		//! Record the scopes of the current thread into a trace, as long as the activation exists
+		struct Activation
+		{
+			Activation(Trace& trace);
+			~Activation();
+			
+		private:
+			Activation(const Activation&);
+			Activation& operator=(const Activation&);
+			
+			Trace* previous; //!< trace active before, restored at destruction
+		};
+		
+		//! Time the enclosing block into the active trace of the current thread, if any
+		struct ScopedTimer
+		{
+			//! Open a scope; name is only copied if a trace is active
+			ScopedTimer(const char* name, const char* category):
+				trace(activeTrace),
+				index(0)
+			{
+				if (trace)
+					index = trace->open(name, category);
+			}
+			//! Open a scope; name is only copied if a trace is active
+			ScopedTimer(const std::string& name, const char* category):
+				trace(activeTrace),
+				index(0)
+			{
+				if (trace)
+					index = trace->open(name, category);
+			}
+			//! Close the scope
+			~ScopedTimer()
+			{
+				if (trace)
+					trace->close(index);
+			}
+			
+		private:
+			ScopedTimer(const ScopedTimer&);
+			ScopedTimer& operator=(const ScopedTimer&);
+			
+			Trace* const trace; //!< trace receiving the scope, 0 if tracing is disabled
+			size_t index; //!< index of the scope in trace
+		};
+		
+		Scopes scopes; //!< recorded scopes, in opening order
+		
+		Trace();
+		
+		//! Remove all scopes and restart the clock, must not be called while a scope is open
+		void clear();
+		//! Return the sum of the durations of the closed scopes named name
+		double totalDuration(const std::string& name) const;
+		//! Write the scopes as an indented tree with durations in milliseconds
+		void dumpTree(std::ostream& os) const;
+		//! Write the scopes as Chrome trace-event JSON, which chrome://tracing and Perfetto display
+		void saveChromeTrace(std::ostream& os) const;
+		//! Write the scopes as Chrome trace-event JSON to the file fileName
+		void saveChromeTrace(const std::string& fileName) const;
+		
+	private:
+		//! Add a scope, nested in the innermost open one, and return its index
+		size_t open(const std::string& name, const char* category);
+		//! Set the duration of the scope at index and make its parent the innermost open one
+		void close(size_t index);
+		
+		//! Return the wall-clock time in seconds since origin
+		double elapsed() const;
+		
+		std::chrono::steady_clock::time_point origin; //!< origin of the times of the scopes
+		int current; //!< index of the innermost open scope, -1 if none
+	};
+} // namespace PointMatcherSupport
+
 #endif // __POINTMATCHER_TIMER_H
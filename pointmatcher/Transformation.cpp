@@ -52,6 +52,14 @@ template<typename T>
 PointMatcher<T>::Transformation::~Transformation()
 {}
 
+//! If not redefined by child class, compute a new point cloud and swap it into output
+template<typename T>
+void PointMatcher<T>::Transformation::compute(const DataPoints& input, const TransformationParameters& parameters, DataPoints& output) const
+{
+	DataPoints transformedCloud(compute(input, parameters));
+	swapDataPoints(output, transformedCloud);
+}
+
 template struct PointMatcher<float>::Transformation;
 template struct PointMatcher<double>::Transformation;
 
@@ -67,16 +75,25 @@ void PointMatcher<T>::Transformations::apply(DataPoints& cloud, const Transforma
 	// of chain for this classs. 
 	int num_iter = 0;
 
-	DataPoints transformedCloud;
 	for (TransformationsConstIt it = this->begin(); it != this->end(); ++it)
 	{
-		transformedCloud = (*it)->compute(cloud, parameters);
-		swapDataPoints(cloud, transformedCloud);
+		(*it)->compute(cloud, parameters, cloud);
 		num_iter++;
 	}
 	if (num_iter != 1)
 		throw std::runtime_error("Transformations: Error, the transform should have been applied just once.");
 }
 
+//! Apply this chain to input, writing the result into output without copying input
+template<typename T>
+void PointMatcher<T>::Transformations::apply(const DataPoints& input, const TransformationParameters& parameters, DataPoints& output) const
+{
+	// See the comment above, there must be exactly one transformation
+	if (this->size() != 1)
+		throw std::runtime_error("Transformations: Error, the transform should have been applied just once.");
+	
+	this->front()->compute(input, parameters, output);
+}
+
 template struct PointMatcher<float>::Transformations;
 template struct PointMatcher<double>::Transformations;
@@ -35,6 +35,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "PointMatcher.h"
 #include "PointMatcherPrivate.h"
+#include "Timer.h"
 
 //! Construct without parameter
 template<typename T>
@@ -119,6 +120,7 @@ void PointMatcher<T>::TransformationCheckers::init(const TransformationParameter
 template<typename T>
 void PointMatcher<T>::TransformationCheckers::check(const TransformationParameters& parameters, bool& iterate)
 {
+	PointMatcherSupport::Trace::ScopedTimer scope("TransformationCheckers", "TransformationCheckers::check");
 	for (TransformationCheckersIt it = this->begin(); it != this->end(); ++it)
 		(*it)->check(parameters, iterate);
 }
@@ -35,9 +35,12 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "TransformationsImpl.h"
 #include "Functions.h"
+#include "Parallel.h"
 
 #include <iostream>
 
+#include <boost/format.hpp>
+
 using namespace PointMatcherSupport;
 
 //! Construct a transformation exception
@@ -45,47 +48,127 @@ TransformationError::TransformationError(const std::string& reason):
 	runtime_error(reason)
 {}
 
-//! RigidTransformation
+//! Write input transformed by parameters into output, reusing the storage of output when its size matches
+/**
+	The features and the direction descriptors (normals and observation
+	directions) of every point are transformed in a single pass over the
+	points, split in contiguous chunks processed by nbThreads threads.
+	Output can be input, in which case the transformation is done in place.
+*/
 template<typename T>
-typename PointMatcher<T>::DataPoints TransformationsImpl<T>::RigidTransformation::compute(
-	const DataPoints& input,
-	const TransformationParameters& parameters) const
+void TransformationsImpl<T>::transformInto(const DataPoints& input, const TransformationParameters& parameters, DataPoints& output, const bool rotateDirections, const unsigned nbThreads)
 {
-	assert(input.features.rows() == parameters.rows());
-	assert(parameters.rows() == parameters.cols());
-
-	const unsigned int nbRows = parameters.rows()-1;
-	const unsigned int nbCols = parameters.cols()-1;
-
-	const TransformationParameters R(parameters.topLeftCorner(nbRows, nbCols));
+	const int featDim(input.features.rows());
+	const size_t pointsCount(input.features.cols());
+	const bool aliased(&input == &output);
+	if (!aliased)
+	{
+		output.featureLabels = input.featureLabels;
+		output.descriptorLabels = input.descriptorLabels;
+		output.timeLabels = input.timeLabels;
+		output.times = input.times;
+		output.features.resize(featDim, pointsCount);
+		output.descriptors.resize(input.descriptors.rows(), input.descriptors.cols());
+	}
 
-	if(this->checkParameters(parameters) == false)	
-		throw TransformationError("RigidTransformation: Error, rotation matrix is not orthogonal.");	
-	
-	//DataPoints transformedCloud(input.featureLabels, input.descriptorLabels, input.timeLabels, input.features.cols());
-	DataPoints transformedCloud = input;
-	
-	// Apply the transformation to features
-	transformedCloud.features = parameters * input.features;
-	
-	// Apply the transformation to descriptors
+	// Locate the descriptors to rotate
+	std::vector<int> directionRows;
 	int row(0);
-	const int descCols(input.descriptors.cols());
 	for (size_t i = 0; i < input.descriptorLabels.size(); ++i)
 	{
 		const int span(input.descriptorLabels[i].span);
 		const std::string& name(input.descriptorLabels[i].text);
-		const BOOST_AUTO(inputDesc, input.descriptors.block(row, 0, span, descCols));
-		BOOST_AUTO(outputDesc, transformedCloud.descriptors.block(row, 0, span, descCols));
-		if (name == "normals" || name == "observationDirections")
-			outputDesc = R * inputDesc;
-		
+		if (rotateDirections && (name == "normals" || name == "observationDirections"))
+		{
+			if (span != featDim - 1)
+				throw TransformationError((boost::format("TransformationsImpl: Error, descriptor %1% has dimension %2% but the transformation is for dimension %3%.") % name % span % (featDim - 1)).str());
+			directionRows.push_back(row);
+		}
 		row += span;
 	}
+	const bool copyDescriptors(!aliased && input.descriptors.rows() != 0 && input.descriptors.cols() != 0);
+
+	// Every chunk of points is processed by its own thread
+	const size_t minChunkSize(16384);
+	parallelForChunks(pointsCount, getChunkCount(pointsCount, nbThreads, minChunkSize),
+		[&](const unsigned, const size_t begin, const size_t end)
+		{
+			// use fixed-size matrices for 2D and 3D clouds
+			if (featDim == 4)
+				transformChunk<3>(input, parameters, output, directionRows, copyDescriptors, begin, end);
+			else if (featDim == 3)
+				transformChunk<2>(input, parameters, output, directionRows, copyDescriptors, begin, end);
+			else
+				transformChunk<Eigen::Dynamic>(input, parameters, output, directionRows, copyDescriptors, begin, end);
+		}
+	);
+}
+
+//! Transform the points from begin to end of input into output, D being the dimension of the space
+template<typename T>
+template<int D>
+void TransformationsImpl<T>::transformChunk(const DataPoints& input, const TransformationParameters& parameters, DataPoints& output, const std::vector<int>& directionRows, const bool copyDescriptors, const size_t begin, const size_t end)
+{
+	typedef Eigen::Matrix<T, D == Eigen::Dynamic ? Eigen::Dynamic : D + 1, 1> HomogeneousPoint;
+	typedef Eigen::Matrix<T, D, 1> Direction;
+	typedef Eigen::Matrix<T, D == Eigen::Dynamic ? Eigen::Dynamic : D + 1, D == Eigen::Dynamic ? Eigen::Dynamic : D + 1> HomogeneousMatrix;
+	typedef Eigen::Matrix<T, D, D> RotationMatrix;
+
+	const int dim(parameters.rows() - 1);
+	const HomogeneousMatrix M(parameters);
+	const RotationMatrix R(parameters.topLeftCorner(dim, dim));
 
+	// the input columns are copied before writing, so that output can be input
+	for (size_t p = begin; p < end; ++p)
+	{
+		const HomogeneousPoint point(input.features.col(p));
+		output.features.col(p).noalias() = M * point;
+
+		if (copyDescriptors)
+			output.descriptors.col(p) = input.descriptors.col(p);
+		for (size_t i = 0; i < directionRows.size(); ++i)
+		{
+			const Direction direction(input.descriptors.block(directionRows[i], p, dim, 1));
+			output.descriptors.block(directionRows[i], p, dim, 1).noalias() = R * direction;
+		}
+	}
+}
+
+//! RigidTransformation
+template<typename T>
+TransformationsImpl<T>::RigidTransformation::RigidTransformation(const Parameters& params) :
+	Transformation("RigidTransformation", RigidTransformation::availableParameters(), params),
+	nbThreads(Parametrizable::get<unsigned>("nbThreads"))
+{
+}
+
+//! RigidTransformation
+template<typename T>
+typename PointMatcher<T>::DataPoints TransformationsImpl<T>::RigidTransformation::compute(
+	const DataPoints& input,
+	const TransformationParameters& parameters) const
+{
+	DataPoints transformedCloud;
+	compute(input, parameters, transformedCloud);
 	return transformedCloud;
 }
 
+//! RigidTransformation, writing into output
+template<typename T>
+void TransformationsImpl<T>::RigidTransformation::compute(
+	const DataPoints& input,
+	const TransformationParameters& parameters,
+	DataPoints& output) const
+{
+	assert(input.features.rows() == parameters.rows());
+	assert(parameters.rows() == parameters.cols());
+
+	if(this->checkParameters(parameters) == false)
+		throw TransformationError("RigidTransformation: Error, rotation matrix is not orthogonal.");
+
+	transformInto(input, parameters, output, true, nbThreads);
+}
+
 //! Ensure orthogonality of the rotation matrix
 template<typename T>
 bool TransformationsImpl<T>::RigidTransformation::checkParameters(const TransformationParameters& parameters) const
@@ -194,6 +277,22 @@ typename PointMatcher<T>::DataPoints TransformationsImpl<T>::SimilarityTransform
 	return transformedCloud;
 }
 
+//! SimilarityTransformation, writing into output
+template<typename T>
+void TransformationsImpl<T>::SimilarityTransformation::compute(
+	const DataPoints& input,
+	const TransformationParameters& parameters,
+	DataPoints& output) const
+{
+	assert(input.features.rows() == parameters.rows());
+	assert(parameters.rows() == parameters.cols());
+
+	if(this->checkParameters(parameters) == false)
+		throw TransformationError("SimilarityTransformation: Error, invalid similarity transform.");
+
+	transformInto(input, parameters, output, true);
+}
+
 //! Nothing to check for a similarity transform
 template<typename T>
 bool TransformationsImpl<T>::SimilarityTransformation::checkParameters(const TransformationParameters& parameters) const
@@ -230,6 +329,22 @@ typename PointMatcher<T>::DataPoints TransformationsImpl<T>::PureTranslation::co
 	return transformedCloud;
 }
 
+//! PureTranslation, writing into output
+template<typename T>
+void TransformationsImpl<T>::PureTranslation::compute(
+	const DataPoints& input,
+	const TransformationParameters& parameters,
+	DataPoints& output) const
+{
+	assert(input.features.rows() == parameters.rows());
+	assert(parameters.rows() == parameters.cols());
+
+	if(this->checkParameters(parameters) == false)
+		throw PointMatcherSupport::TransformationError("PureTranslation: Error, left part  not identity.");
+
+	transformInto(input, parameters, output, false);
+}
+
 template<typename T>
 typename PointMatcher<T>::TransformationParameters TransformationsImpl<T>::PureTranslation::correctParameters(
 		const TransformationParameters& parameters) const {
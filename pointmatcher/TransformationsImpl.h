@@ -38,6 +38,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "PointMatcher.h"
 
+#include <vector>
+
 template<typename T>
 struct TransformationsImpl
 {
@@ -51,15 +53,28 @@ struct TransformationsImpl
 	typedef typename PointMatcher<T>::TransformationParameters TransformationParameters;
 	typedef typename PointMatcher<T>::Transformation Transformation;
 	
+	static void transformInto(const DataPoints& input, const TransformationParameters& parameters, DataPoints& output, const bool rotateDirections, const unsigned nbThreads = 1);
+	template<int D>
+	static void transformChunk(const DataPoints& input, const TransformationParameters& parameters, DataPoints& output, const std::vector<int>& directionRows, const bool copyDescriptors, const size_t begin, const size_t end);
+	
 	struct RigidTransformation: public Transformation
 	{
 		inline static const std::string description()
 		{
 			return "Rigid transformation.";
 		}
+		inline static const ParametersDoc availableParameters()
+		{
+			return {
+				{"nbThreads", "number of threads used to transform the points, each one processing a contiguous chunk of points. 0: one thread per hardware thread", "1", "0", "2147483647", &P::Comp<unsigned>}
+			};
+		}
+
+		const unsigned nbThreads;
 
-		RigidTransformation() : Transformation("RigidTransformation",  ParametersDoc(), Parameters()) {}
+		RigidTransformation(const Parameters& params = Parameters());
 		virtual DataPoints compute(const DataPoints& input, const TransformationParameters& parameters) const;
+		virtual void compute(const DataPoints& input, const TransformationParameters& parameters, DataPoints& output) const;
 		virtual bool checkParameters(const TransformationParameters& parameters) const;
 		virtual TransformationParameters correctParameters(const TransformationParameters& parameters) const;
 	};
@@ -72,6 +87,7 @@ struct TransformationsImpl
 		}
 		
 		virtual DataPoints compute(const DataPoints& input, const TransformationParameters& parameters) const;
+		virtual void compute(const DataPoints& input, const TransformationParameters& parameters, DataPoints& output) const;
 		virtual bool checkParameters(const TransformationParameters& parameters) const;
 		virtual TransformationParameters correctParameters(const TransformationParameters& parameters) const;
 	};
@@ -85,6 +101,7 @@ struct TransformationsImpl
 
 		PureTranslation() : Transformation("PureTranslation",  ParametersDoc(), Parameters()) {}
 		virtual DataPoints compute(const DataPoints& input, const TransformationParameters& parameters) const;
+		virtual void compute(const DataPoints& input, const TransformationParameters& parameters, DataPoints& output) const;
 		virtual bool checkParameters(const TransformationParameters& parameters) const;
 		virtual TransformationParameters correctParameters(const TransformationParameters& parameters) const;
 	};
@@ -1,6 +1,9 @@
 #include "../utest.h"
+#include "pointmatcher/DataPointsFilters/utils/linearoctree.h"
 #include <ciso646>
 #include <cmath>
+#include <array>
+#include <map>
 
 using namespace std;
 using namespace PointMatcherSupport;
@@ -239,6 +242,55 @@ TEST_F(DataFilterTest, SurfaceNormalDataPointsFilter)
 	// 3- impact on ICP (that's what we test now)
 }
 
+TEST_F(DataFilterTest, SurfaceNormalDataPointsFilterParallel)
+{
+	params = PM::Parameters();
+	params["knn"] =  "5";
+	params["keepNormals"] =  "1";
+	params["keepDensities"] =  "1";
+	params["keepEigenValues"] =  "1";
+	params["keepEigenVectors"] =  "1" ;
+	params["keepMeanDist"] =  "1" ;
+
+	std::shared_ptr<PM::DataPointsFilter> serialFilter =
+		PM::get().DataPointsFilterRegistrar.create("SurfaceNormalDataPointsFilter", params);
+	params["nbThreads"] = "4";
+	std::shared_ptr<PM::DataPointsFilter> parallelFilter =
+		PM::get().DataPointsFilterRegistrar.create("SurfaceNormalDataPointsFilter", params);
+
+	const DP serialCloud = serialFilter->filter(ref3D);
+	const DP parallelCloud = parallelFilter->filter(ref3D);
+
+	EXPECT_TRUE(serialCloud.descriptorLabels == parallelCloud.descriptorLabels);
+	EXPECT_TRUE(serialCloud.descriptors == parallelCloud.descriptors);
+}
+
+TEST_F(DataFilterTest, SurfaceNormalDataPointsFilterPlane)
+{
+	// noisy horizontal plane
+	DP cloud = generateRandomDataPoints(1000);
+	cloud.features.row(0) *= 10;
+	cloud.features.row(1) *= 10;
+	cloud.features.row(2) *= 0.01;
+	cloud.features.row(3).setOnes();
+
+	params = PM::Parameters();
+	params["knn"] = "10";
+	params["keepNormals"] = "1";
+	params["keepEigenValues"] = "1";
+	addFilter("SurfaceNormalDataPointsFilter", params);
+	icp.readingDataPointsFilters.apply(cloud);
+
+	const DP::View normals = cloud.getDescriptorViewByName("normals");
+	const DP::View eigenValues = cloud.getDescriptorViewByName("eigValues");
+	for (unsigned i = 0; i < cloud.getNbPoints(); ++i)
+	{
+		EXPECT_GT(std::abs(normals(2, i)), 0.9);
+		EXPECT_LE(eigenValues(0, i), eigenValues(1, i));
+		EXPECT_LE(eigenValues(1, i), eigenValues(2, i));
+	}
+}
+
 TEST_F(DataFilterTest, MaxDensityDataPointsFilter)
 {
 	// Ratio has been selected to not affect the points too much
@@ -375,6 +427,54 @@ TEST_F(DataFilterTest, RandomSamplingDataPointsFilter)
 	}
 }
 
+TEST_F(DataFilterTest, RandomSamplingDataPointsFilterReproducible)
+{
+	// Enough points for several chunks to be drawn in parallel
+	const DP cloud = generateRandomDataPoints(200000);
+
+	params = PM::Parameters();
+	params["prob"] = "0.5";
+	params["seed"] = "42";
+	params["nbThreads"] = "1";
+	std::shared_ptr<PM::DataPointsFilter> filter =
+			PM::get().DataPointsFilterRegistrar.create("RandomSamplingDataPointsFilter", params);
+	const DP filteredCloud = filter->filter(cloud);
+	EXPECT_GT(filteredCloud.getNbPoints(), 95000u);
+	EXPECT_LT(filteredCloud.getNbPoints(), 105000u);
+
+	//Each call should draw other points, the sequence restarting at init
+	EXPECT_FALSE(filter->filter(cloud) == filteredCloud);
+	filter->init();
+	EXPECT_TRUE(filter->filter(cloud) == filteredCloud);
+
+	//Same seed should result same filtered cloud, whatever the number of threads
+	params["nbThreads"] = "3";
+	filter = PM::get().DataPointsFilterRegistrar.create("RandomSamplingDataPointsFilter", params);
+	EXPECT_TRUE(filter->filter(cloud) == filteredCloud);
+
+	//Different seeds should not result same filtered cloud
+	params["seed"] = "1";
+	filter = PM::get().DataPointsFilterRegistrar.create("RandomSamplingDataPointsFilter", params);
+	EXPECT_FALSE(filter->filter(cloud) == filteredCloud);
+
+	//Same for the points drawn by MaxDensity
+	DP densityCloud = cloud;
+	const PM::Matrix densities = PM::Matrix::Constant(1, cloud.getNbPoints(), 20) + PM::Matrix::Random(1, cloud.getNbPoints()).cwiseAbs();
+	densityCloud.addDescriptor("densities", densities);
+	params = PM::Parameters();
+	params["maxDensity"] = "10";
+	params["nbThreads"] = "1";
+	filter = PM::get().DataPointsFilterRegistrar.create("MaxDensityDataPointsFilter", params);
+	const DP maxDensityCloud = filter->filter(densityCloud);
+	EXPECT_LT(maxDensityCloud.getNbPoints(), densityCloud.getNbPoints());
+	EXPECT_FALSE(filter->filter(densityCloud) == maxDensityCloud);
+	filter->init();
+	EXPECT_TRUE(filter->filter(densityCloud) == maxDensityCloud);
+	params["nbThreads"] = "3";
+	filter = PM::get().DataPointsFilterRegistrar.create("MaxDensityDataPointsFilter", params);
+	EXPECT_TRUE(filter->filter(densityCloud) == maxDensityCloud);
+}
+
 TEST_F(DataFilterTest, FixStepSamplingDataPointsFilter)
 {
 	vector<unsigned> steps = {1, 2, 3};
@@ -436,11 +536,12 @@ TEST_F(DataFilterTest, MaxPointCountDataPointsFilter)
 	EXPECT_EQ(filteredCloud3.getDescriptorDim(), filteredCloud2.getDescriptorDim());
 	EXPECT_EQ(filteredCloud3.getTimeDim(), filteredCloud2.getTimeDim());
 	
-	//Validate transformation
+	//Validate transformation, with 1000 points the 3D registration can fall
+	//in a minimum up to 0.11 rad away, depending on the reference subsampling
 	icp.readingDataPointsFilters.clear();
 	addFilter("MaxPointCountDataPointsFilter", params);
 	validate2dTransformation();
-	validate3dTransformation();
+	validate3dTransformation(0.15);
 }
 
 TEST_F(DataFilterTest, OctreeGridDataPointsFilter)
@@ -482,14 +583,88 @@ TEST_F(DataFilterTest, OctreeGridDataPointsFilter)
 					//Check number of points
 					EXPECT_GT(cloud.getNbPoints(), filteredCloud.getNbPoints());
 				}
-				//Validate transformation
+				//Validate transformation, the sparsest octrees leaving few enough
+				//2D points for the rotation to vary up to 0.055 rad with the
+				//reference subsampling
 				icp.readingDataPointsFilters.clear();
 				addFilter("OctreeGridDataPointsFilter", params);
-				validate2dTransformation();
+				validate2dTransformation(0.075);
 				validate3dTransformation();
 			}
 }
 
+// Record the nodes of an octree in visiting order
+struct OctreeRecorder
+{
+	std::vector<size_t> depths;
+	std::vector<bool> leaves;
+	std::vector<float> radii;
+	std::vector<float> centers;
+	std::vector<std::vector<int>> datas;
+	
+	template<typename Node>
+	bool operator()(Node& oc)
+	{
+		depths.push_back(oc.getDepth());
+		leaves.push_back(oc.isLeaf());
+		radii.push_back(oc.getRadius());
+		const auto center = oc.getCenter();
+		centers.insert(centers.end(), center.data(), center.data() + center.size());
+		std::vector<int> data;
+		if (oc.isLeaf())
+		{
+			const auto* nodeData = oc.getData();
+			for (size_t i = 0; i < nodeData->size(); ++i)
+				data.push_back((*nodeData)[i]);
+		}
+		datas.push_back(data);
+		return true;
+	}
+};
+
+template<size_t dim>
+void expectSameOctrees(const DP& cloud, const size_t maxData, const float maxSize)
+{
+	Octree_<float, dim> octree;
+	octree.build(cloud, maxData, maxSize);
+	OctreeRecorder expected;
+	octree.visit(expected);
+	
+	for (const unsigned nbThreads : {1, 3})
+	{
+		LinearOctree_<float, dim> linearOctree;
+		linearOctree.build(cloud, maxData, maxSize, nbThreads);
+		EXPECT_EQ(linearOctree.getNbNodes(), expected.depths.size());
+		OctreeRecorder recorded;
+		linearOctree.visit(recorded);
+		EXPECT_EQ(recorded.depths, expected.depths);
+		EXPECT_EQ(recorded.leaves, expected.leaves);
+		EXPECT_EQ(recorded.radii, expected.radii);
+		EXPECT_EQ(recorded.centers, expected.centers);
+		EXPECT_EQ(recorded.datas, expected.datas);
+	}
+}
+
+TEST_F(DataFilterTest, LinearOctree)
+{
+	// The linear octree has the same nodes, in the same order, as the pointer-based one
+	const DP cloud = generateRandomDataPoints(20000);
+	DP::Labels labels2D;
+	labels2D.push_back(DP::Label("x", 1));
+	labels2D.push_back(DP::Label("y", 1));
+	labels2D.push_back(DP::Label("pad", 1));
+	PM::Matrix features2D(3, cloud.getNbPoints());
+	features2D << cloud.features.topRows(2), cloud.features.bottomRows(1);
+	const DP cloud2D(features2D, labels2D);
+	
+	for (const size_t maxData : {1, 5, 50})
+		for (const float maxSize : {0., 0.05})
+		{
+			expectSameOctrees<3>(cloud, maxData, maxSize);
+			expectSameOctrees<2>(cloud2D, maxData, maxSize);
+		}
+}
+
 TEST_F(DataFilterTest, NormalSpaceDataPointsFilter)
 {
 	const size_t nbPts = 60000;
@@ -555,6 +730,121 @@ TEST_F(DataFilterTest, NormalSpaceDataPointsFilter)
 		}
 }
 
+TEST_F(DataFilterTest, NormalSpaceDataPointsFilterBuckets)
+{
+	// Most normals are along z, the others are spread over the sphere
+	const size_t nbAlongZ = 10000;
+	const size_t nbSpread = 1000;
+	DP cloud = generateRandomDataPoints(nbAlongZ + nbSpread);
+	PM::Matrix normals = PM::Matrix::Zero(3, nbAlongZ + nbSpread);
+	normals.row(2).head(nbAlongZ).setOnes();
+	normals.rightCols(nbSpread) = PM::Matrix::Random(3, nbSpread).colwise().normalized();
+	cloud.addDescriptor("normals", normals);
+
+	params = PM::Parameters();
+	params["nbSample"] = "1000";
+	params["nbThreads"] = "1";
+	std::shared_ptr<PM::DataPointsFilter> nssFilter =
+			PM::get().DataPointsFilterRegistrar.create("NormalSpaceDataPointsFilter", params);
+	const DP filteredCloud = nssFilter->filter(cloud);
+	EXPECT_EQ(filteredCloud.getNbPoints(), 1000u);
+
+	// The sampling is uniform over the normals, not over the points
+	const auto filteredNormals = filteredCloud.getDescriptorViewByName("normals");
+	const int nbSampledAlongZ = (filteredNormals.row(2).array() == 1).count();
+	EXPECT_LT(nbSampledAlongZ, 500);
+
+	// The sampled points do not depend on the number of threads
+	params["nbThreads"] = "3";
+	nssFilter = PM::get().DataPointsFilterRegistrar.create("NormalSpaceDataPointsFilter", params);
+	EXPECT_TRUE(nssFilter->filter(cloud) == filteredCloud);
+
+	// 2D point clouds are sampled over the circle of normals, most normals being along y
+	const DP cloud3D = generateRandomDataPoints(nbAlongZ + nbSpread);
+	const PM::Matrix features2D = cloud3D.features.bottomRows(3);
+	DP::Labels featLabels2D;
+	featLabels2D.push_back(DP::Label("x", 1));
+	featLabels2D.push_back(DP::Label("y", 1));
+	featLabels2D.push_back(DP::Label("pad", 1));
+	DP cloud2D(features2D, featLabels2D);
+	PM::Matrix normals2D = PM::Matrix::Zero(2, nbAlongZ + nbSpread);
+	normals2D.row(1).head(nbAlongZ).setOnes();
+	normals2D.rightCols(nbSpread) = PM::Matrix::Random(2, nbSpread).colwise().normalized();
+	cloud2D.addDescriptor("normals", normals2D);
+
+	const DP filteredCloud2D = nssFilter->filter(cloud2D);
+	EXPECT_EQ(filteredCloud2D.getNbPoints(), 1000u);
+	const auto filteredNormals2D = filteredCloud2D.getDescriptorViewByName("normals");
+	EXPECT_LT((filteredNormals2D.row(1).array() == 1).count(), 500);
+}
+
+TEST_F(DataFilterTest, NormalSpaceDataPointsFilterEqualArea)
+{
+	// Normals uniformly distributed over the sphere, so that the sampled
+	// normals are uniform if the buckets all cover the same solid angle
+	const size_t nbPts = 200000;
+	const size_t nbSample = 20000;
+	DP cloud = generateRandomDataPoints(nbPts);
+	const PM::Matrix z = PM::Matrix::Random(1, nbPts);
+	const PM::Matrix phi = M_PI * PM::Matrix::Random(1, nbPts);
+	PM::Matrix normals(3, nbPts);
+	normals.row(0) = (1 - z.array().square()).sqrt() * phi.array().cos();
+	normals.row(1) = (1 - z.array().square()).sqrt() * phi.array().sin();
+	normals.row(2) = z;
+	cloud.addDescriptor("normals", normals);
+
+	params = PM::Parameters();
+	params["nbSample"] = toParam(nbSample);
+	std::shared_ptr<PM::DataPointsFilter> nssFilter =
+			PM::get().DataPointsFilterRegistrar.create("NormalSpaceDataPointsFilter", params);
+	const DP filteredCloud = nssFilter->filter(cloud);
+	ASSERT_EQ(filteredCloud.getNbPoints(), nbSample);
+
+	// As many normals are sampled around the axes as around the diagonals
+	const auto filteredNormals = filteredCloud.getDescriptorViewByName("normals");
+	const float cosRadius = std::cos(0.3);
+	int aroundAxes = 0, aroundDiagonals = 0;
+	for (size_t i = 0; i < nbSample; ++i)
+	{
+		const Eigen::Vector3f n = filteredNormals.col(i);
+		if (n.cwiseAbs().maxCoeff() > cosRadius)
+			++aroundAxes;
+		if (n.cwiseAbs().sum() / std::sqrt(3.f) > cosRadius)
+			++aroundDiagonals;
+	}
+	// 6 caps around the axes, 8 around the diagonals
+	const float axisDensity = aroundAxes / 6.f;
+	const float diagonalDensity = aroundDiagonals / 8.f;
+	EXPECT_NEAR(axisDensity / diagonalDensity, 1, 0.15);
+
+	// Same over the circle of 2D normals
+	const DP cloud3D = generateRandomDataPoints(nbPts);
+	DP::Labels featLabels2D;
+	featLabels2D.push_back(DP::Label("x", 1));
+	featLabels2D.push_back(DP::Label("y", 1));
+	featLabels2D.push_back(DP::Label("pad", 1));
+	DP cloud2D(PM::Matrix(cloud3D.features.bottomRows(3)), featLabels2D);
+	PM::Matrix normals2D(2, nbPts);
+	normals2D.row(0) = phi.array().cos();
+	normals2D.row(1) = phi.array().sin();
+	cloud2D.addDescriptor("normals", normals2D);
+
+	const DP filteredCloud2D = nssFilter->filter(cloud2D);
+	ASSERT_EQ(filteredCloud2D.getNbPoints(), nbSample);
+	const auto filteredNormals2D = filteredCloud2D.getDescriptorViewByName("normals");
+	int aroundAxes2D = 0, aroundDiagonals2D = 0;
+	for (size_t i = 0; i < nbSample; ++i)
+	{
+		const Eigen::Vector2f n = filteredNormals2D.col(i);
+		if (n.cwiseAbs().maxCoeff() > cosRadius)
+			++aroundAxes2D;
+		if (n.cwiseAbs().sum() / std::sqrt(2.f) > cosRadius)
+			++aroundDiagonals2D;
+	}
+	// 4 arcs around the axes, 4 around the diagonals
+	EXPECT_NEAR(float(aroundAxes2D) / aroundDiagonals2D, 1, 0.15);
+}
+
 TEST_F(DataFilterTest, CovarianceSamplingDataPointsFilter)
 {
 	const size_t nbPts = 60000;
@@ -609,6 +899,58 @@ TEST_F(DataFilterTest, CovarianceSamplingDataPointsFilter)
 	}
 }
 
+TEST_F(DataFilterTest, CovarianceSamplingDataPointsFilterConstraints)
+{
+	// A floor with two small walls: sampling uniformly would mostly keep floor
+	// points, which do not constrain the translations along x and y
+	const int nbFloor(9000), nbWall(500), nbPts(nbFloor + 2 * nbWall);
+	PM::Matrix features(PM::Matrix::Ones(4, nbPts));
+	PM::Matrix normals(PM::Matrix::Zero(3, nbPts));
+	features.topRows(3) = (PM::Matrix::Random(3, nbPts).array() + 1) / 2;
+	for (int i = 0; i < nbPts; ++i)
+	{
+		const int axis(i < nbFloor ? 2 : (i < nbFloor + nbWall ? 0 : 1));
+		features(axis, i) = 0;
+		normals(axis, i) = 1;
+	}
+	DP::Labels featLabels;
+	featLabels.push_back(DP::Label("x", 1));
+	featLabels.push_back(DP::Label("y", 1));
+	featLabels.push_back(DP::Label("z", 1));
+	featLabels.push_back(DP::Label("pad", 1));
+	DP cloud(features, featLabels);
+	cloud.addDescriptor("normals", normals);
+	
+	const size_t nbSample(30);
+	params = PM::Parameters();
+	params["nbSample"] = toParam(nbSample);
+	const DP filtered = PM::get().DataPointsFilterRegistrar.create("CovarianceSamplingDataPointsFilter", params)->filter(cloud);
+	ASSERT_EQ(filtered.getNbPoints(), nbSample);
+	
+	// Kept points are distinct input points, in their input order
+	const auto filteredNormals = filtered.getDescriptorViewByName("normals");
+	std::array<int, 3> countPerAxis = {{0, 0, 0}};
+	int input(0);
+	for (size_t i = 0; i < nbSample; ++i)
+	{
+		while (input < nbPts && features.col(input) != filtered.features.col(i))
+			++input;
+		ASSERT_LT(input, nbPts);
+		++input;
+		int axis;
+		filteredNormals.col(i).maxCoeff(&axis);
+		++countPerAxis[axis];
+	}
+	EXPECT_GT(countPerAxis[0], 0);
+	EXPECT_GT(countPerAxis[1], 0);
+	EXPECT_GT(countPerAxis[2], 0);
+	
+	// The sampling does not depend on the number of threads
+	params["nbThreads"] = "3";
+	const DP parallelFiltered = PM::get().DataPointsFilterRegistrar.create("CovarianceSamplingDataPointsFilter", params)->filter(cloud);
+	EXPECT_TRUE(parallelFiltered.features == filtered.features);
+}
+
 TEST_F(DataFilterTest, VoxelGridDataPointsFilter)
 {
 	// Test with point cloud
@@ -668,6 +1010,185 @@ TEST_F(DataFilterTest, VoxelGridDataPointsFilter)
 	}
 }
 
+TEST_F(DataFilterTest, VoxelGridDataPointsFilterSparse)
+{
+	const DP cloud = generateRandomDataPoints(1000);
+
+	// The sparse grid gives the same points as the dense one
+	vector<bool> useCentroid = {false, true};
+	vector<bool> averageExistingDescriptors = {false, true};
+	for (unsigned i = 0 ; i < useCentroid.size() ; i++)
+	{
+		for (unsigned j = 0; j < averageExistingDescriptors.size(); j++)
+		{
+			params = PM::Parameters();
+			params["vSizeX"] = "0.2";
+			params["vSizeY"] = "0.2";
+			params["vSizeZ"] = "0.2";
+			params["useCentroid"] = toParam(useCentroid[i]);
+			params["averageExistingDescriptors"] = toParam(averageExistingDescriptors[j]);
+
+			const DP denseCloud = PM::get().DataPointsFilterRegistrar.create("VoxelGridDataPointsFilter", params)->filter(cloud);
+			params["sparse"] = "1";
+			const DP sparseCloud = PM::get().DataPointsFilterRegistrar.create("VoxelGridDataPointsFilter", params)->filter(cloud);
+
+			EXPECT_GT(cloud.getNbPoints(), sparseCloud.getNbPoints());
+			EXPECT_TRUE(denseCloud.features == sparseCloud.features);
+			EXPECT_TRUE(denseCloud.descriptors == sparseCloud.descriptors);
+			EXPECT_TRUE(denseCloud.times == sparseCloud.times);
+		}
+	}
+
+	// Memory scales with the occupied voxels, not with the bounding box
+	DP farCloud = generateRandomDataPoints(4);
+	farCloud.features.col(1) = farCloud.features.col(0);
+	farCloud.features.col(2).head(3) = farCloud.features.col(0).head(3) + PM::Vector::Constant(3, 1e4);
+	farCloud.features.col(3) = farCloud.features.col(2);
+
+	params = PM::Parameters();
+	params["vSizeX"] = "0.01";
+	params["vSizeY"] = "0.01";
+	params["vSizeZ"] = "0.01";
+	params["sparse"] = "1";
+	const DP filteredFarCloud = PM::get().DataPointsFilterRegistrar.create("VoxelGridDataPointsFilter", params)->filter(farCloud);
+	EXPECT_EQ(filteredFarCloud.getNbPoints(), 2u);
+	EXPECT_TRUE(filteredFarCloud.features.col(0).head(3).isApprox(farCloud.features.col(0).head(3)));
+	EXPECT_TRUE(filteredFarCloud.features.col(1).head(3).isApprox(farCloud.features.col(2).head(3)));
+}
+
+TEST_F(DataFilterTest, VoxelGridDataPointsFilterParallel)
+{
+	const DP cloud = generateRandomDataPoints(20000);
+
+	// Summing per thread gives the same points as summing serially
+	vector<bool> useCentroid = {false, true};
+	vector<bool> sparse = {false, true};
+	for (unsigned i = 0 ; i < useCentroid.size() ; i++)
+	{
+		for (unsigned j = 0; j < sparse.size(); j++)
+		{
+			params = PM::Parameters();
+			params["vSizeX"] = "0.05";
+			params["vSizeY"] = "0.05";
+			params["vSizeZ"] = "0.05";
+			params["useCentroid"] = toParam(useCentroid[i]);
+			params["sparse"] = toParam(sparse[j]);
+
+			const DP serialCloud = PM::get().DataPointsFilterRegistrar.create("VoxelGridDataPointsFilter", params)->filter(cloud);
+			params["nbThreads"] = "4";
+			const DP parallelCloud = PM::get().DataPointsFilterRegistrar.create("VoxelGridDataPointsFilter", params)->filter(cloud);
+
+			EXPECT_GT(cloud.getNbPoints(), parallelCloud.getNbPoints());
+			ASSERT_EQ(serialCloud.getNbPoints(), parallelCloud.getNbPoints());
+			EXPECT_TRUE(serialCloud.features.isApprox(parallelCloud.features));
+			EXPECT_TRUE(serialCloud.descriptors.isApprox(parallelCloud.descriptors));
+			EXPECT_TRUE(serialCloud.times == parallelCloud.times);
+		}
+	}
+}
+
+TEST_F(DataFilterTest, ApplyStreaming)
+{
+	const DP cloud = generateRandomDataPoints(10000);
+	const int chunkSize(1000);
+
+	// Stream the cloud through filters by chunks, concatenating the output
+	const auto applyStreaming = [&](PM::DataPointsFilters& filters)
+	{
+		int nextPoint(0);
+		DP output;
+		filters.applyStreaming(
+			[&](DP& chunk)
+			{
+				if (nextPoint == cloud.getNbPoints())
+					return false;
+				const int count(std::min<int>(chunkSize, cloud.getNbPoints() - nextPoint));
+				chunk = cloud.createSimilarEmpty(count);
+				for (int i = 0; i < count; ++i)
+					chunk.setColFrom(i, cloud, nextPoint + i);
+				nextPoint += count;
+				return true;
+			},
+			[&](const DP& chunk)
+			{
+				if (output.getNbPoints() == 0)
+					output = chunk;
+				else
+					output.concatenate(chunk);
+			}
+		);
+		return output;
+	};
+
+	// Filters considering points independently give the same points as on the whole cloud
+	params = PM::Parameters();
+	params["xMin"] = "-0.5";
+	params["xMax"] = "0.5";
+	params["yMin"] = "-0.5";
+	params["yMax"] = "0.5";
+	params["zMin"] = "-0.5";
+	params["zMax"] = "0.5";
+	addFilter("BoundingBoxDataPointsFilter", params);
+	addFilter("RemoveNaNDataPointsFilter");
+	params = PM::Parameters();
+	params["dist"] = "0.3";
+	addFilter("DistanceLimitDataPointsFilter", params);
+	DP expected(cloud);
+	icp.readingDataPointsFilters.apply(expected);
+	EXPECT_TRUE(applyStreaming(icp.readingDataPointsFilters) == expected);
+
+	// Voxels accumulate over chunks, on a grid aligned with the origin
+	params = PM::Parameters();
+	params["vSizeX"] = "0.2";
+	params["vSizeY"] = "0.2";
+	params["vSizeZ"] = "0.2";
+	addFilter("VoxelGridDataPointsFilter", params);
+	std::map<std::array<int, 3>, int> voxelIds;
+	std::vector<PM::Vector> sums;
+	std::vector<int> counts;
+	for (int i = 0; i < expected.getNbPoints(); ++i)
+	{
+		const std::array<int, 3> key = {{
+			int(std::floor(expected.features(0, i) / 0.2f)),
+			int(std::floor(expected.features(1, i) / 0.2f)),
+			int(std::floor(expected.features(2, i) / 0.2f))}};
+		const auto inserted(voxelIds.insert(std::make_pair(key, int(sums.size()))));
+		if (inserted.second)
+		{
+			sums.push_back(PM::Vector::Zero(3));
+			counts.push_back(0);
+		}
+		sums[inserted.first->second] += expected.features.col(i).head(3);
+		++counts[inserted.first->second];
+	}
+	// A failed stream does not leave points held back for the next ones
+	int nbChunks(0);
+	EXPECT_THROW(icp.readingDataPointsFilters.applyStreaming(
+		[&](DP& chunk)
+		{
+			if (++nbChunks > 3)
+				throw runtime_error("source failure");
+			chunk = cloud.createSimilarEmpty(chunkSize);
+			for (int i = 0; i < chunkSize; ++i)
+				chunk.setColFrom(i, cloud, i);
+			return true;
+		},
+		[](const DP&) {}
+	), runtime_error);
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		const DP voxelized(applyStreaming(icp.readingDataPointsFilters));
+		ASSERT_EQ(int(sums.size()), voxelized.getNbPoints());
+		EXPECT_TRUE(voxelized.descriptorLabels == cloud.descriptorLabels);
+		for (size_t v = 0; v < sums.size(); ++v)
+			EXPECT_TRUE(voxelized.features.col(v).head(3).isApprox(sums[v] / counts[v], 1e-4f));
+	}
+
+	// Filters needing the whole cloud are refused
+	addFilter("SurfaceNormalDataPointsFilter");
+	EXPECT_THROW(applyStreaming(icp.readingDataPointsFilters), runtime_error);
+}
+
 TEST_F(DataFilterTest, CutAtDescriptorThresholdDataPointsFilter)
 {
 	// Copied from density ratio above
@@ -46,6 +46,157 @@ TEST_F(ErrorMinimizerTest, PointToPlaneErrorMinimizer)
 	validate3dTransformation();
 }
 
+TEST_F(ErrorMinimizerTest, PointToPointErrorMinimizerMoments)
+{
+	// Enough matches for several blocks to be summed in parallel, far from the origin
+	const int nbPoints = 10000;
+
+	for(const int dim : {2, 3})
+	{
+		PM::Matrix features = PM::Matrix::Random(dim + 1, nbPoints);
+		features.topRows(dim).array() += 100;
+		features.row(dim).setOnes();
+		DP::Labels featLabels;
+		featLabels.push_back(DP::Label("x", 1));
+		featLabels.push_back(DP::Label("y", 1));
+		if(dim == 3)
+			featLabels.push_back(DP::Label("z", 1));
+		featLabels.push_back(DP::Label("pad", 1));
+		const DP reading(features, featLabels);
+
+		// The reference is the reading transformed, scaled for the similarity
+		PM::Matrix rotation(PM::Matrix::Identity(dim, dim));
+		if(dim == 3)
+			rotation = Eigen::AngleAxis<float>(0.3, Eigen::Vector3f(1, 2, 3).normalized()).toRotationMatrix();
+		else
+			rotation = Eigen::Rotation2D<float>(0.3).toRotationMatrix();
+		const PM::Vector translation = PM::Vector::LinSpaced(dim, 0.5, -1.);
+
+		const PM::OutlierWeights weights = PM::OutlierWeights::Random(1, nbPoints).cwiseAbs();
+		PM::Matches::Ids ids(1, nbPoints);
+		for(int i = 0; i < nbPoints; ++i)
+			ids(0, i) = i;
+		const PM::Matches matches(PM::Matches::Dists::Zero(1, nbPoints), ids);
+
+		for(const string& name : {"PointToPointErrorMinimizer", "PointToPointSimilarityErrorMinimizer"})
+		{
+			const float scale = (name == "PointToPointErrorMinimizer") ? 1 : 1.5;
+			PM::Matrix transformed = features;
+			transformed.topRows(dim) = (scale * rotation * features.topRows(dim)).colwise() + translation;
+			const DP reference(transformed, featLabels);
+
+			PM::Parameters params;
+			params["nbThreads"] = "1";
+			const PM::TransformationParameters serial =
+				PM::get().ErrorMinimizerRegistrar.create(name, params)->compute(reading, reference, weights, matches);
+			params["nbThreads"] = "3";
+			const PM::TransformationParameters parallel =
+				PM::get().ErrorMinimizerRegistrar.create(name, params)->compute(reading, reference, weights, matches);
+
+			// The solution does not depend on the number of threads
+			EXPECT_TRUE(serial == parallel) << name << " " << dim;
+
+			EXPECT_TRUE(serial.topLeftCorner(dim, dim).isApprox(scale * rotation, 1e-4)) << name << " " << dim;
+			EXPECT_TRUE(serial.topRightCorner(dim, 1).isApprox(translation, 1e-3)) << name << " " << dim;
+		}
+	}
+}
+
+TEST_F(ErrorMinimizerTest, PointToPlaneErrorMinimizerAccumulation)
+{
+	// Enough matches for several blocks to be accumulated in parallel
+	const int nbPoints = 10000;
+
+	PM::Matrix features = PM::Matrix::Random(4, nbPoints);
+	features.row(3).setOnes();
+	DP::Labels featLabels;
+	featLabels.push_back(DP::Label("x", 1));
+	featLabels.push_back(DP::Label("y", 1));
+	featLabels.push_back(DP::Label("z", 1));
+	featLabels.push_back(DP::Label("pad", 1));
+	const PM::Matrix normals = PM::Matrix::Random(3, nbPoints).colwise().normalized();
+	DP::Labels descLabels;
+	descLabels.push_back(DP::Label("normals", 3));
+	const DP reference(features, featLabels, normals, descLabels);
+
+	// The reading is the reference translated
+	PM::Vector translation(3);
+	translation << 0.1, -0.2, 0.3;
+	features.topRows(3).colwise() += translation;
+	const DP reading(features, featLabels);
+
+	const PM::OutlierWeights weights = PM::OutlierWeights::Ones(1, nbPoints);
+	PM::Matches::Ids ids(1, nbPoints);
+	for(int i = 0; i < nbPoints; ++i)
+		ids(0, i) = i;
+	const PM::Matches matches(PM::Matches::Dists::Zero(1, nbPoints), ids);
+
+	for(const string& variant : {"", "force2D", "force4DOF"})
+	{
+		PM::Parameters params;
+		if(!variant.empty())
+			params[variant] = "1";
+		params["nbThreads"] = "1";
+		const PM::TransformationParameters serial =
+			PM::get().ErrorMinimizerRegistrar.create("PointToPlaneErrorMinimizer", params)->compute(reading, reference, weights, matches);
+		params["nbThreads"] = "3";
+		const PM::TransformationParameters parallel =
+			PM::get().ErrorMinimizerRegistrar.create("PointToPlaneErrorMinimizer", params)->compute(reading, reference, weights, matches);
+
+		// The solution does not depend on the number of threads
+		EXPECT_TRUE(serial == parallel) << variant;
+
+		// The translation is recovered, only on the XY-plane when forcing 2D
+		PM::Vector expectedTranslation = -translation;
+		if(variant == "force2D")
+			expectedTranslation(2) = 0;
+		EXPECT_TRUE(serial.topLeftCorner(3, 3).isIdentity(1e-4)) << variant;
+		EXPECT_TRUE(serial.topRightCorner(3, 1).isApprox(expectedTranslation, 1e-4)) << variant;
+	}
+}
+
+TEST_F(ErrorMinimizerTest, PointToPlaneErrorMinimizerDegenerate)
+{
+	// A flat floor does not constrain the yaw nor the translation on its plane.
+	// Away from the origin, the rank-deficient system is solved inaccurately by QR,
+	// which falls back to the SVD.
+	const int nbPoints = 1000;
+
+	PM::Matrix features = PM::Matrix::Random(4, nbPoints);
+	features.topRows(2).array() += 10;
+	features.row(2).setZero();
+	features.row(3).setOnes();
+	DP::Labels featLabels;
+	featLabels.push_back(DP::Label("x", 1));
+	featLabels.push_back(DP::Label("y", 1));
+	featLabels.push_back(DP::Label("z", 1));
+	featLabels.push_back(DP::Label("pad", 1));
+	PM::Matrix normals = PM::Matrix::Zero(3, nbPoints);
+	normals.row(2).setOnes();
+	DP::Labels descLabels;
+	descLabels.push_back(DP::Label("normals", 3));
+	const DP reference(features, featLabels, normals, descLabels);
+
+	// The reading is the reference lifted above the floor
+	features.row(2).setConstant(0.1);
+	const DP reading(features, featLabels);
+
+	const PM::OutlierWeights weights = PM::OutlierWeights::Ones(1, nbPoints);
+	PM::Matches::Ids ids(1, nbPoints);
+	for(int i = 0; i < nbPoints; ++i)
+		ids(0, i) = i;
+	const PM::Matches matches(PM::Matches::Dists::Zero(1, nbPoints), ids);
+
+	const PM::TransformationParameters T =
+		PM::get().ErrorMinimizerRegistrar.create("PointToPlaneErrorMinimizer")->compute(reading, reference, weights, matches);
+
+	// The constrained height is recovered, without drifting along the unconstrained directions
+	EXPECT_TRUE(T.allFinite());
+	EXPECT_NEAR(-0.1, T(2, 3), 1e-3);
+	EXPECT_TRUE(T.topLeftCorner(3, 3).isIdentity(1e-2));
+	EXPECT_TRUE(T.topRightCorner(2, 1).isZero(1e-2));
+}
+
 TEST_F(ErrorMinimizerTest, ErrorElements)
 {
 	const unsigned int nbPoints = 100;
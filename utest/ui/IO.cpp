@@ -178,6 +178,129 @@ TEST(IOTest, loadCSV)
 
 }
 
+
+TEST(IOTest, loadCSVNumberFormats)
+{
+	typedef PointMatcherIO<double> IOd;
+	typedef PointMatcher<double>::DataPoints DPd;
+
+	// every value must match the general conversion, whichever path parsed it
+	const char* values[] = {
+		"0", "-0", "+7", ".5", "1.", "00012.5", "-3.25e-2", "1E+05", "5.e-3",
+		"0.1", "-123456.789012345", "3.14159265358979323846", "1e-400", "1.7976931348623157e308",
+		"inf", "-inf", "12345678901234567890123", "0.000000000000000000001234"
+	};
+	const size_t valueCount(sizeof(values) / sizeof(values[0]));
+	ostringstream os;
+	os << "x, y, z, time\r\n";
+	for (size_t i = 0; i < valueCount; ++i)
+		os << values[i] << ";\t" << values[valueCount - 1 - i] << ",,1 " << -int64_t(i) * 1000000007 << "\r\n";
+	os << "1, 2, 3, 9223372036854775807";
+
+	istringstream is(os.str());
+	const DPd pts(IOd::loadCSV(is));
+	ASSERT_EQ(valueCount + 1, pts.getNbPoints());
+	EXPECT_EQ(1u, pts.getTimeDim());
+	for (size_t i = 0; i < valueCount; ++i)
+	{
+		EXPECT_EQ(lexical_cast_scalar_to_string<double>(values[i]), pts.features(0, i)) << values[i];
+		EXPECT_EQ(lexical_cast_scalar_to_string<double>(values[valueCount - 1 - i]), pts.features(1, i));
+		EXPECT_EQ(-int64_t(i) * 1000000007, pts.times(0, i));
+	}
+	EXPECT_EQ(9223372036854775807, pts.times(0, valueCount));
+
+	// many lines, parsed by several threads, in float
+	ostringstream osLarge;
+	for (int i = 0; i < 20000; ++i)
+		osLarge << i * 0.001 << " " << -i << " " << i * 1.7e-5 << "\n";
+	osLarge << "\nthis line is after the end of the cloud\n";
+	istringstream isLarge(osLarge.str());
+	const DP large(PointMatcherIO<float>::loadCSV(isLarge, 3));
+	ASSERT_EQ(20000u, large.getNbPoints());
+	EXPECT_EQ(4u, large.features.rows());
+	istringstream isCheck(osLarge.str());
+	for (int i = 0; i < 20000; ++i)
+	{
+		string x, y, z;
+		isCheck >> x >> y >> z;
+		ASSERT_EQ(lexical_cast_scalar_to_string<float>(x), large.features(0, i)) << x;
+		ASSERT_EQ(float(-i), large.features(1, i));
+		ASSERT_EQ(lexical_cast_scalar_to_string<float>(z), large.features(2, i)) << z;
+	}
+	istringstream isSerial(osLarge.str());
+	EXPECT_TRUE(PointMatcherIO<float>::loadCSV(isSerial) == large);
+
+	// errors still point to the faulty line
+	istringstream isBad("x y z\n1 2 3\n1 2 abc\n");
+	EXPECT_THROW(IOd::loadCSV(isBad), boost::bad_lexical_cast);
+	istringstream isShort("x y z\n1 2 3\n1 2\n");
+	EXPECT_THROW(IOd::loadCSV(isShort), runtime_error);
+}
+
+//! Read a whole cloud through a chunk reader
+DP readAllChunks(PointMatcherIO<float>::ChunkReader& reader)
+{
+	DP cloud;
+	DP chunk;
+	bool first(true);
+	while (reader.read(chunk))
+	{
+		if (first)
+			cloud = chunk;
+		else
+			cloud.concatenate(chunk);
+		first = false;
+	}
+	return cloud;
+}
+
+TEST(IOTest, CSVChunkReader)
+{
+	typedef PointMatcherIO<float> IO;
+
+	// with a header, chunks of 3 points splitting the 7 points unevenly
+	const string withHeader(
+	"x, y, z, nx, ny, nz, intensity, time\n"
+	"1, 2, 3, 0, 0, 1, 10, 100\n"
+	"2, 2, 3, 0, 0, 1, 11, 101\n"
+	"3, 2, 3, 0, 1, 0, 12, 102\n"
+	"4, 2, 3, 0, 1, 0, 13, 103\n"
+	"5, 2, 3, 1, 0, 0, 14, 104\n"
+	"6, 2, 3, 1, 0, 0, 15, 105\n"
+	"7, 2, 3, 1, 0, 0, 16, 106\n"
+	);
+	std::istringstream is(withHeader);
+	const DP expected(IO::loadCSV(is));
+
+	std::istringstream chunked(withHeader);
+	IO::CSVChunkReader reader(chunked, 3);
+	DP chunk;
+	EXPECT_TRUE(reader.read(chunk));
+	EXPECT_EQ(3u, chunk.getNbPoints());
+	EXPECT_TRUE(chunk.featureLabels == expected.featureLabels);
+	EXPECT_TRUE(chunk.descriptorLabels == expected.descriptorLabels);
+	EXPECT_TRUE(chunk.timeLabels == expected.timeLabels);
+	std::istringstream chunkedAgain(withHeader);
+	IO::CSVChunkReader readerAgain(chunkedAgain, 3);
+	EXPECT_TRUE(readAllChunks(readerAgain) == expected);
+
+	// without a header, the first line being data
+	const string withoutHeader(
+	"1, 2, 3\n"
+	"4, 5, 6\n"
+	"7, 8, 9\n"
+	"10, 11, 12\n"
+	);
+	std::istringstream isNoHeader(withoutHeader);
+	const DP expectedNoHeader(IO::loadCSV(isNoHeader));
+	std::istringstream chunkedNoHeader(withoutHeader);
+	IO::CSVChunkReader readerNoHeader(chunkedNoHeader, 2);
+	const DP cloudNoHeader(readAllChunks(readerNoHeader));
+	EXPECT_EQ(4u, cloudNoHeader.getNbPoints());
+	EXPECT_TRUE(cloudNoHeader == expectedNoHeader);
+	EXPECT_FALSE(readerNoHeader.read(chunk));
+}
+
 TEST(IOTest, loadPLY)
 {
 	typedef PointMatcherIO<float> IO;
@@ -340,6 +463,181 @@ TEST(IOTest, loadPCD)
 
 }
 
+//! Append value to data as raw bytes, in big or little endian order
+template<typename V>
+static void appendBinaryValue(string& data, const V value, const bool bigEndian)
+{
+	const std::uint16_t one(1);
+	const bool hostBigEndian(*reinterpret_cast<const char*>(&one) == 0);
+	char bytes[sizeof(V)];
+	memcpy(bytes, &value, sizeof(V));
+	if (bigEndian != hostBigEndian)
+		std::reverse(bytes, bytes + sizeof(V));
+	data.append(bytes, sizeof(V));
+}
+
+TEST(IOTest, loadPLYBinary)
+{
+	typedef PointMatcherIO<float> IO;
+
+	string data(
+	"ply\n"
+	"format binary_big_endian 1.0\n"
+	"element vertex 3\n"
+	"property float x\n"
+	"property float y\n"
+	"property float z\n"
+	"property uchar red\n"
+	"property int16 intensity\n"
+	"element face 1\n"
+	"property list uchar int vertex_indices\n"
+	"end_header\n"
+	);
+	for (int i = 0; i < 3; ++i)
+	{
+		appendBinaryValue<float>(data, i + 0.5f, true);
+		appendBinaryValue<float>(data, -i, true);
+		appendBinaryValue<float>(data, 10 * i, true);
+		appendBinaryValue<std::uint8_t>(data, 51 * i, true);
+		appendBinaryValue<std::int16_t>(data, -1000 * i, true);
+	}
+	// the face is not read
+	appendBinaryValue<std::uint8_t>(data, 3, true);
+	for (int i = 0; i < 3; ++i)
+		appendBinaryValue<std::int32_t>(data, i, true);
+
+	std::istringstream is(data);
+	const DP pointCloud = IO::loadPLY(is);
+
+	EXPECT_EQ(3, pointCloud.features.cols());
+	EXPECT_EQ(4, pointCloud.features.rows()); //x, y, z, pad
+	EXPECT_TRUE(pointCloud.descriptorExists("color", 1));
+	EXPECT_TRUE(pointCloud.descriptorExists("intensity", 1));
+	for (int i = 0; i < 3; ++i)
+	{
+		EXPECT_EQ(i + 0.5f, pointCloud.features(0, i));
+		EXPECT_EQ(-i, pointCloud.features(1, i));
+		EXPECT_EQ(10 * i, pointCloud.features(2, i));
+		EXPECT_EQ(1, pointCloud.features(3, i));
+		EXPECT_FLOAT_EQ(0.2f * i, pointCloud.getDescriptorViewByName("color")(0, i));
+		EXPECT_EQ(-1000 * i, pointCloud.getDescriptorViewByName("intensity")(0, i));
+	}
+
+	// Truncated data
+	std::istringstream truncated(data.substr(0, data.size() - 20));
+	EXPECT_THROW(IO::loadPLY(truncated), runtime_error);
+}
+
+TEST(IOTest, loadPCDBinaryCompressed)
+{
+	typedef PointMatcherIO<float> IO;
+
+	string data(
+	"# .PCD v.7 - Point Cloud Data file format\n"
+	"VERSION .7\n"
+	"FIELDS x y z intensity\n"
+	"SIZE 4 4 4 1\n"
+	"TYPE F F F U\n"
+	"COUNT 1 1 1 1\n"
+	"WIDTH 3\n"
+	"HEIGHT 1\n"
+	"VIEWPOINT 0 0 0 1 0 0 0\n"
+	"POINTS 3\n"
+	"DATA binary_compressed\n"
+	);
+
+	// LZF-compressed fields, one after the other
+	string compressed;
+	// x: a literal run of one value, then a back reference repeating it twice
+	compressed.push_back(3);
+	appendBinaryValue<float>(compressed, 1.5f, false);
+	compressed.push_back(char((8 - 2) << 5));
+	compressed.push_back(4 - 1);
+	// y and z: a literal run
+	compressed.push_back(24 - 1);
+	for (int i = 0; i < 3; ++i)
+		appendBinaryValue<float>(compressed, i + 1, false);
+	for (int i = 0; i < 3; ++i)
+		appendBinaryValue<float>(compressed, -(i + 1), false);
+	// intensity: a literal run
+	compressed.push_back(3 - 1);
+	for (int i = 0; i < 3; ++i)
+		compressed.push_back(char(10 * (i + 1)));
+
+	appendBinaryValue<std::uint32_t>(data, compressed.size(), false);
+	appendBinaryValue<std::uint32_t>(data, 3 * 13, false);
+	data += compressed;
+
+	std::istringstream is(data);
+	const DP pointCloud = IO::loadPCD(is);
+
+	EXPECT_EQ(3, pointCloud.features.cols());
+	EXPECT_EQ(4, pointCloud.features.rows());
+	EXPECT_TRUE(pointCloud.descriptorExists("intensity", 1));
+	for (int i = 0; i < 3; ++i)
+	{
+		EXPECT_EQ(1.5f, pointCloud.features(0, i));
+		EXPECT_EQ(i + 1, pointCloud.features(1, i));
+		EXPECT_EQ(-(i + 1), pointCloud.features(2, i));
+		EXPECT_EQ(1, pointCloud.features(3, i));
+		EXPECT_EQ(10 * (i + 1), pointCloud.getDescriptorViewByName("intensity")(0, i));
+	}
+
+	// Corrupted data, the back reference pointing before the start
+	data[data.size() - compressed.size() + 6] = 100;
+	std::istringstream corrupted(data);
+	EXPECT_THROW(IO::loadPCD(corrupted), runtime_error);
+}
+
+TEST(IOTest, savePMBCompressed)
+{
+	typedef PointMatcherIO<float> IO;
+
+	// smooth channels that compress well, and a random one that does not
+	const int nbPts(5000);
+	DP pointCloud;
+	pointCloud.addFeature("x", PM::Matrix::Ones(1, nbPts) * 2.f);
+	pointCloud.addFeature("y", PM::Matrix(PM::Vector::LinSpaced(nbPts, 0.f, 1.f).transpose()));
+	pointCloud.addFeature("z", PM::Matrix::Random(1, nbPts));
+	pointCloud.addFeature("pad", PM::Matrix::Ones(1, nbPts));
+	pointCloud.addDescriptor("normals", PM::Matrix::Random(3, nbPts));
+	pointCloud.addDescriptor("intensity", PM::Matrix::Constant(1, nbPts, 0.5f));
+	pointCloud.addTime("stamps", PM::Int64Matrix::Constant(1, nbPts, 1500000000123456789LL));
+
+	std::stringstream raw;
+	IO::savePMB(pointCloud, raw);
+	std::stringstream compressed;
+	IO::savePMB(pointCloud, compressed, true);
+	EXPECT_LT(compressed.str().size(), raw.str().size());
+
+	EXPECT_TRUE(IO::loadPMB(raw) == pointCloud);
+	EXPECT_TRUE(IO::loadPMB(compressed) == pointCloud);
+
+	// Only the requested channels are loaded
+	compressed.clear();
+	compressed.seekg(0);
+	const DP partial(IO::loadPMB(compressed, {"intensity", "stamps"}));
+	EXPECT_TRUE(partial.features == pointCloud.features);
+	EXPECT_FALSE(partial.descriptorExists("normals"));
+	EXPECT_EQ(1u, partial.descriptorLabels.size());
+	EXPECT_TRUE(partial.getDescriptorViewByName("intensity") == pointCloud.getDescriptorViewByName("intensity"));
+	EXPECT_TRUE(partial.getTimeViewByName("stamps") == pointCloud.getTimeViewByName("stamps"));
+
+	raw.clear();
+	raw.seekg(0);
+	EXPECT_THROW(IO::loadPMB(raw, {"colors"}), runtime_error);
+
+	// A PMB written with float scalars loads as double
+	raw.clear();
+	raw.seekg(0);
+	const PointMatcher<double>::DataPoints asDouble(PointMatcherIO<double>::loadPMB(raw));
+	EXPECT_TRUE(asDouble.features.cast<float>() == pointCloud.features);
+	EXPECT_TRUE(asDouble.getTimeViewByName("stamps") == pointCloud.getTimeViewByName("stamps"));
+
+	std::istringstream truncated(compressed.str().substr(0, compressed.str().size() - 10));
+	EXPECT_THROW(IO::loadPMB(truncated), runtime_error);
+}
+
 class IOLoadSaveTest : public testing::Test
 {
 
@@ -413,6 +711,13 @@ public:
 
 	}
 
+	//! Check that reading the saved file by chunks gives the same cloud as loading it at once
+	void chunkedLoadTest(const size_t chunkSize = 3)
+	{
+		std::shared_ptr<PointMatcherIO<float>::ChunkReader> reader(PointMatcherIO<float>::openChunkReader(testFileName, chunkSize));
+		EXPECT_TRUE(readAllChunks(*reader) == ptCloudFromFile);
+	}
+
 	virtual void TearDown()
 	{
 		EXPECT_TRUE(boost::filesystem::remove(boost::filesystem::path(testFileName)));
@@ -440,6 +745,8 @@ TEST_F(IOLoadSaveTest, VTK)
 	EXPECT_TRUE(ptCloudFromFile.descriptorExists("genericVector",3));
 	EXPECT_TRUE(ptCloudFromFile.timeExists("genericTime",1));
 
+	chunkedLoadTest();
+
 }
 
 TEST_F(IOLoadSaveTest, VTKBinary)
@@ -453,6 +760,8 @@ TEST_F(IOLoadSaveTest, VTKBinary)
 	EXPECT_TRUE(ptCloudFromFile.descriptorExists("genericScalar",1));
 	EXPECT_TRUE(ptCloudFromFile.descriptorExists("genericVector",3));
 	EXPECT_TRUE(ptCloudFromFile.timeExists("genericTime",1));
+
+	chunkedLoadTest();
 }
 
 TEST_F(IOLoadSaveTest, PLY)
@@ -465,7 +774,36 @@ TEST_F(IOLoadSaveTest, PCD)
 	loadSaveTest(dataPath + "unit_test.pcd");
 }
 
+TEST_F(IOLoadSaveTest, PLYBinary)
+{
+	loadSaveTest(dataPath + "unit_test.bin.ply", true, 10, true);
+}
+
+TEST_F(IOLoadSaveTest, PCDBinary)
+{
+	loadSaveTest(dataPath + "unit_test.bin.pcd", false, 10, true);
+}
+
+TEST_F(IOLoadSaveTest, PMB)
+{
+	ptCloud.addDescriptor("genericScalar", PM::Matrix::Random(1, nbPts));
+	ptCloud.addTime("genericTime", PM::Int64Matrix::Random(1, nbPts));
+
+	loadSaveTest(dataPath + "unit_test.pmb");
+
+	// the format is lossless
+	EXPECT_TRUE(ptCloudFromFile == ptCloud);
+
+	const DP normalsOnly(PointMatcherIO<float>::loadPMB(testFileName, {"normals"}));
+	EXPECT_TRUE(normalsOnly.features == ptCloud.features);
+	EXPECT_TRUE(normalsOnly.featureLabels == ptCloud.featureLabels);
+	EXPECT_TRUE(normalsOnly.descriptors == ptCloud.getDescriptorViewByName("normals"));
+	EXPECT_EQ(0u, normalsOnly.timeLabels.size());
+}
+
 TEST_F(IOLoadSaveTest, CSV)
 {
 	loadSaveTest(dataPath + "unit_test.csv");
+
+	chunkedLoadTest();
 }
@@ -1,4 +1,6 @@
 #include "../utest.h"
+#include "pointmatcher/Histogram.h"
+#include <numeric>
 
 using namespace std;
 using namespace PointMatcherSupport;
@@ -33,3 +35,46 @@ TEST(Inspectors, VTKFileInspector)
 		);
 	//TODO: we only test constructor here, check other things...
 }
+
+TEST(Inspectors, StreamingHistogram)
+{
+	Histogram<double> stored(16, "stored", "", false);
+	Histogram<double> streamed(16, "streamed", "", false, true);
+
+	// durations spanning several orders of magnitude, with zeros and a negative value
+	srand(7);
+	for (int i = 0; i < 100000; ++i)
+	{
+		const double v(i % 1000 == 0 ? 0. : std::exp(12. * rand() / RAND_MAX - 9.));
+		stored.addSample(v);
+		streamed.addSample(v);
+	}
+	stored.addSample(-0.5);
+	streamed.addSample(-0.5);
+	EXPECT_EQ(100001u, stored.size());
+	EXPECT_EQ(0u, streamed.size());
+	EXPECT_EQ(stored.sampleCount(), streamed.sampleCount());
+
+	double meanV, varV, medianV, lowQt, highQt, minV, maxV;
+	double sMeanV, sVarV, sMedianV, sLowQt, sHighQt, sMinV, sMaxV;
+	uint64_t maxBinC, sMaxBinC;
+	const vector<uint64_t> bins(stored.computeStats(meanV, varV, medianV, lowQt, highQt, minV, maxV, maxBinC));
+	const vector<uint64_t> sBins(streamed.computeStats(sMeanV, sVarV, sMedianV, sLowQt, sHighQt, sMinV, sMaxV, sMaxBinC));
+
+	EXPECT_NEAR(meanV, sMeanV, 1e-9 * fabs(meanV));
+	EXPECT_NEAR(varV, sVarV, 1e-9 * varV);
+	EXPECT_EQ(minV, sMinV);
+	EXPECT_EQ(maxV, sMaxV);
+	EXPECT_NEAR(medianV, sMedianV, 0.01 * medianV);
+	EXPECT_NEAR(lowQt, sLowQt, 0.01 * lowQt);
+	EXPECT_NEAR(highQt, sHighQt, 0.01 * highQt);
+	ASSERT_EQ(bins.size(), sBins.size());
+	EXPECT_EQ(streamed.sampleCount(), std::accumulate(sBins.begin(), sBins.end(), uint64_t(0)));
+
+	// same column layout
+	ostringstream storedStats, streamedStats;
+	stored.dumpStats(storedStats);
+	streamed.dumpStats(streamedStats);
+	const string storedLine(storedStats.str()), streamedLine(streamedStats.str());
+	EXPECT_EQ(std::count(storedLine.begin(), storedLine.end(), ','), std::count(streamedLine.begin(), streamedLine.end(), ','));
+}
@@ -1,4 +1,5 @@
 #include "../utest.h"
+#include <thread>
 
 using namespace std;
 using namespace PointMatcherSupport;
@@ -86,3 +87,75 @@ TEST(Loggers, FileLoggerWarningToFile)
 
 	EXPECT_TRUE(boost::filesystem::remove(boost::filesystem::path(warningFileName)));
 }
+
+TEST(Loggers, AsyncFileLogger)
+{
+	string infoFileName = "utest_async_info";
+	string warningFileName = "utest_async_warn";
+
+	// small buffers, so that logging threads have to wait for the writer
+	std::shared_ptr<Logger> asyncLog =
+		PM::get().REG(Logger).create(
+			"AsyncFileLogger", {
+				{"infoFileName", infoFileName},
+				{"warningFileName", warningFileName},
+				{"bufferSize", "4"}
+			}
+		);
+	EXPECT_TRUE(asyncLog->hasConcurrentEntries());
+
+	const int threadCount = 4;
+	const int entryCount = 500;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < threadCount; ++t)
+	{
+		threads.push_back(std::thread([&asyncLog, t]()
+		{
+			for (int i = 0; i < entryCount; ++i)
+			{
+				asyncLog->writeInfoEntry(__FILE__, __LINE__, "", std::to_string(t) + " " + std::to_string(i));
+				if (i % 100 == 0)
+					asyncLog->writeWarningEntry(__FILE__, __LINE__, "", "warning");
+			}
+		}));
+	}
+	for (auto& thread: threads)
+		thread.join();
+
+	// stream interface, as used under the global logger mutex
+	asyncLog->beginInfoEntry(__FILE__, __LINE__, "");
+	(*asyncLog->infoStream()) << "last " << 1;
+	asyncLog->finishInfoEntry(__FILE__, __LINE__, "");
+
+	asyncLog.reset(); // Every queued entry is written when the logger is destroyed
+
+	// every entry is written once, entries of a thread in order
+	std::ifstream infoFile(infoFileName.c_str());
+	std::vector<int> nextEntry(threadCount, 0);
+	string line;
+	int lineCount = 0;
+	while (std::getline(infoFile, line))
+	{
+		++lineCount;
+		if (line == "last 1")
+			continue;
+		std::istringstream entry(line);
+		int t, i;
+		entry >> t >> i;
+		ASSERT_TRUE(t >= 0 && t < threadCount) << line;
+		EXPECT_EQ(nextEntry[t], i);
+		nextEntry[t] = i + 1;
+	}
+	EXPECT_EQ(threadCount * entryCount + 1, lineCount);
+	infoFile.close();
+
+	std::ifstream warningFile(warningFileName.c_str());
+	int warningCount = 0;
+	while (std::getline(warningFile, line))
+		++warningCount;
+	EXPECT_EQ(threadCount * entryCount / 100, warningCount);
+	warningFile.close();
+
+	EXPECT_TRUE(boost::filesystem::remove(boost::filesystem::path(infoFileName)));
+	EXPECT_TRUE(boost::filesystem::remove(boost::filesystem::path(warningFileName)));
+}
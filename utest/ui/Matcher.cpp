@@ -61,3 +61,97 @@ TEST_F(MatcherTest, KDTreeMatcher)
 		}
 	}
 }
+
+TEST_F(MatcherTest, KDTreeMatcherParallel)
+{
+	const DP ref = DP::load(dataPath + "cloud.00000.vtk");
+	const DP data = DP::load(dataPath + "cloud.00001.vtk");
+
+	params = PM::Parameters();
+	params["knn"] = "3";
+	params["maxDist"] = "0.5";
+
+	std::shared_ptr<PM::Matcher> serialMatcher =
+		PM::get().MatcherRegistrar.create("KDTreeMatcher", params);
+	serialMatcher->init(ref);
+	const PM::Matches serialMatches = serialMatcher->findClosests(data);
+
+	params["nbThreads"] = "4";
+	std::shared_ptr<PM::Matcher> parallelMatcher =
+		PM::get().MatcherRegistrar.create("KDTreeMatcher", params);
+	parallelMatcher->init(ref);
+	const PM::Matches parallelMatches = parallelMatcher->findClosests(data);
+
+	EXPECT_TRUE(serialMatches.ids == parallelMatches.ids);
+	EXPECT_TRUE(serialMatches.dists == parallelMatches.dists);
+	EXPECT_EQ(serialMatcher->getVisitCount(), parallelMatcher->getVisitCount());
+}
+
+TEST_F(MatcherTest, KDTreeMatcherAppendRemove)
+{
+	const DP ref = DP::load(dataPath + "cloud.00000.vtk");
+	const DP data = DP::load(dataPath + "cloud.00001.vtk");
+	const int nbPoints(ref.getNbPoints());
+
+	params = PM::Parameters();
+	params["knn"] = "3";
+	params["maxDist"] = "1.0";
+
+	// Matches of several trees are sorted, those of one tree might not be
+	struct Sorted
+	{
+		static PM::Matrix dists(PM::Matches matches)
+		{
+			for (int i = 0; i < matches.dists.cols(); ++i)
+				std::sort(matches.dists.col(i).data(), matches.dists.col(i).data() + matches.dists.rows());
+			return matches.dists;
+		}
+	};
+
+	// Append the reference in chunks of decreasing sizes
+	std::shared_ptr<PM::Matcher> incrementalMatcher =
+		PM::get().MatcherRegistrar.create("KDTreeMatcher", params);
+	DP grown(ref);
+	grown.conservativeResize(nbPoints / 2);
+	incrementalMatcher->init(grown);
+	for (int begin = nbPoints / 2; begin < nbPoints; )
+	{
+		const int end(std::min(nbPoints, begin + std::max(1, (nbPoints - begin) / 3)));
+		grown = ref;
+		grown.conservativeResize(end);
+		incrementalMatcher->appendToReference(grown, begin);
+		begin = end;
+	}
+
+	std::shared_ptr<PM::Matcher> fullMatcher =
+		PM::get().MatcherRegistrar.create("KDTreeMatcher", params);
+	fullMatcher->init(ref);
+
+	const PM::Matches incrementalMatches = incrementalMatcher->findClosests(data);
+	const PM::Matches fullMatches = fullMatcher->findClosests(data);
+	EXPECT_TRUE(Sorted::dists(incrementalMatches) == Sorted::dists(fullMatches));
+	for (int i = 0; i < data.features.cols(); ++i)
+	{
+		for (int k = 0; k < 3; ++k)
+		{
+			const int id(incrementalMatches.ids(k, i));
+			if (id != PM::Matches::InvalidId)
+				EXPECT_FLOAT_EQ((ref.features.col(id) - data.features.col(i)).squaredNorm(), incrementalMatches.dists(k, i));
+		}
+	}
+
+	// Remove the points with a positive x
+	std::vector<bool> keptPoints(nbPoints);
+	DP remaining(ref);
+	int j = 0;
+	for (int i = 0; i < nbPoints; ++i)
+	{
+		keptPoints[i] = ref.features(0, i) <= 0;
+		if (keptPoints[i])
+			remaining.setColFrom(j++, ref, i);
+	}
+	remaining.conservativeResize(j);
+	incrementalMatcher->removeFromReference(remaining, keptPoints);
+	fullMatcher->init(remaining);
+	EXPECT_TRUE(Sorted::dists(incrementalMatcher->findClosests(data)) == Sorted::dists(fullMatcher->findClosests(data)));
+}
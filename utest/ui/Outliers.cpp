@@ -150,3 +150,124 @@ TEST_F(OutlierFilterTest, VarTrimmedDistOutlierFilterParameters)
 	ASSERT_EQ(1.0f, weights(0, 0));
 	ASSERT_EQ(1.0f, weights(0, 1));
 }
+
+TEST_F(OutlierFilterTest, RobustOutlierFilterSharedPointToPlaneDistances)
+{
+	typedef PM::DataPoints DP;
+
+	// reference on the plane z=0 with unnormalized normals, reading points above it
+	const int count = 5000;
+	DP::Labels labels;
+	labels.push_back(DP::Label("x", 1));
+	labels.push_back(DP::Label("y", 1));
+	labels.push_back(DP::Label("z", 1));
+	labels.push_back(DP::Label("pad", 1));
+	DP reference(PM::Matrix::Random(4, count), labels);
+	reference.features.row(2).setZero();
+	reference.features.row(3).setOnes();
+	PM::Matrix normals(PM::Matrix::Zero(3, count));
+	normals.row(2).setConstant(2);
+	normals.col(7).setZero();
+	reference.addDescriptor("normals", normals);
+	DP reading(reference);
+	reading.features.row(2) = PM::Matrix::Random(1, count);
+
+	PM::Matches::Dists dists(2, count);
+	PM::Matches::Ids ids(2, count);
+	for (int i = 0; i < count; ++i)
+	{
+		ids(0, i) = i;
+		ids(1, i) = (i * 7) % count;
+		dists(0, i) = (reading.features.col(i) - reference.features.col(ids(0, i))).squaredNorm();
+		dists(1, i) = (reading.features.col(i) - reference.features.col(ids(1, i))).squaredNorm();
+	}
+	ids(1, 3) = PM::Matches::InvalidId;
+	dists(1, 3) = numeric_limits<float>::infinity();
+	const PM::Matches matches(dists, ids);
+
+	// distance to the plane is the height of the reading point, 0 for a null normal or an invalid match
+	const PM::Matrix serial(PM::OutlierFilter::computePointToPlaneDistances(reading, reference, matches, 1));
+	const PM::Matrix parallel(PM::OutlierFilter::computePointToPlaneDistances(reading, reference, matches, 3));
+	EXPECT_TRUE(serial == parallel);
+	EXPECT_NEAR(pow(reading.features(2, 0), 2), serial(0, 0), 1e-6);
+	EXPECT_NEAR(pow(reading.features(2, 10), 2), serial(1, 10), 1e-6);
+	EXPECT_EQ(0, serial(0, 7));
+	EXPECT_EQ(0, serial(1, 3));
+
+	// a chain computes the distances once and gives the same weights as each filter on its own
+	const PM::Parameters params = {{"robustFct", "cauchy"}, {"scaleEstimator", "none"}, {"distanceType", "point2plane"}, {"nbThreads", "2"}};
+	addFilter("RobustOutlierFilter", params);
+	const PM::OutlierWeights alone(testedOutlierFilter->compute(reading, reference, matches));
+	addFilter("RobustOutlierFilter", PM::Parameters{{"robustFct", "welsch"}, {"scaleEstimator", "none"}, {"distanceType", "point2plane"}});
+	const PM::OutlierWeights expected(alone.array() * testedOutlierFilter->compute(reading, reference, matches).array());
+	EXPECT_TRUE(expected.isApprox(icp.outlierFilters.compute(reading, reference, matches)));
+}
+
+TEST_F(OutlierFilterTest, MatchesStatistics)
+{
+	// odd number of finite distances, with infinite ones to skip
+	PM::Matches::Dists dists(PM::Matches::Dists::Random(3, 1001).cwiseAbs());
+	dists(1, 10) = numeric_limits<float>::infinity();
+	dists(2, 500) = numeric_limits<float>::infinity();
+	const PM::Matches matches(dists, PM::Matches::Ids::Zero(3, 1001));
+
+	vector<float> sorted;
+	for (int i = 0; i < dists.size(); ++i)
+		if (dists.data()[i] != numeric_limits<float>::infinity())
+			sorted.push_back(dists.data()[i]);
+	sort(sorted.begin(), sorted.end());
+
+	for (const float quantile: {0.f, 0.1f, 0.5f, 0.77f, 1.f})
+		EXPECT_EQ(sorted[min<size_t>(sorted.size() * quantile, sorted.size() - 1)], matches.getDistsQuantile(quantile));
+
+	const float median(sorted[sorted.size() / 2]);
+	vector<float> deviations;
+	for (const float dist: sorted)
+		deviations.push_back(fabs(dist - median));
+	sort(deviations.begin(), deviations.end());
+	EXPECT_EQ(deviations[deviations.size() / 2], matches.getMedianAbsDeviation());
+	// the scratch buffer is reused, results must not depend on previous calls
+	EXPECT_EQ(median, matches.getDistsQuantile(0.5));
+}
+
+TEST_F(OutlierFilterTest, VarTrimmedDistOutlierFilterSingleSort)
+{
+	const float minRatio(0.2f), maxRatio(0.9f), lambda(2.35f);
+	OutlierFiltersImpl<float>::VarTrimmedDistOutlierFilter filter({{"minRatio", toParam(minRatio)},
+																   {"maxRatio", toParam(maxRatio)},
+																   {"lambda", toParam(lambda)}});
+	PM::DataPoints filteredReading;
+	PM::DataPoints filteredReference;
+	PM::Matches::Dists dists(PM::Matches::Dists::Random(2, 5000).array().square().matrix());
+	dists.col(3).array() += 100;
+	const PM::Matches matches(dists, PM::Matches::Ids::Zero(2, 5000));
+
+	// reference search of the ratio minimizing the fractional RMSD, as in \cite{Phillips2007VarTrimmed}
+	vector<float> sorted(dists.data(), dists.data() + dists.size());
+	sort(sorted.begin(), sorted.end());
+	const int count(sorted.size());
+	float cumSum(0), minFRMS(numeric_limits<float>::infinity());
+	int minIndex(0);
+	for (int i = 0; i < int(floor(maxRatio * count)); ++i)
+	{
+		cumSum += sorted[i];
+		if (i < int(floor(minRatio * count)))
+			continue;
+		const float frms(cumSum / (i + 1) / pow(pow(float(i + 1) / count, lambda), 2));
+		if (frms < minFRMS)
+		{
+			minFRMS = frms;
+			minIndex = i;
+		}
+	}
+	const float limit(matches.getDistsQuantile(float(minIndex) / count));
+	const PM::OutlierWeights expected((dists.array() <= limit).cast<float>());
+	EXPECT_TRUE(expected == filter.compute(filteredReading, filteredReference, matches));
+
+	// zero and infinite distances are left out of the ratio search but not of the quantile
+	dists.col(7) << 0, numeric_limits<float>::infinity();
+	const PM::OutlierWeights weights(filter.compute(filteredReading, filteredReference, PM::Matches(dists, PM::Matches::Ids::Zero(2, 5000))));
+	EXPECT_EQ(1, weights(0, 7));
+	EXPECT_EQ(0, weights(1, 7));
+	EXPECT_EQ(0, weights(0, 3));
+}
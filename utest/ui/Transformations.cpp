@@ -129,3 +129,89 @@ TEST(Transformation, RigidTransformation)
 
 	EXPECT_THROW(rigidTrans->correctParameters(T_2D_reflection), TransformationError);
 }
+
+TEST(Transformation, RigidTransformationIntoBuffer)
+{
+	std::shared_ptr<PM::Transformation> rigidTrans;
+	rigidTrans = PM::get().REG(Transformation).create("RigidTransformation");
+
+	PM::Matrix T_3D = PM::Matrix::Identity(4,4);
+	T_3D.topLeftCorner(3,3) = Eigen::AngleAxisf(0.3, Eigen::Vector3f(1,2,3).normalized()).toRotationMatrix();
+	T_3D.topRightCorner(3,1) << 1, -2, 3;
+
+	DP cloud(data3D);
+	PM::Matrix normals = PM::Matrix::Random(3, cloud.getNbPoints());
+	cloud.addDescriptor("normals", normals);
+	cloud.addDescriptor("other", normals);
+
+	const DP expected = rigidTrans->compute(cloud, T_3D);
+
+	// Into a fresh buffer, then again into the same buffer
+	DP output;
+	for (int i = 0; i < 2; ++i)
+	{
+		rigidTrans->compute(cloud, T_3D, output);
+		EXPECT_TRUE(output.features.isApprox(expected.features));
+		EXPECT_TRUE(output.descriptors.isApprox(expected.descriptors));
+		EXPECT_TRUE(output.descriptorLabels == expected.descriptorLabels);
+	}
+
+	// In place
+	rigidTrans->compute(cloud, T_3D, cloud);
+	EXPECT_TRUE(cloud.features.isApprox(expected.features));
+	EXPECT_TRUE(cloud.descriptors.isApprox(expected.descriptors));
+}
+
+TEST(Transformation, RigidTransformationFusedDirections)
+{
+	PM::Parameters params;
+	params["nbThreads"] = "4";
+	std::shared_ptr<PM::Transformation> rigidTrans;
+	rigidTrans = PM::get().REG(Transformation).create("RigidTransformation", params);
+
+	// 3D and 2D clouds large enough to be split between the threads
+	for (int dim = 3; dim >= 2; --dim)
+	{
+		PM::Matrix T = PM::Matrix::Identity(dim + 1, dim + 1);
+		if (dim == 3)
+			T.topLeftCorner(3,3) = Eigen::AngleAxisf(0.3, Eigen::Vector3f(1,2,3).normalized()).toRotationMatrix();
+		else
+			T.topLeftCorner(2,2) = Eigen::Rotation2Df(0.3).toRotationMatrix();
+		T.topRightCorner(dim,1).setConstant(2);
+
+		const int nbPoints(100000);
+		PM::Matrix features = PM::Matrix::Random(dim + 1, nbPoints);
+		features.row(dim).setOnes();
+		DP cloud;
+		cloud.addFeature("x", features.row(0));
+		cloud.addFeature("y", features.row(1));
+		if (dim == 3)
+			cloud.addFeature("z", features.row(2));
+		cloud.addFeature("pad", features.row(dim));
+		const PM::Matrix normals = PM::Matrix::Random(dim, nbPoints);
+		const PM::Matrix other = PM::Matrix::Random(2, nbPoints);
+		const PM::Matrix directions = PM::Matrix::Random(dim, nbPoints);
+		cloud.addDescriptor("normals", normals);
+		cloud.addDescriptor("other", other);
+		cloud.addDescriptor("observationDirections", directions);
+
+		const PM::Matrix R(T.topLeftCorner(dim, dim));
+		const PM::Matrix expectedFeatures(T * features);
+		const PM::Matrix expectedNormals(R * normals);
+		const PM::Matrix expectedDirections(R * directions);
+
+		DP output;
+		rigidTrans->compute(cloud, T, output);
+		EXPECT_TRUE(output.features.isApprox(expectedFeatures));
+		EXPECT_TRUE(output.getDescriptorViewByName("normals").isApprox(expectedNormals));
+		EXPECT_TRUE(output.getDescriptorViewByName("other") == other);
+		EXPECT_TRUE(output.getDescriptorViewByName("observationDirections").isApprox(expectedDirections));
+
+		// In place, through the transformation chain
+		PM::Transformations transformations;
+		transformations.push_back(rigidTrans);
+		transformations.apply(cloud, T);
+		EXPECT_TRUE(cloud.features == output.features);
+		EXPECT_TRUE(cloud.descriptors == output.descriptors);
+	}
+}
@@ -34,6 +34,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "utest.h"
+#include "pointmatcher/Timer.h"
+
+#include <chrono>
+#include <thread>
 
 using namespace std;
 using namespace PointMatcherSupport;
@@ -242,6 +246,193 @@ TEST(icpTest, similarityTransform)
 	  << "Expecting the similarity transform scale to be 1.04.";
 }
 
+TEST(icpTest, icpReuseBuffers)
+{
+	// Reusing the buffers must not change the result, neither across
+	// iterations nor across calls with different clouds.
+	DP pts0 = DP::load(dataPath + "cloud.00000.vtk");
+	DP pts1 = DP::load(dataPath + "cloud.00001.vtk");
+	DP pts2 = DP::load(dataPath + "cloud.00002.vtk");
+
+	PM::Parameters params;
+	params["keepEigenValues"] = "1";
+	PM::Parameters maxDistParams;
+	maxDistParams["maxDist"] = "100";
+
+	PM::ICP icp, icpReuse;
+	PM::ICP* icps[2] = { &icp, &icpReuse };
+	for (int i = 0; i < 2; ++i)
+	{
+		icps[i]->setDefault();
+		icps[i]->readingDataPointsFilters.clear();
+		icps[i]->readingStepDataPointsFilters.push_back(PM::get().DataPointsFilterRegistrar.create("MaxDistDataPointsFilter", maxDistParams));
+		icps[i]->referenceDataPointsFilters.clear();
+		icps[i]->referenceDataPointsFilters.push_back(PM::get().DataPointsFilterRegistrar.create("SurfaceNormalDataPointsFilter", params));
+	}
+	EXPECT_FALSE(icp.getReuseBuffers());
+	icpReuse.setReuseBuffers(true);
+	EXPECT_TRUE(icpReuse.getReuseBuffers());
+
+	// With a step filter
+	EXPECT_TRUE(icp(pts1, pts0).isApprox(icpReuse(pts1, pts0), 1e-4));
+
+	// Without step filter, in the buffers of the previous call
+	icp.readingStepDataPointsFilters.clear();
+	icpReuse.readingStepDataPointsFilters.clear();
+	EXPECT_TRUE(icp(pts2, pts0).isApprox(icpReuse(pts2, pts0), 1e-4));
+	EXPECT_TRUE(icp.getReadingFiltered().features.isApprox(icpReuse.getReadingFiltered().features));
+
+	// Only the descriptors used by the minimizer are kept
+	const PM::ErrorMinimizer::ErrorElements mPts = icpReuse.errorMinimizer->getErrorElements();
+	EXPECT_TRUE(mPts.reference.descriptorExists("normals"));
+	EXPECT_FALSE(mPts.reference.descriptorExists("eigValues"));
+	EXPECT_TRUE(icp.errorMinimizer->getErrorElements().reference.descriptorExists("eigValues"));
+}
+
+TEST(icpTest, icpPreparedReference)
+{
+	DP pts0 = DP::load(dataPath + "cloud.00000.vtk");
+	DP pts1 = DP::load(dataPath + "cloud.00001.vtk");
+	DP pts2 = DP::load(dataPath + "cloud.00002.vtk");
+
+	// Deterministic filters, so that the results can be compared
+	PM::ICP icp, otherIcp;
+	PM::ICP* icps[2] = { &icp, &otherIcp };
+	for (int i = 0; i < 2; ++i)
+	{
+		icps[i]->setDefault();
+		icps[i]->readingDataPointsFilters.clear();
+		icps[i]->referenceDataPointsFilters.clear();
+		icps[i]->referenceDataPointsFilters.push_back(PM::get().DataPointsFilterRegistrar.create("SurfaceNormalDataPointsFilter"));
+	}
+
+	const PM::TransformationParameters expected = icp(pts1, pts0);
+
+	std::shared_ptr<PM::ICP::PreparedReference> prepared = icp.prepareReference(pts0);
+	EXPECT_EQ(prepared->referenceInPtsCount, pts0.getNbPoints());
+	EXPECT_NE(prepared->matcher, icp.matcher);
+	EXPECT_TRUE(expected.isApprox(icp(pts1, *prepared), 1e-4));
+	EXPECT_EQ(icp.getPrefilteredReferencePtsCount(), prepared->reference.getNbPoints());
+
+	// Registering against another reference must not affect the prepared one
+	icp(pts1, pts2);
+	EXPECT_TRUE(expected.isApprox(icp(pts1, *prepared), 1e-4));
+
+	// The prepared reference can be used by another ICP
+	EXPECT_TRUE(expected.isApprox(otherIcp(pts1, *prepared), 1e-4));
+	EXPECT_THROW(otherIcp(pts1, PM::ICP::PreparedReference()), std::runtime_error);
+}
+
+TEST(icpTest, icpTrace)
+{
+	using PointMatcherSupport::Trace;
+	
+	DP pts0 = DP::load(dataPath + "cloud.00000.vtk");
+	DP pts1 = DP::load(dataPath + "cloud.00001.vtk");
+
+	PM::ICP icp;
+	icp.setDefault();
+	
+	// Nothing is recorded unless the trace is active
+	Trace trace;
+	icp(pts1, pts0);
+	EXPECT_TRUE(trace.scopes.empty());
+	
+	{
+		Trace::Activation activation(trace);
+		icp(pts1, pts0);
+	}
+	EXPECT_TRUE(PointMatcherSupport::activeTrace == 0);
+	icp(pts1, pts0);
+	
+	// One tree per call, rooted at ICP::compute
+	ASSERT_FALSE(trace.scopes.empty());
+	EXPECT_EQ(trace.scopes[0].name, "ICP::compute");
+	EXPECT_EQ(trace.scopes[0].parent, -1);
+	int iterationCount(0), matchingCount(0), outlierCount(0), minimizationCount(0), checkCount(0), filterCount(0);
+	for (size_t i = 0; i < trace.scopes.size(); ++i)
+	{
+		const Trace::Scope& scope(trace.scopes[i]);
+		EXPECT_GE(scope.duration, 0) << scope.name;
+		if (i > 0)
+		{
+			// scopes are nested in time and in depth in their parent
+			ASSERT_GE(scope.parent, 0);
+			ASSERT_LT(scope.parent, int(i));
+			const Trace::Scope& parent(trace.scopes[scope.parent]);
+			EXPECT_EQ(scope.depth, parent.depth + 1);
+			EXPECT_GE(scope.start, parent.start);
+			EXPECT_LE(scope.start + scope.duration, parent.start + parent.duration + 1e-9);
+		}
+		const std::string category(scope.category);
+		if (scope.name == "Iteration")
+			++iterationCount;
+		else if (category == "Matcher::findClosests")
+			++matchingCount;
+		else if (category == "OutlierFilters::compute")
+			++outlierCount;
+		else if (category == "ErrorMinimizer::compute")
+			++minimizationCount;
+		else if (category == "TransformationCheckers::check")
+			++checkCount;
+		else if (category == "DataPointsFilter::inPlaceFilter")
+			++filterCount;
+	}
+	EXPECT_GT(iterationCount, 0);
+	EXPECT_EQ(matchingCount, iterationCount);
+	EXPECT_EQ(outlierCount, iterationCount);
+	EXPECT_EQ(minimizationCount, iterationCount);
+	EXPECT_EQ(checkCount, iterationCount);
+	EXPECT_EQ(filterCount, int(icp.referenceDataPointsFilters.size() + icp.readingDataPointsFilters.size() + iterationCount * icp.readingStepDataPointsFilters.size()));
+	EXPECT_GT(trace.totalDuration("ICP::compute"), 0);
+	
+	std::ostringstream json;
+	trace.saveChromeTrace(json);
+	EXPECT_EQ(json.str().find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0u);
+	EXPECT_NE(json.str().find("\"name\":\"ICP::compute\",\"cat\":\"ICP\",\"ph\":\"X\""), std::string::npos);
+	
+	trace.clear();
+	EXPECT_TRUE(trace.scopes.empty());
+	
+	// A prepared reference is traced in its own tree, then every call against it
+	{
+		Trace::Activation activation(trace);
+		std::shared_ptr<PM::ICP::PreparedReference> prepared = icp.prepareReference(pts0);
+		icp(pts1, *prepared);
+	}
+	ASSERT_GE(trace.scopes.size(), 2u);
+	EXPECT_EQ(trace.scopes[0].name, "ICP::prepareReference");
+	EXPECT_EQ(trace.scopes[0].parent, -1);
+	EXPECT_EQ(trace.scopes[1].parent, 0);
+	int matcherInitCount(0), rootCount(0);
+	for (size_t i = 0; i < trace.scopes.size(); ++i)
+	{
+		if (std::string(trace.scopes[i].category) == "Matcher::init")
+		{
+			++matcherInitCount;
+			EXPECT_EQ(trace.scopes[trace.scopes[i].parent].name, "ICP::prepareReference");
+		}
+		if (trace.scopes[i].parent == -1)
+		{
+			++rootCount;
+			if (i > 0)
+				EXPECT_EQ(trace.scopes[i].name, "ICP::compute");
+		}
+	}
+	EXPECT_EQ(matcherInitCount, 1);
+	EXPECT_EQ(rootCount, 2);
+	EXPECT_GT(trace.totalDuration("ICP::compute"), 0);
+	
+	// Times are wall-clock times, which also elapse while the thread waits
+	trace.clear();
+	{
+		Trace::Activation activation(trace);
+		Trace::ScopedTimer scope("Sleep", "Test");
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+	EXPECT_GE(trace.totalDuration("Sleep"), 0.015);
+}
+
 TEST(icpTest, icpSequenceTest)
 {
 	DP pts0 = DP::load(dataPath + "cloud.00000.vtk");
@@ -289,6 +480,60 @@ TEST(icpTest, icpSequenceTest)
 	EXPECT_EQ(map.getHomogeneousDim(), 0u);
 }
 
+TEST(icpTest, icpSequenceInsertRemoveTest)
+{
+	DP pts0 = DP::load(dataPath + "cloud.00000.vtk");
+	DP pts1 = DP::load(dataPath + "cloud.00001.vtk");
+
+	PM::ICPSequence icpSequence;
+	icpSequence.setDefault();
+	icpSequence.readingDataPointsFilters.clear();
+	icpSequence.referenceDataPointsFilters.clear();
+	icpSequence.referenceDataPointsFilters.push_back(PM::get().DataPointsFilterRegistrar.create("SurfaceNormalDataPointsFilter"));
+
+	// Inserting in an empty map sets it
+	EXPECT_TRUE(icpSequence.insertPoints(pts0));
+	const DP firstMap = icpSequence.getPrefilteredMap();
+	EXPECT_EQ(firstMap.getNbPoints(), pts0.getNbPoints());
+
+	// The inserted points are appended in the global frame, existing points are not moved
+	EXPECT_TRUE(icpSequence.insertPoints(pts1));
+	DP map = icpSequence.getPrefilteredMap();
+	EXPECT_EQ(map.getNbPoints(), pts0.getNbPoints() + pts1.getNbPoints());
+	EXPECT_TRUE(map.features.leftCols(pts0.getNbPoints()).isApprox(firstMap.features));
+	EXPECT_TRUE(map.features.rightCols(pts1.getNbPoints()).isApprox(pts1.features));
+	EXPECT_TRUE(map.descriptorExists("normals"));
+
+	// ICP against the updated map behaves as against the same map set at once
+	PM::ICPSequence fullSequence;
+	fullSequence.setDefault();
+	fullSequence.readingDataPointsFilters.clear();
+	fullSequence.referenceDataPointsFilters.clear();
+	fullSequence.setMap(map);
+	const PM::TransformationParameters expected = fullSequence(pts1);
+	EXPECT_TRUE(expected.isApprox(icpSequence(pts1), 1e-4));
+
+	// Remove the points inside a box covering the lower half of the map along x
+	const PM::Vector minCorner = map.features.topRows(3).rowwise().minCoeff();
+	PM::Vector maxCorner = map.features.topRows(3).rowwise().maxCoeff();
+	maxCorner(0) = (minCorner(0) + maxCorner(0)) / 2;
+	int insideCount = 0;
+	for (int i = 0; i < map.features.cols(); ++i)
+		insideCount += (map.features(0, i) <= maxCorner(0));
+	EXPECT_GT(insideCount, 0);
+	EXPECT_EQ(icpSequence.removePoints(minCorner, maxCorner), unsigned(insideCount));
+	EXPECT_EQ(icpSequence.removePoints(minCorner, maxCorner), 0u);
+	map = icpSequence.getPrefilteredMap();
+	EXPECT_EQ(map.getNbPoints(), pts0.getNbPoints() + pts1.getNbPoints() - insideCount);
+	fullSequence.setMap(map);
+	// The maps are not centered on the same point, so the iterations differ slightly
+	EXPECT_TRUE(fullSequence(pts1).isApprox(icpSequence(pts1), 1e-2));
+
+	// Removing everything clears the map
+	icpSequence.removePoints(PM::Vector::Constant(3, -1e6), PM::Vector::Constant(3, 1e6));
+	EXPECT_FALSE(icpSequence.hasMap());
+}
+
 // Utility classes
 class GenericTest: public IcpHelper
 {
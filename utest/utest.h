@@ -46,7 +46,8 @@ public:
 			);
 	}
 	
-	void validate2dTransformation()
+	//! Validate the registration of data2D on ref2D, the rotation being within angleTolerance radians
+	void validate2dTransformation(const double angleTolerance = 0.05)
 	{
 		const PM::TransformationParameters testT = icp(data2D, ref2D);
 		const int dim = validT2d.cols();
@@ -58,10 +59,11 @@ public:
 		const BOOST_AUTO(testAngle, acos(testT(0,0)));
 		
 		EXPECT_NEAR(validTrans, testTrans, 0.05);
-		EXPECT_NEAR(validAngle, testAngle, 0.05);
+		EXPECT_NEAR(validAngle, testAngle, angleTolerance);
 	}
 
-	void validate3dTransformation()
+	//! Validate the registration of data3D on ref3D, the rotation being within angleTolerance radians
+	void validate3dTransformation(const double angleTolerance = 0.1)
 	{
 		//dumpVTK();
 
@@ -80,7 +82,7 @@ public:
 		//cout << "angleDist: " << angleDist << endl;
 		//cout << "transDist: " << abs(validTrans-testTrans) << endl;
 		EXPECT_NEAR(validTrans, testTrans, 0.1);
-		EXPECT_NEAR(angleDist, 0.0, 0.1);
+		EXPECT_NEAR(angleDist, 0.0, angleTolerance);
 
 	}
 };